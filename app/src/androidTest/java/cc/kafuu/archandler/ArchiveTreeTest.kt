@@ -0,0 +1,103 @@
+package cc.kafuu.archandler
+
+import android.os.Debug
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.ArchiveTree
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import kotlin.system.measureTimeMillis
+
+@RunWith(AndroidJUnit4::class)
+class ArchiveTreeTest {
+
+    companion object {
+        private const val FILE_COUNT = 30_000
+        private const val FILES_PER_DIR = 1000
+    }
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("archive_tree")
+    private val mInputDir = File(mWorkDir, "input")
+    private val mArchive = File(mWorkDir, "tree.tar")
+
+    @Before
+    fun setUp() {
+        NativeTestFiles.writeFiles(mInputDir, FILE_COUNT, 16, filesPerDir = FILES_PER_DIR)
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = mArchive.path,
+                baseDir = mWorkDir.path,
+                inputFiles = listOf(mInputDir.path),
+                format = LibArchiveFormat.TarPax.id,
+                compression = LibCompressionType.None.id,
+                compressionLevel = 0,
+                listener = NativeTestFiles.noopCallback
+            )
+        )
+    }
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testPagedChildren() {
+        checkNotNull(ArchiveTree.open(mArchive.path)).use { tree ->
+            assertEquals(-1, tree.childCount("missing"))
+            assertEquals(FILE_COUNT / FILES_PER_DIR, tree.childCount(mInputDir.name))
+
+            // 子项数量超过单页大小，跨页访问的结果应与完整排序一致
+            val dir = "${mInputDir.name}/dir_0"
+            val expected = (0 until FILES_PER_DIR).map { "file_$it.txt" }.sorted()
+            val ascending = tree.children(dir)
+            assertEquals(expected, ascending.map { it.name })
+            assertTrue(ascending.all { !it.isDirectory && it.size == 16L && it.path == "$dir/${it.name}" })
+
+            val descending = tree.children(dir, ArchiveTree.SortOrder(descending = true))
+            assertEquals(expected.reversed(), descending.map { it.name })
+        }
+    }
+
+    @Test
+    fun testStreamingChunksCoverAllEntries() {
+        val streamed = HashSet<String>()
+        checkNotNull(ArchiveTree.open(mArchive.path) { entries ->
+            entries.forEach { streamed.add(it.path) }
+            true
+        }).close()
+        assertEquals(FILE_COUNT, streamed.count { it.endsWith(".txt") })
+    }
+
+    @Test
+    fun testMemoryPerEntry() {
+        println("\n========== Archive Tree Memory Test ==========\n")
+
+        // 预热，加载 native 库并填充分配器缓存
+        ArchiveTree.open(mArchive.path)?.close()
+
+        System.gc()
+        val before = Debug.getNativeHeapAllocatedSize()
+        lateinit var tree: ArchiveTree
+        val time = measureTimeMillis {
+            tree = checkNotNull(ArchiveTree.open(mArchive.path))
+        }
+        val used = Debug.getNativeHeapAllocatedSize() - before
+        tree.use {
+            // 目录节点与文件节点都计入条目数
+            val entries = FILE_COUNT + FILE_COUNT / FILES_PER_DIR + 1
+            println("  Entries: $entries")
+            println("  Build time: $time ms")
+            println("  Native heap: ${used / 1024} KiB")
+            println("  Bytes per entry: ${used / entries}")
+        }
+    }
+}
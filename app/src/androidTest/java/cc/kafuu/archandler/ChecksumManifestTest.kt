@@ -0,0 +1,107 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibChecksumAlgorithm
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import java.security.MessageDigest
+import java.util.zip.CRC32
+
+@RunWith(AndroidJUnit4::class)
+class ChecksumManifestTest {
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("checksum_manifest")
+    private val mInputDir = File(mWorkDir, "input")
+    private val mInputFiles = NativeTestFiles.writeFiles(mInputDir, 200, 8 * 1024, filesPerDir = 20, compressible = false)
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testCreateAndExtractManifestsMatch() {
+        for ((format, compression) in listOf(
+            LibArchiveFormat.TarPax to LibCompressionType.Zstd,
+            LibArchiveFormat.Zip to LibCompressionType.None
+        )) {
+            val archive = File(mWorkDir, "manifest_${format.name}")
+            val createManifest = File(mWorkDir, "create_${format.name}.sha256")
+            createArchive(archive, format, compression, LibChecksumAlgorithm.Sha256, createManifest)
+            assertEquals(expectedManifest { sha256(it) }, createManifest.readText())
+
+            // 解压时计算的清单与打包时一致，且与写出的文件相符
+            val outputDir = File(mWorkDir, "output_${format.name}")
+            val extractManifest = File(mWorkDir, "extract_${format.name}.sha256")
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchive(
+                    archive.path,
+                    outputDir.path,
+                    NativeTestFiles.noopCallback,
+                    checksumAlgorithm = LibChecksumAlgorithm.Sha256.id,
+                    checksumPath = extractManifest.path
+                )
+            )
+            assertEquals(createManifest.readText(), extractManifest.readText())
+            NativeTestFiles.assertSameTree(mInputDir, File(outputDir, mInputDir.name))
+        }
+    }
+
+    @Test
+    fun testEmbeddedManifest() {
+        val archive = File(mWorkDir, "embedded.tar")
+        createArchive(archive, LibArchiveFormat.TarPax, LibCompressionType.None, LibChecksumAlgorithm.Crc32, null)
+
+        // 未指定清单路径时清单作为最后一个条目写入压缩包
+        val outputDir = File(mWorkDir, "output")
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.extractArchive(archive.path, outputDir.path, NativeTestFiles.noopCallback)
+        )
+        val expected = expectedManifest { content -> "%08x".format(CRC32().apply { update(content) }.value) }
+        assertEquals(expected, File(outputDir, "CHECKSUMS.crc32").readText())
+    }
+
+    /**
+     * 按路径排序、与 sha256sum 格式相同的清单
+     */
+    private fun expectedManifest(digest: (ByteArray) -> String) = mInputFiles
+        .map { it.relativeTo(mWorkDir).path to digest(it.readBytes()) }
+        .sortedBy { it.first }
+        .joinToString("") { (path, value) -> "$value  $path\n" }
+
+    private fun sha256(content: ByteArray) = MessageDigest.getInstance("SHA-256")
+        .digest(content)
+        .joinToString("") { "%02x".format(it) }
+
+    private fun createArchive(
+        archive: File,
+        format: LibArchiveFormat,
+        compression: LibCompressionType,
+        algorithm: LibChecksumAlgorithm,
+        manifest: File?
+    ) {
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = archive.path,
+                baseDir = mWorkDir.path,
+                inputFiles = listOf(mInputDir.path),
+                format = format.id,
+                compression = compression.id,
+                compressionLevel = if (compression == LibCompressionType.None) 0 else 3,
+                listener = NativeTestFiles.noopCallback,
+                checksumAlgorithm = algorithm.id,
+                checksumPath = manifest?.path
+            )
+        )
+    }
+}
@@ -0,0 +1,100 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import kotlin.system.measureTimeMillis
+
+@RunWith(AndroidJUnit4::class)
+class CompressionThreadScalingTest {
+
+    companion object {
+        private const val WARMUP_ROUNDS = 1
+        private const val TEST_ROUNDS = 3
+        private const val FILE_COUNT = 64
+        private const val FILE_SIZE = 1024 * 1024
+    }
+
+    @Test
+    fun testCompressionThreadScaling() {
+        println("\n========== Compression Thread Scaling Test ==========\n")
+
+        val workDir = NativeTestFiles.newWorkDir("compression_thread_scaling")
+        val inputDir = File(workDir, "input")
+        NativeTestFiles.writeFiles(inputDir, FILE_COUNT, FILE_SIZE, filesPerDir = 16)
+        val cores = Runtime.getRuntime().availableProcessors()
+        val threadCounts = generateSequence(1) { it * 2 }.takeWhile { it < cores }.toList() + cores
+
+        try {
+            for ((compression, level) in listOf(LibCompressionType.Zstd to 3, LibCompressionType.Xz to 6)) {
+                println("Testing ${compression.name} level $level with ${FILE_COUNT * FILE_SIZE / 1024 / 1024} MiB...")
+                testCompression(workDir, inputDir, compression, level, threadCounts)
+                println()
+            }
+        } finally {
+            workDir.deleteRecursively()
+        }
+    }
+
+    private fun testCompression(
+        workDir: File,
+        inputDir: File,
+        compression: LibCompressionType,
+        level: Int,
+        threadCounts: List<Int>
+    ) {
+        val archive = File(workDir, "scaling.tar")
+        val outputDir = File(workDir, "output")
+        var baseline = 0.0
+        for (threads in threadCounts) {
+            repeat(WARMUP_ROUNDS) { compress(archive, inputDir, compression, level, threads) }
+            val times = List(TEST_ROUNDS) {
+                measureTimeMillis { compress(archive, inputDir, compression, level, threads) }
+            }
+
+            // 验证多线程压缩结果可以正确解压
+            outputDir.deleteRecursively()
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchive(archive.path, outputDir.path, NativeTestFiles.noopCallback)
+            )
+            NativeTestFiles.assertSameTree(inputDir, File(outputDir, inputDir.name))
+
+            val average = times.average()
+            if (threads == 1) baseline = average
+            println("  $threads thread(s):")
+            println("    Average: ${average.toInt()} ms")
+            println("    Best: ${times.minOrNull() ?: 0L} ms")
+            println("    Speedup: ${"%.2f".format(baseline / average)}x")
+            println("    Archive size: ${archive.length() / 1024} KiB")
+        }
+    }
+
+    private fun compress(
+        archive: File,
+        inputDir: File,
+        compression: LibCompressionType,
+        level: Int,
+        threads: Int
+    ) {
+        archive.delete()
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = archive.path,
+                baseDir = inputDir.parent!!,
+                inputFiles = listOf(inputDir.path),
+                format = LibArchiveFormat.TarPax.id,
+                compression = compression.id,
+                compressionLevel = level,
+                listener = NativeTestFiles.noopCallback,
+                threads = threads
+            )
+        )
+    }
+}
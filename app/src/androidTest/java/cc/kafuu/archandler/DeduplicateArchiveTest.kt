@@ -0,0 +1,120 @@
+package cc.kafuu.archandler
+
+import android.system.Os
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.NativeStats
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import kotlin.random.Random
+
+@RunWith(AndroidJUnit4::class)
+class DeduplicateArchiveTest {
+
+    companion object {
+        private const val COPY_COUNT = 4
+        private const val COPY_SIZE = 128 * 1024
+    }
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("deduplicate_archive")
+    private val mInputDir = File(mWorkDir, "input")
+    private val mContent = Random(0).nextBytes(COPY_SIZE)
+    private lateinit var mCopies: List<File>
+
+    @Before
+    fun setUp() {
+        NativeTestFiles.writeFiles(mInputDir, 20, 4 * 1024, filesPerDir = 10, compressible = false, seed = 1)
+        mCopies = List(COPY_COUNT) { index ->
+            File(mInputDir, "copies_$index/same.bin").apply {
+                parentFile?.mkdirs()
+                writeBytes(mContent)
+            }
+        }
+    }
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testRoundTrip() {
+        for (format in listOf(LibArchiveFormat.TarPax, LibArchiveFormat.Cpio)) {
+            val plain = File(mWorkDir, "plain_${format.name}")
+            createArchive(plain, format, deduplicate = false)
+            val deduplicated = File(mWorkDir, "deduplicated_${format.name}")
+            val snapshot = NativeStats().use { stats ->
+                createArchive(deduplicated, format, deduplicate = true, stats = stats)
+                checkNotNull(stats.poll())
+            }
+            assertEquals((COPY_COUNT - 1).toLong() * COPY_SIZE, snapshot.deduplicatedBytes)
+            assertTrue(deduplicated.length() + (COPY_COUNT - 1).toLong() * COPY_SIZE <= plain.length())
+
+            // 解压后内容相同，重复的文件以硬链接写出
+            val outputDir = File(mWorkDir, "output_${format.name}")
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchive(deduplicated.path, outputDir.path, NativeTestFiles.noopCallback)
+            )
+            NativeTestFiles.assertSameTree(mInputDir, File(outputDir, mInputDir.name))
+            val restored = mCopies.map { File(outputDir, it.relativeTo(mWorkDir).path) }
+            restored.forEach { assertEquals(COPY_COUNT.toLong(), Os.stat(it.path).st_nlink) }
+            assertEquals(1, restored.map { Os.stat(it.path).st_ino }.distinct().size)
+        }
+    }
+
+    @Test
+    fun testSelectiveExtractOfLinkedCopy() {
+        val archive = File(mWorkDir, "deduplicated.tar")
+        createArchive(archive, LibArchiveFormat.TarPax, deduplicate = true)
+
+        // 逐个选中每份副本，以及同时选中多份副本；写为硬链接的副本的数据来自未被选中的那一份
+        for (selected in mCopies.map { listOf(it) } + listOf(mCopies.drop(1))) {
+            val outputDir = File(mWorkDir, "selected").apply { deleteRecursively() }
+            val paths = selected.map { it.relativeTo(mWorkDir).path }
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchiveEntries(
+                    archivePath = archive.path,
+                    outputDir = outputDir.path,
+                    entryPaths = paths.toTypedArray(),
+                    includePatterns = null,
+                    excludePatterns = null,
+                    listener = NativeTestFiles.noopCallback
+                )
+            )
+            paths.forEach { assertArrayEquals(mContent, File(outputDir, it).readBytes()) }
+            assertEquals(selected.size, outputDir.walkTopDown().count { it.isFile })
+        }
+    }
+
+    private fun createArchive(
+        archive: File,
+        format: LibArchiveFormat,
+        deduplicate: Boolean,
+        stats: NativeStats? = null
+    ) {
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = archive.path,
+                baseDir = mWorkDir.path,
+                inputFiles = listOf(mInputDir.path),
+                format = format.id,
+                compression = LibCompressionType.None.id,
+                compressionLevel = 0,
+                listener = NativeTestFiles.noopCallback,
+                statsHandle = stats?.handle ?: 0L,
+                deduplicate = deduplicate
+            )
+        )
+    }
+}
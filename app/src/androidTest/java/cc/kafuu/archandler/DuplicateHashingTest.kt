@@ -0,0 +1,59 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.feature.duplicatefinder.collectDuplicateCandidates
+import cc.kafuu.archandler.feature.duplicatefinder.groupDuplicates
+import cc.kafuu.archandler.libs.jni.NativeLib
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import java.security.MessageDigest
+import kotlin.random.Random
+
+@RunWith(AndroidJUnit4::class)
+class DuplicateHashingTest {
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("duplicate_hashing")
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testHashDuplicateCandidates() {
+        val random = Random(0)
+        val content = random.nextBytes(256 * 1024)
+        val duplicates = List(3) { file("duplicate_$it", content) }
+        // 大小相同但首部不同的文件由预哈希排除，只有末尾不同的文件需要完整哈希
+        val differentHead = file("different_head", content.copyOf().also { it[0] = (it[0] + 1).toByte() })
+        val differentMiddle = file("different_middle", content.copyOf().also { it[it.size / 2] = (it[it.size / 2] + 1).toByte() })
+        val unique = file("unique", random.nextBytes(1000))
+
+        val candidates = collectDuplicateCandidates(duplicates + differentHead + differentMiddle + unique)
+        val hashes = checkNotNull(
+            NativeLib.hashDuplicateCandidates(
+                candidates.files.map { it.path }.toTypedArray(),
+                candidates.groupIds,
+                NativeTestFiles.noopCallback
+            )
+        )
+        val hashOf = candidates.files.zip(hashes).toMap()
+        duplicates.forEach { assertEquals(sha256(content), hashOf[it]) }
+        assertEquals("", hashOf[differentHead])
+        assertEquals(sha256(differentMiddle.readBytes()), hashOf[differentMiddle])
+
+        val result = groupDuplicates(candidates.files, hashes)
+        assertEquals(listOf(duplicates), result.groups.map { it.files })
+        assertEquals(2L * content.size, result.wastedSpace)
+    }
+
+    private fun file(name: String, content: ByteArray) =
+        File(mWorkDir, name).apply { writeBytes(content) }
+
+    private fun sha256(content: ByteArray) = MessageDigest.getInstance("SHA-256")
+        .digest(content)
+        .joinToString("") { "%02x".format(it) }
+}
@@ -0,0 +1,164 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.ArchiveListing
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibChecksumAlgorithm
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+@RunWith(AndroidJUnit4::class)
+class IncrementalArchiveTest {
+
+    companion object {
+        private const val TOMBSTONE_ENTRY = ".archandler-tombstones"
+    }
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("incremental_archive")
+    private val mInputDir = File(mWorkDir, "input")
+    private val mSnapshot = File(mWorkDir, "snapshot")
+    private val mIndexDir = File(mWorkDir, "index")
+
+    @Before
+    fun setUp() {
+        NativeTestFiles.writeFiles(mInputDir, 50, 1024, filesPerDir = 10)
+        File(mInputDir, "changed.txt").writeText("original")
+        File(mInputDir, "removed.txt").writeText("removed")
+        mIndexDir.mkdirs()
+    }
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testAppendInPlaceAndRestore() {
+        val archive = File(mWorkDir, "append.tar")
+        createArchive(archive, LibCompressionType.None)
+        val baseSize = archive.length()
+        modifyInput()
+        createArchive(archive, LibCompressionType.None)
+        assertTrue(archive.length() > baseSize)
+
+        val outputDir = File(mWorkDir, "output")
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.extractArchiveChain(archive.path, emptyArray(), outputDir.path, NativeTestFiles.noopCallback)
+        )
+        NativeTestFiles.assertSameTree(mInputDir, File(outputDir, mInputDir.name))
+        assertFalse(File(outputDir, TOMBSTONE_ENTRY).exists())
+    }
+
+    @Test
+    fun testSelectiveExtractAfterAppendUsesLatestCopy() {
+        val archive = File(mWorkDir, "append.tar")
+        createArchive(archive, LibCompressionType.None)
+        modifyInput()
+        createArchive(archive, LibCompressionType.None)
+
+        // 追加后同名条目有两份，无论是否有索引都应得到最后写入的版本
+        for (indexDir in listOf(null, mIndexDir.path, mIndexDir.path)) {
+            val outputDir = File(mWorkDir, "selected").apply { deleteRecursively() }
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchiveEntries(
+                    archivePath = archive.path,
+                    outputDir = outputDir.path,
+                    entryPaths = arrayOf("${mInputDir.name}/changed.txt"),
+                    includePatterns = null,
+                    excludePatterns = null,
+                    listener = NativeTestFiles.noopCallback,
+                    indexDir = indexDir
+                )
+            )
+            assertEquals("changed content", File(outputDir, "${mInputDir.name}/changed.txt").readText())
+            assertEquals(listOf("changed.txt"), File(outputDir, mInputDir.name).list()?.toList())
+        }
+    }
+
+    @Test
+    fun testListingHidesTombstones() {
+        val archive = File(mWorkDir, "append.tar")
+        createArchive(archive, LibCompressionType.None)
+        modifyInput()
+        createArchive(archive, LibCompressionType.None)
+
+        checkNotNull(ArchiveListing.fetch(archive.path, mIndexDir.path)).use { listing ->
+            assertTrue(listing.none { it.path == TOMBSTONE_ENTRY })
+        }
+        val result = NativeLib.testArchive(archive.path, NativeTestFiles.noopCallback)
+        assertTrue(result.errorMessage, result.success)
+    }
+
+    @Test
+    fun testRestoreDeltaChainWithManifest() {
+        val base = File(mWorkDir, "base.tar.zst")
+        createArchive(base, LibCompressionType.Zstd)
+        modifyInput()
+        val delta1 = File(mWorkDir, "delta1.tar.zst")
+        createArchive(delta1, LibCompressionType.Zstd)
+        File(mInputDir, "added.txt").delete()
+        File(mInputDir, "changed.txt").writeText("changed again")
+        val delta2 = File(mWorkDir, "delta2.tar.zst")
+        createArchive(delta2, LibCompressionType.Zstd)
+        assertTrue(delta2.length() < base.length())
+
+        val outputDir = File(mWorkDir, "output")
+        val manifest = File(mWorkDir, "restore.sha256")
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.extractArchiveChain(
+                base.path,
+                arrayOf(delta1.path, delta2.path),
+                outputDir.path,
+                NativeTestFiles.noopCallback,
+                checksumAlgorithm = LibChecksumAlgorithm.Sha256.id,
+                checksumPath = manifest.path
+            )
+        )
+        NativeTestFiles.assertSameTree(mInputDir, File(outputDir, mInputDir.name))
+
+        // 整条链只写出一份清单，只包含恢复后存在的文件
+        val manifestPaths = manifest.readLines().map { it.substringAfter("  ") }
+        val expectedPaths = mInputDir.walkTopDown().filter { it.isFile }
+            .map { it.relativeTo(mWorkDir).path }.sorted().toList()
+        assertEquals(expectedPaths, manifestPaths)
+    }
+
+    /**
+     * 修改一个文件、删除一个文件并新增一个文件，修改后的文件时间与大小都与快照不同
+     */
+    private fun modifyInput() {
+        File(mInputDir, "changed.txt").apply {
+            writeText("changed content")
+            setLastModified(lastModified() + 2000)
+        }
+        File(mInputDir, "removed.txt").delete()
+        File(mInputDir, "added.txt").writeText("added")
+    }
+
+    private fun createArchive(archive: File, compression: LibCompressionType) {
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = archive.path,
+                baseDir = mWorkDir.path,
+                inputFiles = listOf(mInputDir.path),
+                format = LibArchiveFormat.TarPax.id,
+                compression = compression.id,
+                compressionLevel = if (compression == LibCompressionType.None) 0 else 3,
+                listener = NativeTestFiles.noopCallback,
+                snapshotPath = mSnapshot.path
+            )
+        )
+    }
+}
@@ -0,0 +1,88 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.NativeCallback
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.NativeListingCallback
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import java.nio.ByteBuffer
+import kotlin.coroutines.cancellation.CancellationException
+
+/**
+ * 库加载与回调取消：回调返回 false 或抛出 CancellationException 时，native 端以
+ * OperationCancelledException 中止操作并返回失败
+ */
+@RunWith(AndroidJUnit4::class)
+class NativeCancellationTest {
+
+    companion object {
+        private const val CANCELLED_MESSAGE = "Operation cancelled"
+    }
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("native_cancellation")
+    private val mInputDir = File(mWorkDir, "input")
+    private val mArchive = File(mWorkDir, "cancel.tar")
+
+    @Before
+    fun setUp() {
+        NativeTestFiles.writeFiles(mInputDir, 100, 1024)
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = mArchive.path,
+                baseDir = mWorkDir.path,
+                inputFiles = listOf(mInputDir.path),
+                format = LibArchiveFormat.TarPax.id,
+                compression = LibCompressionType.None.id,
+                compressionLevel = 0,
+                listener = NativeTestFiles.noopCallback
+            )
+        )
+    }
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testCallbackReturnsFalse() {
+        val callback = object : NativeCallback {
+            override fun onProgress(path: String, index: Int, total: Int) = false
+        }
+        assertFalse(NativeLib.extractArchive(mArchive.path, File(mWorkDir, "output").path, callback))
+        assertEquals(CANCELLED_MESSAGE, NativeLib.getLatestErrorMessage())
+    }
+
+    @Test
+    fun testCallbackThrowsCancellationException() {
+        val callback = object : NativeCallback {
+            override fun onProgress(path: String, index: Int, total: Int): Boolean =
+                throw CancellationException("cancelled")
+        }
+        assertFalse(NativeLib.extractArchive(mArchive.path, File(mWorkDir, "output").path, callback))
+        assertEquals(CANCELLED_MESSAGE, NativeLib.getLatestErrorMessage())
+
+        val result = NativeLib.testArchive(mArchive.path, callback)
+        assertFalse(result.success)
+        assertEquals(CANCELLED_MESSAGE, result.errorMessage)
+    }
+
+    @Test
+    fun testListingCallbackThrowsCancellationException() {
+        val listener = object : NativeListingCallback {
+            override fun onEntries(buffer: ByteBuffer): Boolean = throw CancellationException("cancelled")
+        }
+        assertEquals(0L, NativeLib.openArchiveTree(mArchive.path, listener = listener))
+        assertEquals(CANCELLED_MESSAGE, NativeLib.getLatestErrorMessage())
+    }
+}
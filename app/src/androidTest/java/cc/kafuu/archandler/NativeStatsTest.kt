@@ -0,0 +1,110 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.NativeCallback
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.NativeStats
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+@RunWith(AndroidJUnit4::class)
+class NativeStatsTest {
+
+    companion object {
+        private const val FILE_COUNT = 300
+        private const val FILE_SIZE = 64 * 1024
+    }
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("native_stats")
+    private val mInputDir = File(mWorkDir, "input")
+    private val mArchive = File(mWorkDir, "stats.tar.zst")
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testCreateStats() {
+        NativeTestFiles.writeFiles(mInputDir, FILE_COUNT, FILE_SIZE)
+        val snapshot = NativeStats().use { stats ->
+            createArchive(stats)
+            checkNotNull(stats.poll())
+        }
+        val inputBytes = FILE_COUNT.toLong() * FILE_SIZE
+        assertEquals(inputBytes, snapshot.totalBytes)
+        assertEquals(inputBytes, snapshot.progressBytes)
+        assertEquals(inputBytes, snapshot.bytesRead)
+        assertEquals(mArchive.length(), snapshot.compressedBytes)
+        assertEquals(FILE_COUNT.toLong(), snapshot.files)
+        assertEquals(1f, snapshot.fraction)
+    }
+
+    @Test
+    fun testExtractStats() {
+        NativeTestFiles.writeFiles(mInputDir, FILE_COUNT, FILE_SIZE)
+        createArchive(null)
+
+        val outputDir = File(mWorkDir, "output")
+        val snapshot = NativeStats().use { stats ->
+            // 在回调中轮询，已处理字节数应单调不减且不超过总量
+            var lastProgress = 0L
+            val callback = object : NativeCallback {
+                override fun onProgress(path: String, index: Int, total: Int): Boolean {
+                    val current = checkNotNull(stats.poll())
+                    assertTrue(current.progressBytes >= lastProgress)
+                    assertTrue(current.totalBytes <= 0 || current.progressBytes <= current.totalBytes)
+                    lastProgress = current.progressBytes
+                    return true
+                }
+            }
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchive(mArchive.path, outputDir.path, callback, statsHandle = stats.handle)
+            )
+            checkNotNull(stats.poll())
+        }
+        assertEquals(mArchive.length(), snapshot.totalBytes)
+        assertEquals(mArchive.length(), snapshot.progressBytes)
+        assertEquals(FILE_COUNT.toLong() * FILE_SIZE, snapshot.bytesWritten)
+        assertEquals(FILE_COUNT.toLong(), snapshot.files)
+        NativeTestFiles.assertSameTree(mInputDir, File(outputDir, mInputDir.name))
+    }
+
+    @Test
+    fun testTestStats() {
+        NativeTestFiles.writeFiles(mInputDir, FILE_COUNT, FILE_SIZE)
+        createArchive(null)
+
+        val snapshot = NativeStats().use { stats ->
+            val result = NativeLib.testArchive(mArchive.path, NativeTestFiles.noopCallback, statsHandle = stats.handle)
+            assertTrue(result.errorMessage, result.success)
+            checkNotNull(stats.poll())
+        }
+        assertEquals(FILE_COUNT.toLong() * FILE_SIZE, snapshot.bytesRead)
+        assertEquals(0L, snapshot.bytesWritten)
+        assertEquals(FILE_COUNT.toLong(), snapshot.files)
+    }
+
+    private fun createArchive(stats: NativeStats?) {
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = mArchive.path,
+                baseDir = mWorkDir.path,
+                inputFiles = listOf(mInputDir.path),
+                format = LibArchiveFormat.TarPax.id,
+                compression = LibCompressionType.Zstd.id,
+                compressionLevel = 3,
+                listener = NativeTestFiles.noopCallback,
+                statsHandle = stats?.handle ?: 0L
+            )
+        )
+    }
+}
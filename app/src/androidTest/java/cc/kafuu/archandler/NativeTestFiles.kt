@@ -0,0 +1,70 @@
+package cc.kafuu.archandler
+
+import androidx.test.platform.app.InstrumentationRegistry
+import cc.kafuu.archandler.libs.jni.NativeCallback
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertEquals
+import java.io.File
+import kotlin.random.Random
+
+/**
+ * native 打包/解压测试共用的临时文件工具
+ */
+object NativeTestFiles {
+    val noopCallback = object : NativeCallback {
+        override fun onProgress(path: String, index: Int, total: Int) = true
+    }
+
+    /**
+     * 在应用缓存目录下创建空的工作目录，已存在时先清空
+     */
+    fun newWorkDir(name: String): File {
+        val context = InstrumentationRegistry.getInstrumentation().targetContext
+        return File(context.cacheDir, name).apply {
+            deleteRecursively()
+            mkdirs()
+        }
+    }
+
+    /**
+     * 在 [root] 下写出 [count] 个大小为 [size] 的文件，每 [filesPerDir] 个文件放在一个子目录中
+     * @param compressible 为 true 时写出可压缩的重复文本，否则写出随机字节
+     */
+    fun writeFiles(
+        root: File,
+        count: Int,
+        size: Int,
+        filesPerDir: Int = 100,
+        compressible: Boolean = true,
+        seed: Int = 0
+    ): List<File> {
+        val random = Random(seed)
+        return List(count) { index ->
+            val file = File(root, "dir_${index / filesPerDir}/file_$index.txt")
+            file.parentFile?.mkdirs()
+            file.writeBytes(content(random, index, size, compressible))
+            file
+        }
+    }
+
+    private fun content(random: Random, index: Int, size: Int, compressible: Boolean): ByteArray {
+        if (!compressible) return random.nextBytes(size)
+        val line = "line of file $index with some repeated text\n".toByteArray()
+        return ByteArray(size) { line[it % line.size] }
+    }
+
+    /**
+     * 断言两个目录下的普通文件相对路径与内容完全相同
+     */
+    fun assertSameTree(expected: File, actual: File) {
+        val expectedFiles = relativeFiles(expected)
+        assertEquals(expectedFiles.keys, relativeFiles(actual).keys)
+        expectedFiles.forEach { (path, file) ->
+            assertArrayEquals(path, file.readBytes(), File(actual, path).readBytes())
+        }
+    }
+
+    private fun relativeFiles(root: File) = root.walkTopDown()
+        .filter { it.isFile }
+        .associateBy { it.relativeTo(root).path }
+}
@@ -0,0 +1,158 @@
+package cc.kafuu.archandler
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
+import cc.kafuu.archandler.libs.jni.model.LibCompressionType
+import org.junit.After
+import org.junit.Assert.assertArrayEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+import kotlin.system.measureTimeMillis
+
+@RunWith(AndroidJUnit4::class)
+class SmallFileExtractionTest {
+
+    companion object {
+        private const val WARMUP_ROUNDS = 1
+        private const val TEST_ROUNDS = 3
+        private const val BENCHMARK_FILE_COUNT = 20_000
+        private const val BENCHMARK_FILE_SIZE = 2 * 1024
+    }
+
+    private val mWorkDir = NativeTestFiles.newWorkDir("small_file_extraction")
+
+    @After
+    fun tearDown() {
+        mWorkDir.deleteRecursively()
+    }
+
+    @Test
+    fun testRoundTrip() {
+        val inputDir = File(mWorkDir, "input")
+        // 混合小文件与超过小文件阈值的大文件，验证两类写出路径交替时的结果
+        NativeTestFiles.writeFiles(inputDir, 500, 4 * 1024, filesPerDir = 50)
+        NativeTestFiles.writeFiles(File(inputDir, "large"), 4, 512 * 1024, compressible = false)
+
+        for (format in listOf(LibArchiveFormat.TarPax, LibArchiveFormat.Zip)) {
+            val archive = File(mWorkDir, "round_trip_${format.name}")
+            createArchive(archive, inputDir, format, LibCompressionType.None)
+            for ((pipelined, writers) in listOf(false to 1, true to 1, false to 0, true to 0)) {
+                val outputDir = File(mWorkDir, "output_${format.name}_${pipelined}_$writers")
+                assertTrue(
+                    NativeLib.getLatestErrorMessage(),
+                    NativeLib.extractArchive(
+                        archive.path,
+                        outputDir.path,
+                        NativeTestFiles.noopCallback,
+                        pipelined = pipelined,
+                        smallFileWriters = writers
+                    )
+                )
+                NativeTestFiles.assertSameTree(inputDir, File(outputDir, inputDir.name))
+            }
+        }
+    }
+
+    @Test
+    fun testOverwriteExistingFiles() {
+        val inputDir = File(mWorkDir, "input")
+        val files = NativeTestFiles.writeFiles(inputDir, 200, 1024)
+        val archive = File(mWorkDir, "overwrite.tar")
+        createArchive(archive, inputDir, LibArchiveFormat.TarPax, LibCompressionType.None)
+
+        val outputDir = File(mWorkDir, "output")
+        val stale = File(outputDir, "${inputDir.name}/${files[0].relativeTo(inputDir).path}")
+        stale.parentFile?.mkdirs()
+        stale.writeText("stale")
+
+        // 不覆盖时保留已存在的文件，其余文件正常写出
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.extractArchive(
+                archive.path,
+                outputDir.path,
+                NativeTestFiles.noopCallback,
+                overwrite = false,
+                smallFileWriters = 0
+            )
+        )
+        assertArrayEquals("stale".toByteArray(), stale.readBytes())
+        assertArrayEquals(files[1].readBytes(), File(stale.parentFile, files[1].name).readBytes())
+
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.extractArchive(archive.path, outputDir.path, NativeTestFiles.noopCallback)
+        )
+        NativeTestFiles.assertSameTree(inputDir, File(outputDir, inputDir.name))
+    }
+
+    @Test
+    fun testManySmallFilesPerformance() {
+        println("\n========== Small File Extraction Performance Test ==========\n")
+
+        val inputDir = File(mWorkDir, "input")
+        NativeTestFiles.writeFiles(inputDir, BENCHMARK_FILE_COUNT, BENCHMARK_FILE_SIZE)
+
+        for ((format, compression) in listOf(
+            LibArchiveFormat.TarPax to LibCompressionType.None,
+            LibArchiveFormat.TarPax to LibCompressionType.Zstd,
+            LibArchiveFormat.Zip to LibCompressionType.None
+        )) {
+            println("Testing ${format.name} + ${compression.name} with $BENCHMARK_FILE_COUNT files...")
+            val archive = File(mWorkDir, "benchmark_${format.name}_${compression.name}")
+            createArchive(archive, inputDir, format, compression)
+            val outputDir = File(mWorkDir, "output")
+
+            // 1 为逐个写盘的基线，0 为按 CPU 核心数并行写出小文件
+            for (writers in listOf(1, 0)) {
+                repeat(WARMUP_ROUNDS) { extract(archive, outputDir, writers) }
+                val times = List(TEST_ROUNDS) { extract(archive, outputDir, writers) }
+                NativeTestFiles.assertSameTree(inputDir, File(outputDir, inputDir.name))
+
+                val average = times.average()
+                println("  Writers $writers average: ${average.toInt()} ms")
+                println("  Writers $writers best: ${times.minOrNull() ?: 0L} ms")
+                println("  Writers $writers files per second: ${(BENCHMARK_FILE_COUNT * 1000 / average).toInt()}")
+            }
+            println()
+        }
+    }
+
+    private fun extract(archive: File, outputDir: File, smallFileWriters: Int): Long {
+        outputDir.deleteRecursively()
+        return measureTimeMillis {
+            assertTrue(
+                NativeLib.getLatestErrorMessage(),
+                NativeLib.extractArchive(
+                    archive.path,
+                    outputDir.path,
+                    NativeTestFiles.noopCallback,
+                    smallFileWriters = smallFileWriters
+                )
+            )
+        }
+    }
+
+    private fun createArchive(
+        archive: File,
+        inputDir: File,
+        format: LibArchiveFormat,
+        compression: LibCompressionType
+    ) {
+        assertTrue(
+            NativeLib.getLatestErrorMessage(),
+            NativeLib.createArchive(
+                outputPath = archive.path,
+                baseDir = inputDir.parent!!,
+                inputFiles = listOf(inputDir.path),
+                format = format.id,
+                compression = compression.id,
+                compressionLevel = if (compression == LibCompressionType.None) 0 else 3,
+                listener = NativeTestFiles.noopCallback
+            )
+        )
+    }
+}
@@ -1,20 +1,33 @@
 #include <archive.h>
 #include <archive_entry.h>
 #include <algorithm>
+#include <chrono>
 #include <cerrno>
 #include <cstdint>
+#include <ctime>
 #include <filesystem>
 #include <functional>
+#include <map>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <fstream>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#include <lzma.h>
 
 #include "native_logger.hpp"
 #include "archive_builder.hpp"
-#include "utils/file_utils.hpp"
+#include "file_hasher.hpp"
+#include "incremental_snapshot.hpp"
+#include "scan_manifest.hpp"
+#include "utils/thread_pool.hpp"
 
 ArchiveBuilder::ArchiveBuilder(
         std::string output_path,
@@ -33,6 +46,12 @@ ArchiveBuilder::ArchiveBuilder(
     compression_(compression),
     compression_level_(compression_level) {}
 
+ArchiveBuilder::~ArchiveBuilder() {
+    // 关闭 archive 时仍可能向追加的文件写出数据
+    archive_.reset();
+    if (append_fd_ >= 0) close(append_fd_);
+}
+
 int32_t
 ArchiveBuilder::ConfigureZipOptions(CompressionType compression, int32_t compression_level) {
     auto lvl = std::clamp(compression_level, 0, 9);
@@ -46,8 +65,42 @@ ArchiveBuilder::ConfigureZipOptions(CompressionType compression, int32_t compres
     return archive_write_set_options(archive_.get(), opt.c_str());
 }
 
+namespace {
+    /**
+     * 计算实际使用的压缩线程数
+     * xz 多线程编码每个线程都需要独立的字典与 block 缓冲，高等级下单线程即可占用数百 MB，
+     * 因此按物理内存的 1/4 限制线程数
+     */
+    int32_t ResolveCompressionThreads(
+            CompressionType compression,
+            int32_t compression_level,
+            int32_t threads
+    ) {
+        if (compression == CompressionType::None) return 1;
+        threads = ResolveThreadCount(threads);
+        if (compression != CompressionType::Xz || threads == 1) return threads;
+
+        auto pages = sysconf(_SC_PHYS_PAGES);
+        auto page_size = sysconf(_SC_PAGESIZE);
+        if (pages <= 0 || page_size <= 0) return threads;
+        auto memory_limit = static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size) / 4;
+        lzma_mt mt{};
+        mt.preset = static_cast<uint32_t>(std::clamp(compression_level, 0, 9));
+        mt.check = LZMA_CHECK_CRC64;
+        for (; threads > 1; --threads) {
+            mt.threads = static_cast<uint32_t>(threads);
+            if (lzma_stream_encoder_mt_memusage(&mt) <= memory_limit) break;
+        }
+        return threads;
+    }
+}
+
 int32_t
-ArchiveBuilder::AddFilterAndSetLevel(CompressionType compression, int32_t compression_level) {
+ArchiveBuilder::AddFilterAndSetLevel(
+        CompressionType compression,
+        int32_t compression_level,
+        int32_t threads
+) {
     int32_t rc = ARCHIVE_OK;
     switch (compression) {
         case CompressionType::None:
@@ -74,13 +127,17 @@ ArchiveBuilder::AddFilterAndSetLevel(CompressionType compression, int32_t compre
             if (rc != ARCHIVE_OK) return rc;
             int lvl = std::clamp(compression_level, 0, 9);
             std::string opt = "xz:compression-level=" + std::to_string(lvl);
+            // 多线程时 liblzma 按 block 切分输出，各 block 并行压缩
+            if (threads > 1) opt += ",xz:threads=" + std::to_string(threads);
             rc = archive_write_set_options(archive_.get(), opt.c_str());
             break;
         }
         case CompressionType::Lz4: {
             rc = archive_write_add_filter_lz4(archive_.get());
             if (rc != ARCHIVE_OK) return rc;
-            rc = archive_write_set_options(archive_.get(), nullptr);
+            int lvl = std::clamp(compression_level, 1, 9);
+            std::string opt = "lz4:compression-level=" + std::to_string(lvl);
+            rc = archive_write_set_options(archive_.get(), opt.c_str());
             break;
         }
         case CompressionType::Zstd: {
@@ -88,6 +145,7 @@ ArchiveBuilder::AddFilterAndSetLevel(CompressionType compression, int32_t compre
             if (rc != ARCHIVE_OK) return rc;
             int lvl = std::clamp(compression_level, 1, 19);
             std::string opt = "compression-level=" + std::to_string(lvl);
+            if (threads > 1) opt += ",zstd:threads=" + std::to_string(threads);
             rc = archive_write_set_options(archive_.get(), opt.c_str());
             break;
         }
@@ -125,6 +183,216 @@ void ArchiveBuilder::SetArchiveFormat(ArchiveFormat format) {
 }
 
 
+namespace {
+    constexpr size_t k_tar_block_size = 512;
+    // pax 扩展头的最大读取长度，超过时不解析其中的 size 记录
+    constexpr uint64_t k_max_pax_header_size = 1024 * 1024;
+
+    bool ReadFullyAt(int fd, void *buffer, size_t length, uint64_t offset, size_t &read_bytes) {
+        read_bytes = 0;
+        auto ptr = static_cast<uint8_t *>(buffer);
+        while (read_bytes < length) {
+            auto n = pread64(fd, ptr + read_bytes, length - read_bytes,
+                             static_cast<off64_t>(offset + read_bytes));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return false;
+            if (n == 0) break;
+            read_bytes += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * tar header 中的数字字段：八进制文本，或最高位置 1 的 base-256 大数
+     */
+    uint64_t ParseTarNumber(const uint8_t *field, size_t length) {
+        uint64_t value = 0;
+        if (field[0] & 0x80) {
+            value = field[0] & 0x3f;
+            for (size_t i = 1; i < length; ++i) value = (value << 8) | field[i];
+            return value;
+        }
+        size_t i = 0;
+        while (i < length && field[i] == ' ') ++i;
+        for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+            value = value * 8 + (field[i] - '0');
+        }
+        return value;
+    }
+
+    bool IsValidTarHeader(const uint8_t *header) {
+        // 校验和字段本身按空格计算，兼容旧实现的有符号求和
+        uint64_t unsigned_sum = 0;
+        int64_t signed_sum = 0;
+        for (size_t i = 0; i < k_tar_block_size; ++i) {
+            auto byte = (i >= 148 && i < 156) ? uint8_t(' ') : header[i];
+            unsigned_sum += byte;
+            signed_sum += static_cast<int8_t>(byte);
+        }
+        auto checksum = ParseTarNumber(header + 148, 8);
+        return checksum == unsigned_sum || static_cast<int64_t>(checksum) == signed_sum;
+    }
+
+    /**
+     * 在 pax 扩展头数据中查找 size 记录（"<长度> size=<值>\n"）
+     */
+    std::optional<uint64_t> FindPaxSize(std::string_view data) {
+        while (!data.empty()) {
+            size_t length = 0, i = 0;
+            while (i < data.size() && data[i] >= '0' && data[i] <= '9') {
+                length = length * 10 + static_cast<size_t>(data[i++] - '0');
+            }
+            if (length == 0 || length > data.size()) break;
+            auto record = data.substr(i, length - i);
+            constexpr std::string_view k_key = " size=";
+            if (record.substr(0, k_key.size()) == k_key) {
+                return std::strtoull(std::string(record.substr(k_key.size())).c_str(), nullptr, 10);
+            }
+            data.remove_prefix(length);
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * 未压缩 tar 中结束标记的起始位置（没有结束标记时为文件末尾），新成员从这里覆盖写入
+     * 逐个读取 512 字节的 header 并按 size 跳过数据，只访问 header 所在的块
+     * @throw std::runtime_error 不是有效的未压缩 tar，或包含无法定位结尾的条目
+     */
+    uint64_t FindTarAppendOffset(int fd, const std::string &path) {
+        uint8_t header[k_tar_block_size];
+        uint64_t offset = 0;
+        std::optional<uint64_t> pax_size;
+        while (true) {
+            size_t read_bytes = 0;
+            if (!ReadFullyAt(fd, header, sizeof(header), offset, read_bytes)) {
+                throw std::runtime_error("Cannot read archive: " + path);
+            }
+            if (read_bytes == 0) return offset;
+            if (read_bytes < sizeof(header)) {
+                throw std::runtime_error("Truncated tar archive: " + path);
+            }
+            if (std::all_of(header, header + sizeof(header), [](uint8_t b) { return b == 0; })) {
+                return offset;
+            }
+            if (!IsValidTarHeader(header)) {
+                throw std::runtime_error("Not an uncompressed tar archive: " + path);
+            }
+            auto type = static_cast<char>(header[156]);
+            // GNU 旧式稀疏条目的扩展 header 需要另行解析
+            if (type == 'S') {
+                throw std::runtime_error("Cannot append to a tar archive with GNU sparse entries");
+            }
+            uint64_t size = ParseTarNumber(header + 124, 12);
+            if (type == 'x') {
+                if (size <= k_max_pax_header_size) {
+                    std::string data(static_cast<size_t>(size), '\0');
+                    if (ReadFullyAt(fd, data.data(), data.size(), offset + k_tar_block_size,
+                                    read_bytes) && read_bytes == data.size()) {
+                        pax_size = FindPaxSize(data);
+                    }
+                }
+            } else if (type != 'g' && type != 'L' && type != 'K') {
+                // pax 扩展头中的 size 覆盖紧随其后的 header 的 size 字段
+                size = pax_size.value_or(size);
+                pax_size.reset();
+                // 链接、设备与目录条目没有数据
+                if (type == '2' || type == '3' || type == '4' || type == '5' || type == '6') {
+                    size = 0;
+                }
+            }
+            offset += k_tar_block_size + (size + k_tar_block_size - 1) / k_tar_block_size *
+                                         k_tar_block_size;
+        }
+    }
+
+    bool IsTarFormat(ArchiveFormat format) {
+        return format == ArchiveFormat::TarUstar || format == ArchiveFormat::TarPax ||
+               format == ArchiveFormat::TarGnu || format == ArchiveFormat::TarV7;
+    }
+
+    bool SupportsHardlinks(ArchiveFormat format) {
+        return IsTarFormat(format) || format == ArchiveFormat::Cpio;
+    }
+}
+
+void ArchiveBuilder::OpenAppendOrThrow() {
+    if (!IsTarFormat(format_) || compression_ != CompressionType::None) {
+        throw std::runtime_error(
+                "Only uncompressed tar archives can be updated in place, "
+                "write the increment to a new archive: " + output_path_);
+    }
+    append_fd_ = open(output_path_.c_str(), O_RDWR | O_CLOEXEC);
+    if (append_fd_ < 0) {
+        throw std::runtime_error("Cannot open archive for update: " + output_path_);
+    }
+    auto offset = FindTarAppendOffset(append_fd_, output_path_);
+    if (lseek64(append_fd_, static_cast<off64_t>(offset), SEEK_SET) < 0) {
+        throw std::runtime_error("Cannot seek archive for update: " + output_path_);
+    }
+}
+
+/**
+ * 打开输出：使用自定义压缩流时由回调接收格式层输出，原地追加时写入已定位的文件，否则直接写文件
+ */
+void ArchiveBuilder::OpenOutputOrThrow() {
+    int rc;
+    if (append_fd_ >= 0) {
+        rc = archive_write_open_fd(archive_.get(), append_fd_);
+    } else if (compressor_) {
+        // 不做块缓冲，保证条目边界处的数据已全部交给压缩流
+        archive_write_set_bytes_per_block(archive_.get(), 0);
+        rc = archive_write_open2(archive_.get(), this, nullptr,
+                                 &ArchiveBuilder::OnCompressorWrite,
+                                 &ArchiveBuilder::OnCompressorClose, nullptr);
+    } else {
+        rc = archive_write_open_filename(archive_.get(), output_path_.c_str());
+    }
+    if (rc != ARCHIVE_OK) {
+        throw std::runtime_error(
+                "Failed to open output archive: " +
+                std::string(archive_error_string(archive_.get())));
+    }
+}
+
+la_ssize_t ArchiveBuilder::OnCompressorWrite(
+        struct archive *a, void *client_data, const void *buffer, size_t length
+) {
+    auto self = static_cast<ArchiveBuilder *>(client_data);
+    try {
+        self->compressor_->Write(buffer, length);
+        return static_cast<la_ssize_t>(length);
+    } catch (const std::exception &exception) {
+        archive_set_error(a, EIO, "%s", exception.what());
+        return -1;
+    }
+}
+
+int ArchiveBuilder::OnCompressorClose(struct archive *a, void *client_data) {
+    auto self = static_cast<ArchiveBuilder *>(client_data);
+    try {
+        self->compressor_->Finish();
+        return ARCHIVE_OK;
+    } catch (const std::exception &exception) {
+        archive_set_error(a, EIO, "%s", exception.what());
+        return ARCHIVE_FATAL;
+    }
+}
+
+/**
+ * 条目写入完成，通知压缩流当前位于条目边界
+ */
+void ArchiveBuilder::EndEntry(const std::filesystem::path &path) {
+    if (!compressor_) return;
+    // 先结束条目，使 tar 的数据填充也落在当前帧内
+    if (archive_write_finish_entry(archive_.get()) != ARCHIVE_OK) {
+        throw std::runtime_error(
+                "Failed to finish entry " + path.string() + ": " +
+                archive_error_string(archive_.get())
+        );
+    }
+    compressor_->EndEntry();
+}
+
 /**
  * 写入 header 并处理错误
  */
@@ -140,57 +408,199 @@ void ArchiveBuilder::WriteHeaderOrThrow(archive_entry *entry, const std::filesys
 /**
  * 写文件内容到 archive
  */
-void ArchiveBuilder::WriteFileToArchive(const std::filesystem::path &path) {
-    std::ifstream in(path, std::ios::binary);
-    if (!in) throw std::runtime_error("Cannot open file: " + path.string());
+void ArchiveBuilder::WriteFileToArchive(
+        const std::filesystem::path &path,
+        ChecksumManifest::Digest *digest
+) {
+    // 压缩（archive_write_data）之外的时间计为读取源文件的 I/O 耗时
+    auto start = std::chrono::steady_clock::now();
+    uint64_t codec_ns = 0;
+    uint64_t offset = 0;
+    file_reader_.ReadFile(path.string(), [&](const void *data, size_t length) {
+        auto codec_start = std::chrono::steady_clock::now();
+        if (stats_) {
+            stats_->AddBytesRead(length);
+            stats_->AddBytesWritten(length);
+        }
+        auto ptr = static_cast<const char *>(data);
+        while (length > 0) {
+            auto written = archive_write_data(archive_.get(), ptr, length);
+            if (written < 0) {
+                throw std::runtime_error(
+                        "Write data error for " + path.string() + ": " +
+                        archive_error_string(archive_.get())
+                );
+            }
+            // 已写满 header 中记录的大小（文件在打包过程中变大），其余数据丢弃
+            if (written == 0) break;
+            if (digest) digest->Update(ptr, static_cast<size_t>(written), offset);
+            offset += static_cast<uint64_t>(written);
+            ptr += written;
+            length -= static_cast<size_t>(written);
+        }
+        if (!stats_) return;
+        stats_->SetCompressedBytes(OutputBytes());
+        codec_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - codec_start).count());
+    });
+    if (!stats_) return;
+    auto total_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    stats_->AddPhaseNanos(OperationStats::Phase::Codec, codec_ns);
+    stats_->AddPhaseNanos(OperationStats::Phase::Io, total_ns - std::min(total_ns, codec_ns));
+}
+
+void ArchiveBuilder::WriteGeneratedEntry(const std::string &name, const std::string &content) {
+    std::filesystem::path path = name;
+    auto entry = CreateArchiveEntry(name, 0644);
+    archive_entry_set_filetype(entry.get(), AE_IFREG);
+    archive_entry_set_size(entry.get(), static_cast<la_int64_t>(content.size()));
+    archive_entry_set_mtime(entry.get(), time(nullptr), 0);
+    WriteHeaderOrThrow(entry.get(), path);
+    if (!content.empty() &&
+        archive_write_data(archive_.get(), content.data(), content.size()) < 0) {
+        throw std::runtime_error(
+                "Write data error for " + path.string() + ": " +
+                archive_error_string(archive_.get())
+        );
+    }
+    EndEntry(path);
+}
+
+uint64_t ArchiveBuilder::OutputBytes() const {
+    if (compressor_) return compressor_->BytesWritten();
+    return static_cast<uint64_t>(std::max<la_int64_t>(0, archive_filter_bytes(archive_.get(), -1)));
+}
 
-    std::vector<char> buffer(8192);
-    while (in) {
-        in.read(buffer.data(), buffer.size());
-        std::streamsize bytesRead = in.gcount();
-        if (bytesRead == 0) break;
+ArchiveBuilder::DuplicateLinks ArchiveBuilder::FindDuplicates(
+        const ScanManifest &manifest,
+        const std::function<bool(const ScanManifest::Entry &)> &is_candidate,
+        size_t total_files
+) const {
+    const auto &entries = manifest.entries();
+    DuplicateLinks links;
+    links.targets.assign(entries.size(), std::string::npos);
+    links.counts.assign(entries.size(), 1);
 
-        if (archive_write_data(archive_.get(), buffer.data(), bytesRead) < 0) {
-            throw std::runtime_error(
-                    "Write data error for " + path.string() + ": " +
-                    archive_error_string(archive_.get())
-            );
+    // 空文件写为硬链接不会更小
+    std::unordered_map<int64_t, std::vector<size_t>> by_size;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto &item = entries[i];
+        if (S_ISREG(item.mode) && item.size > 0 && is_candidate(item)) {
+            by_size[item.size].push_back(i);
+        }
+    }
+
+    // 每组中 dev/ino 相同的条目共用第一个条目（代表）的哈希，只有代表参与哈希
+    std::vector<const std::vector<size_t> *> groups;
+    std::unordered_map<size_t, size_t> representatives;
+    std::unordered_map<size_t, size_t> hash_slots;
+    std::vector<std::string> paths;
+    std::vector<int32_t> path_groups;
+    for (const auto &[size, indices]: by_size) {
+        if (indices.size() < 2) continue;
+        groups.push_back(&indices);
+        std::map<std::pair<dev_t, uint64_t>, size_t> by_inode;
+        std::vector<size_t> unique;
+        for (auto i: indices) {
+            auto key = std::make_pair(entries[i].dev, entries[i].ino);
+            auto [it, inserted] = by_inode.emplace(key, i);
+            representatives[i] = it->second;
+            if (inserted) unique.push_back(i);
+        }
+        if (unique.size() < 2) continue;
+        for (auto i: unique) {
+            hash_slots[i] = paths.size();
+            paths.push_back(manifest.SourcePath(entries[i]));
+            path_groups.push_back(static_cast<int32_t>(groups.size() - 1));
         }
     }
+    if (groups.empty()) return links;
+
+    FileHasher hasher;
+    hasher.SetListener([this, total_files](const std::string &path, size_t, size_t) {
+        // 哈希期间也需要响应取消
+        if (listener_) listener_(path, 0, total_files);
+    });
+    auto digests = hasher.HashCandidates(paths, path_groups);
+
+    for (auto indices: groups) {
+        // 条目按清单顺序排列，内容相同的第一个条目写出数据
+        std::unordered_map<std::string_view, size_t> first_by_digest;
+        for (auto i: *indices) {
+            auto target = representatives[i];
+            auto slot = hash_slots.find(target);
+            if (slot != hash_slots.end() && !digests[slot->second].empty()) {
+                target = first_by_digest.emplace(digests[slot->second], target).first->second;
+            }
+            if (target == i) continue;
+            links.targets[i] = target;
+            ++links.counts[target];
+        }
+        for (auto i: *indices) {
+            if (links.targets[i] != std::string::npos) {
+                links.counts[i] = links.counts[links.targets[i]];
+            }
+        }
+    }
+    return links;
 }
 
 /**
- * 递归低将给定的路径添加到压缩包
+ * 将扫描清单中的一个条目写入压缩包
  */
 void ArchiveBuilder::AddToArchive(
-        const std::filesystem::path &path,
+        const ScanManifest &manifest,
+        const ScanManifest::Entry &item,
+        const DuplicateLinks &links,
+        ChecksumManifest::Digest *digest,
         const std::function<void(const std::string &path)> &on_progress
 ) {
     struct stat st{};
-    if (stat(path.c_str(), &st) != 0) {
-        throw std::runtime_error("Cannot stat file: " + path.string());
-    }
+    ScanManifest::ToStat(item, &st);
+    std::filesystem::path path = manifest.SourcePath(item);
 
-    auto entry_name = std::filesystem::relative(path, base_dir_).u8string();
-    if (S_ISDIR(st.st_mode) && !entry_name.empty() && entry_name.back() != '/') entry_name += '/';
-    if (entry_name.empty()) return;
-
-    auto entry = CreateArchiveEntry(entry_name);
+    auto entry = CreateArchiveEntry(std::string(manifest.Name(item)));
     archive_entry_copy_stat(entry.get(), &st);
     if (S_ISDIR(st.st_mode)) {
         archive_entry_set_filetype(entry.get(), AE_IFDIR);
         archive_entry_set_size(entry.get(), 0);
+        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
         WriteHeaderOrThrow(entry.get(), path);
-
-        for (const auto &p: std::filesystem::directory_iterator(path)) {
-            AddToArchive(p.path(), on_progress);
-        }
+        EndEntry(path);
     } else if (S_ISREG(st.st_mode)) {
         if (listener_) on_progress(path.string());
         archive_entry_set_filetype(entry.get(), AE_IFREG);
         archive_entry_set_size(entry.get(), st.st_size);
-        WriteHeaderOrThrow(entry.get(), path);
-        WriteFileToArchive(path);
+        auto index = static_cast<size_t>(&item - manifest.entries().data());
+        if (!links.targets.empty()) archive_entry_set_nlink(entry.get(), links.counts[index]);
+        if (!links.targets.empty() && links.targets[index] != std::string::npos) {
+            // tar 依据链接目标、cpio 依据相同的 dev/ino 与 nlink 还原为硬链接
+            const auto &target = manifest.entries()[links.targets[index]];
+            auto target_name = std::string(manifest.Name(target));
+            archive_entry_set_hardlink_utf8(entry.get(), target_name.c_str());
+            archive_entry_set_dev(entry.get(), target.dev);
+            archive_entry_set_ino64(entry.get(), static_cast<la_int64_t>(target.ino));
+            archive_entry_set_size(entry.get(), 0);
+            {
+                OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+                WriteHeaderOrThrow(entry.get(), path);
+            }
+            EndEntry(path);
+            if (!stats_) return;
+            stats_->AddDeduplicatedBytes(static_cast<uint64_t>(st.st_size));
+            stats_->AddFile();
+            return;
+        }
+        {
+            OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+            WriteHeaderOrThrow(entry.get(), path);
+        }
+        WriteFileToArchive(path, digest);
+        // 文件在打包过程中变小时格式层以 0 填充到 header 中记录的大小
+        if (digest) digest->Commit(std::string(manifest.Name(item)), st.st_size);
+        EndEntry(path);
+        if (stats_) stats_->AddFile();
     }
 }
 
@@ -198,6 +608,11 @@ void ArchiveBuilder::AddToArchive(
 void ArchiveBuilder::Create() {
     if (!archive_) throw std::runtime_error("Failed to create archive object.");
 
+    // 增量打包：存在上一次的快照且输出已存在时原地追加
+    std::optional<IncrementalSnapshot> snapshot;
+    if (!snapshot_path_.empty()) snapshot = IncrementalSnapshot::Load(snapshot_path_);
+    if (snapshot && std::filesystem::exists(output_path_)) OpenAppendOrThrow();
+
     int rc = ARCHIVE_OK;
     if (format_ == ArchiveFormat::Zip) {
         SetArchiveFormat(format_);
@@ -208,7 +623,19 @@ void ArchiveBuilder::Create() {
                     std::string(archive_error_string(archive_.get())));
         }
     } else {
-        rc = AddFilterAndSetLevel(compression_, compression_level_);
+        auto threads = ResolveCompressionThreads(compression_, compression_level_, threads_);
+        // xar 自带 toc 与压缩，仅 tar/cpio 这类流式格式可按条目切分压缩帧
+        if (seekable_ && format_ != ArchiveFormat::Xar) {
+            compressor_ = CreateSeekableCompressor(
+                    compression_, compression_level_, threads, output_path_);
+        }
+        // gzip/bzip2/lz4 的 libarchive 过滤器只能单线程，多线程时改为分块并行压缩
+        if (!compressor_ && threads > 1) {
+            compressor_ = CreateParallelCompressor(
+                    compression_, compression_level_, threads, output_path_);
+        }
+        rc = compressor_ ? archive_write_add_filter_none(archive_.get())
+                         : AddFilterAndSetLevel(compression_, compression_level_, threads);
         if (rc != ARCHIVE_OK) {
             throw std::runtime_error("Failed to set compression filter/options: " +
                                      std::string(archive_error_string(archive_.get())));
@@ -216,17 +643,89 @@ void ArchiveBuilder::Create() {
         SetArchiveFormat(format_);
     }
 
-    if (archive_write_open_filename(archive_.get(), output_path_.c_str()) != ARCHIVE_OK) {
-        throw std::runtime_error(
-                "Failed to open output archive: " +
-                std::string(archive_error_string(archive_.get())));
-    }
+    OpenOutputOrThrow();
 
-    size_t total_files = CountFilesRecursively(input_files_);
+    if (stats_) stats_->Begin(0, OperationStats::Basis::BytesRead);
+    // 只遍历一次输入目录树，清单同时提供进度总数与写入顺序
+    auto manifest = [&] {
+        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+        return ScanManifest::Build(base_dir_, input_files_, sort_by_inode_);
+    }();
+    auto is_changed = [&](const ScanManifest::Entry &item) {
+        return !snapshot || !snapshot->IsUnchanged(manifest.Name(item), item);
+    };
+    size_t total_files = manifest.RegularFileCount();
+    uint64_t total_bytes = manifest.TotalBytes();
+    if (snapshot) {
+        total_files = 0;
+        total_bytes = 0;
+        for (const auto &item: manifest.entries()) {
+            if (!S_ISREG(item.mode) || !is_changed(item)) continue;
+            ++total_files;
+            total_bytes += static_cast<uint64_t>(item.size);
+        }
+    }
+    // 硬链接在同一个压缩包内解析，增量打包时只在本次写出的条目之间去重
+    DuplicateLinks links;
+    if (deduplicate_ && SupportsHardlinks(format_)) {
+        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Dedup);
+        links = FindDuplicates(manifest, is_changed, total_files);
+        for (size_t i = 0; i < links.targets.size(); ++i) {
+            if (links.targets[i] == std::string::npos) continue;
+            total_bytes -= static_cast<uint64_t>(manifest.entries()[i].size);
+        }
+    }
+    if (stats_) stats_->SetTotalBytes(total_bytes);
     size_t current_index = 0;
-    for (const auto &file: input_files_) {
-        AddToArchive(file, [&](const std::string &path) {
+    std::unique_ptr<ChecksumManifest> checksums;
+    std::unique_ptr<ChecksumManifest::Digest> digest;
+    if (checksum_algorithm_ != ChecksumAlgorithm::None) {
+        checksums = std::make_unique<ChecksumManifest>(checksum_algorithm_);
+        digest = std::make_unique<ChecksumManifest::Digest>(*checksums);
+    }
+    // 墓碑写在本次增量的最前面，恢复时先删除再写出新条目
+    if (snapshot) {
+        std::string tombstones;
+        for (const auto &name: snapshot->RemovedFrom(manifest)) {
+            tombstones += name;
+            tombstones += '\0';
+        }
+        if (!tombstones.empty()) {
+            OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+            WriteGeneratedEntry(k_tombstone_entry_name, tombstones);
+        }
+    }
+    for (const auto &item: manifest.entries()) {
+        if (!is_changed(item)) continue;
+        AddToArchive(manifest, item, links, digest.get(), [&](const std::string &path) {
             if (listener_) listener_(path, ++current_index, total_files);
         });
     }
+    if (checksums && checksum_path_.empty()) {
+        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+        WriteGeneratedEntry(ChecksumManifest::FileName(checksums->algorithm()),
+                            checksums->Serialize());
+    }
+
+    {
+        // 关闭时会压缩并写出缓冲中剩余的数据
+        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Codec);
+        if (archive_write_close(archive_.get()) != ARCHIVE_OK) {
+            throw std::runtime_error(
+                    "Failed to close output archive: " +
+                    std::string(archive_error_string(archive_.get())));
+        }
+    }
+    // 覆盖写入的内容可能短于原有的结束标记与块填充
+    if (append_fd_ >= 0) {
+        auto end = lseek64(append_fd_, 0, SEEK_CUR);
+        if (end < 0 || ftruncate64(append_fd_, end) != 0) {
+            throw std::runtime_error("Failed to truncate updated archive: " + output_path_);
+        }
+    }
+    if (!snapshot_path_.empty()) IncrementalSnapshot::FromManifest(manifest).Save(snapshot_path_);
+    if (checksums && !checksum_path_.empty()) checksums->WriteTo(checksum_path_);
+    if (!stats_) return;
+    stats_->SetCompressedBytes(OutputBytes());
+    stats_->Finish();
 }
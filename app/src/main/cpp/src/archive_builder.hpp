@@ -5,6 +5,11 @@
 #include <filesystem>
 
 #include "archive_common.hpp"
+#include "checksum_manifest.hpp"
+#include "operation_stats.hpp"
+#include "scan_manifest.hpp"
+#include "stream_compressor.hpp"
+#include "utils/file_reader.hpp"
 
 class ArchiveBuilder {
 public:
@@ -21,6 +26,8 @@ public:
             int32_t compression_level = 0
     );
 
+    ~ArchiveBuilder();
+
     void Create();
 
     ArchiveBuilder &SetFormat(ArchiveFormat fmt) {
@@ -38,12 +45,79 @@ public:
         return *this;
     }
 
+    /**
+     * 启用可随机访问的压缩输出（仅对 Zstd/Xz 压缩的 tar/cpio 格式生效）
+     */
+    ArchiveBuilder &SetSeekable(bool seekable) {
+        seekable_ = seekable;
+        return *this;
+    }
+
+    /**
+     * 压缩线程数，0 表示按 CPU 核心数自动选择
+     * Gzip/Bzip2/Lz4 在多线程时输出由多个独立 member/stream/frame 拼接而成
+     */
+    ArchiveBuilder &SetThreads(int32_t threads) {
+        threads_ = threads;
+        return *this;
+    }
+
+    /**
+     * 同一目录下的文件按 inode 顺序写入，使读取源文件时的磁盘访问更连续
+     */
+    ArchiveBuilder &SetSortByInode(bool sort_by_inode) {
+        sort_by_inode_ = sort_by_inode;
+        return *this;
+    }
+
+    /**
+     * 设置字节级统计对象（不持有，需在 Create 期间保持有效），为空时不统计
+     */
+    ArchiveBuilder &SetStats(OperationStats *stats) {
+        stats_ = stats;
+        return *this;
+    }
+
+    /**
+     * 打包时同步计算每个常规文件的校验和并生成清单，数据取自写入压缩包的缓冲区，不额外读取
+     * @param sidecar_path 为空时清单作为最后一个条目（ChecksumManifest::FileName）写入压缩包，否则写到该文件
+     */
+    ArchiveBuilder &SetChecksumManifest(ChecksumAlgorithm algorithm, std::string sidecar_path = {}) {
+        checksum_algorithm_ = algorithm;
+        checksum_path_ = std::move(sidecar_path);
+        return *this;
+    }
+
+    /**
+     * 增量打包：与快照文件记录的上一次打包结果比较，只写出新增或变化的条目，
+     * 已删除的条目写入墓碑条目（k_tombstone_entry_name），成功后更新快照
+     * 快照不存在时写出全部条目；输出文件已存在时只有未压缩的 tar 可以原地追加，
+     * 其它格式需要为每次增量指定新的输出路径，由 ArchiveExtractor::ExtractChain 依次恢复
+     */
+    ArchiveBuilder &SetIncremental(std::string snapshot_path) {
+        snapshot_path_ = std::move(snapshot_path);
+        return *this;
+    }
+
+    /**
+     * 内容去重（仅对 tar/cpio 格式生效）：大小相同的常规文件经哈希确认内容一致后，
+     * 只写出第一个，其余写为指向它的硬链接条目；硬链接条目没有数据，不计入校验和清单
+     */
+    ArchiveBuilder &SetDeduplicate(bool deduplicate) {
+        deduplicate_ = deduplicate;
+        return *this;
+    }
+
     ArchiveBuilder &SetListener(ProgressListener l) {
         listener_ = std::move(l);
         return *this;
     }
 
 private:
+    // 需在 archive_ 之前声明：archive_ 析构时的 close 回调仍会访问压缩流
+    std::unique_ptr<StreamCompressor> compressor_;
+    // 原地追加时打开的输出文件，析构时在 archive_ 之后关闭
+    int append_fd_ = -1;
     std::unique_ptr<struct archive, ArchiveDeleter> archive_;
     std::string output_path_;
     std::string base_dir_;
@@ -52,18 +126,81 @@ private:
     ArchiveFormat format_;
     CompressionType compression_;
     int32_t compression_level_;
+    bool seekable_ = false;
+    int32_t threads_ = 1;
+    bool sort_by_inode_ = false;
+    OperationStats *stats_ = nullptr;
+    ChecksumAlgorithm checksum_algorithm_ = ChecksumAlgorithm::None;
+    std::string checksum_path_;
+    std::string snapshot_path_;
+    bool deduplicate_ = false;
+    // 读取源文件，缓冲区在文件之间复用
+    FileReader file_reader_;
+
+    /**
+     * 去重结果，与清单条目一一对应
+     */
+    struct DuplicateLinks {
+        // 内容相同的首个条目的下标，不是副本时为 npos
+        std::vector<size_t> targets;
+        // 首个条目与其副本的总数，写入 header 的 nlink（cpio 依此还原硬链接）
+        std::vector<uint32_t> counts;
+    };
 
     int32_t ConfigureZipOptions(CompressionType compression, int32_t compression_level);
 
-    int32_t AddFilterAndSetLevel(CompressionType compression, int32_t compression_level);
+    int32_t AddFilterAndSetLevel(
+            CompressionType compression,
+            int32_t compression_level,
+            int32_t threads
+    );
 
     void SetArchiveFormat(ArchiveFormat format);
 
-    void WriteHeaderOrThrow(struct archive_entry *entry, const std::filesystem::path &path);
+    void OpenOutputOrThrow();
+
+    /**
+     * 打开已存在的未压缩 tar 并定位到结束标记处，之后的输出从这里覆盖写入
+     * @throw std::runtime_error 格式不支持原地追加或不是有效的 tar
+     */
+    void OpenAppendOrThrow();
+
+    void EndEntry(const std::filesystem::path &path);
 
-    void WriteFileToArchive(const std::filesystem::path &path);
+    static la_ssize_t
+    OnCompressorWrite(struct archive *a, void *client_data, const void *buffer, size_t length);
+
+    static int OnCompressorClose(struct archive *a, void *client_data);
+
+    void WriteHeaderOrThrow(struct archive_entry *entry, const std::filesystem::path &path);
 
-    void AddToArchive(const std::filesystem::path &path,
+    /**
+     * @param digest 不为空时同时计算实际写入的数据的校验和
+     */
+    void WriteFileToArchive(const std::filesystem::path &path, ChecksumManifest::Digest *digest);
+
+    /**
+     * 写入由内存数据生成的常规文件条目（校验和清单、墓碑）
+     */
+    void WriteGeneratedEntry(const std::string &name, const std::string &content);
+
+    /**
+     * 当前已写出的压缩包字节数
+     */
+    [[nodiscard]] uint64_t OutputBytes() const;
+
+    /**
+     * 按大小分组查找内容相同的常规文件，同组中 dev/ino 相同（源文件本身即为硬链接）的不重复哈希
+     * @param is_candidate 只在通过筛选的条目（如增量打包中变化的条目）之间去重
+     */
+    DuplicateLinks FindDuplicates(
+            const ScanManifest &manifest,
+            const std::function<bool(const ScanManifest::Entry &)> &is_candidate,
+            size_t total_files
+    ) const;
+
+    void AddToArchive(const ScanManifest &manifest, const ScanManifest::Entry &item,
+                      const DuplicateLinks &links, ChecksumManifest::Digest *digest,
                       const std::function<void(const std::string &path)> &on_progress);
 };
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #include <archive.h>
 #include <archive_entry.h>
 
@@ -17,6 +19,19 @@ enum class CompressionType {
     None = 0, Gzip = 1, Bzip2 = 2, Xz = 3, Lz4 = 4, Zstd = 5
 };
 
+/**
+ * 增量打包写入的墓碑条目名，内容为自上一次打包以来被删除的条目名称（每个以 '\0' 结尾）
+ * 恢复链解压时该条目不会写出，而是删除其中列出的路径
+ */
+constexpr const char *k_tombstone_entry_name = ".archandler-tombstones";
+
+/**
+ * 墓碑条目只在恢复归档链时使用，列出、解压与测试时都不作为普通条目出现
+ */
+inline bool IsTombstoneEntry(std::string_view pathname) {
+    return pathname == k_tombstone_entry_name;
+}
+
 struct ArchiveDeleter {
     void operator()(archive *a) const {
         if (a == nullptr) return;
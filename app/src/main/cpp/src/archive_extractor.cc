@@ -1,26 +1,110 @@
 // archive_extractor.cc
 #include "archive_extractor.hpp"
 #include "archive_common.hpp"
+#include "archive_index.hpp"
+#include "entry_writer.hpp"
+#include "parallel_decoder.hpp"
+#include "seekable_reader.hpp"
+#include "zip_central_directory.hpp"
+#include "utils/thread_pool.hpp"
 
 #include <archive.h>
 #include <archive_entry.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <filesystem>
+#include <functional>
 #include <string>
 #include <memory>
 #include <utility>
 #include <vector>
 #include <system_error>
+#include <unordered_set>
 
-constexpr size_t WRITE_BUFFER_SIZE = 8192;
 constexpr size_t READ_BLOCK_SIZE = 10240;
+// 流式列表每次回调的最大条目数与最长间隔
+constexpr size_t k_listing_chunk_entries = 4096;
+constexpr std::chrono::milliseconds k_listing_chunk_interval{50};
+// 并行处理 zip 时每个线程平均分到的区间数，区间越多负载越均衡，但每个区间之前的 header 都要重新跳过
+constexpr size_t k_zip_ranges_per_thread = 4;
+// 划分区间时每个条目额外计入的权重，近似 header 读取与定位的开销
+constexpr uint64_t k_zip_entry_overhead = 4096;
+// 并行处理时调用线程汇报进度的间隔
+constexpr std::chrono::milliseconds k_parallel_progress_interval{50};
 
 ArchiveExtractor::ArchiveExtractor(
         std::string archive_path
 ) : archive_path_(std::move(archive_path)) {};
 
-size_t ArchiveExtractor::CountFilesInArchive() const {
+namespace {
+    /**
+     * 条目路径，优先使用UTF-8形式
+     */
+    const char *EntryPathname(struct archive_entry *entry) {
+        auto pathname = archive_entry_pathname_utf8(entry);
+        if (pathname == nullptr) pathname = archive_entry_pathname(entry);
+        return pathname ? pathname : "";
+    }
+
+    /**
+     * 已消耗的压缩字节数
+     * 使用并行解压时 reader 读到的是解压后的数据，压缩字节数由解码器提供
+     */
+    int64_t ConsumedCompressedBytes(archive *reader, const ParallelDecoder *decoder) {
+        return decoder ? decoder->ConsumedBytes() : archive_filter_bytes(reader, -1);
+    }
+
+    /**
+     * 读取数据块后更新统计
+     */
+    struct ReadStats {
+        OperationStats *stats = nullptr;
+        const ParallelDecoder *decoder = nullptr;
+        // 随机访问帧时 reader 的字节数不是压缩字节，不做同步
+        bool track_compressed = true;
+
+        void OnBlock(archive *reader, size_t bytes) const {
+            if (!stats) return;
+            stats->AddBytesRead(bytes);
+            if (track_compressed) {
+                stats->SetCompressedBytes(
+                        static_cast<uint64_t>(ConsumedCompressedBytes(reader, decoder)));
+            }
+        }
+    };
+
+    /**
+     * 读取下一个 header，计入解压耗时
+     */
+    int ReadNextHeader(archive *reader, struct archive_entry **entry, OperationStats *stats) {
+        OperationStats::ScopedPhase phase(stats, OperationStats::Phase::Codec);
+        return archive_read_next_header(reader, entry);
+    }
+}
+
+bool ArchiveExtractor::HardlinkTracker::Defer(struct archive_entry *entry, int64_t position) {
+    auto hardlink = archive_entry_hardlink(entry);
+    if (!hardlink || written.count(hardlink)) return false;
+    auto &links = deferred.try_emplace(hardlink, Links{position, {}}).first->second;
+    links.pathnames.emplace_back(EntryPathname(entry));
+    return true;
+}
+
+size_t ArchiveExtractor::CountFilesInArchive(const EntrySelector *selector) const {
+    if (auto directory = ZipCentralDirectory::Open(archive_path_)) {
+        size_t count = 0;
+        for (const auto &entry: directory->entries()) {
+            if (entry.mode != AE_IFREG || IsTombstoneEntry(entry.pathname)) continue;
+            if (selector && !selector->Matches(entry.pathname)) continue;
+            ++count;
+        }
+        return count;
+    }
     auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
     size_t count = 0;
     struct archive_entry *entry = nullptr;
@@ -32,12 +116,74 @@ size_t ArchiveExtractor::CountFilesInArchive() const {
             throw std::runtime_error(std::string("Error while counting archive entries: ") +
                                      (err ? err : "unknown"));
         }
-        // 只计算常规文件数量
-        if (archive_entry_filetype(entry) == AE_IFREG) ++count;
+        // 只计算（被选中的）常规文件数量
+        if (archive_entry_filetype(entry) != AE_IFREG || IsTombstoneEntry(EntryPathname(entry))) {
+            continue;
+        }
+        if (selector && !selector->Matches(EntryPathname(entry))) continue;
+        ++count;
+    }
+    return count;
+}
+
+size_t ArchiveExtractor::ResolveTotalFiles(const EntrySelector *selector) const {
+    // 存在有效索引时直接使用索引中的文件数
+    if (auto index = ArchiveIndex::Open(index_dir_, archive_path_)) {
+        if (!selector) return index->CountRegularFiles();
+        size_t count = 0;
+        for (size_t i = 0; i < index->size(); ++i) {
+            auto view = index->At(i);
+            if (view.mode == AE_IFREG && selector->Matches(view.pathname)) ++count;
+        }
+        return count;
+    }
+    // 单遍模式不预扫描，总数在处理过程中推算；选择性解压没有索引时同样未知，
+    // 精确路径可能是目录，其下的文件数无法由路径数量得出
+    if (progress_mode_ == ProgressMode::CompressedBytes) return 0;
+    return CountFilesInArchive(selector);
+}
+
+std::optional<size_t> ArchiveExtractor::CountSelectedInIndex(const EntrySelector &selector) const {
+    auto index = ArchiveIndex::Open(index_dir_, archive_path_);
+    if (!index) return std::nullopt;
+    size_t count = 0;
+    for (size_t i = 0; i < index->size(); ++i) {
+        auto pathname = index->At(i).pathname;
+        if (!IsTombstoneEntry(pathname) && selector.Matches(pathname)) ++count;
     }
     return count;
 }
 
+size_t ArchiveExtractor::EstimateTotalFiles(
+        archive *reader,
+        const ParallelDecoder *decoder,
+        size_t current_index
+) const {
+    auto consumed = ConsumedCompressedBytes(reader, decoder);
+    if (archive_size_ <= 0 || consumed <= 0) return current_index;
+    // 使 current_index / total 与 consumed / archive_size_ 的比例保持一致
+    auto estimated = static_cast<double>(current_index) * static_cast<double>(archive_size_) /
+                     static_cast<double>(consumed);
+    return std::max(static_cast<size_t>(estimated), current_index);
+}
+
+std::unique_ptr<archive, ArchiveReadDeleter>
+ArchiveExtractor::OpenReader(std::unique_ptr<ParallelDecoder> &decoder) const {
+    std::error_code ec;
+    auto archive_size = std::filesystem::file_size(archive_path_, ec);
+    archive_size_ = ec ? 0 : static_cast<int64_t>(archive_size);
+    if (threads_ != 1) decoder = ParallelDecoder::Open(archive_path_, threads_);
+    return decoder ? decoder->OpenArchive() : CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
+}
+
+void ArchiveExtractor::BeginStats() const {
+    if (!stats_) return;
+    std::error_code ec;
+    auto archive_size = std::filesystem::file_size(archive_path_, ec);
+    stats_->Begin(ec ? 0 : static_cast<uint64_t>(archive_size),
+                  OperationStats::Basis::CompressedBytes);
+}
+
 // Extract Helpers
 namespace {
     /**
@@ -51,73 +197,251 @@ namespace {
     }
 
     /**
-     * 确保目标文件的父目录存在；失败不会抛出错误
+     * 从reader读取当前条目的数据块并交给writer
+     * 直接传递 libarchive 内部缓冲区与偏移，不做额外拷贝，稀疏条目的空洞得以保留
+     * @param digest 不为空时同时以同一数据块计算校验和
+     * @throw std::runtime_error 读取或者写入失败的时候抛出此错误
      */
-    void EnsureParentDirectories(const std::filesystem::path &dest) noexcept {
-        if (!dest.has_parent_path()) return;
-        std::error_code ec;
-        std::filesystem::create_directories(dest.parent_path(), ec);
+    void CopyEntryDataOrThrow(
+            archive *reader,
+            EntryWriter &writer,
+            const std::filesystem::path &dest,
+            const ReadStats &read_stats,
+            ChecksumManifest::Digest *digest
+    ) {
+        const void *block = nullptr;
+        size_t size = 0;
+        la_int64_t offset = 0;
+        while (true) {
+            int rc;
+            {
+                OperationStats::ScopedPhase phase(read_stats.stats, OperationStats::Phase::Codec);
+                rc = archive_read_data_block(reader, &block, &size, &offset);
+            }
+            if (rc == ARCHIVE_EOF) break;
+            if (rc < ARCHIVE_OK) {
+                auto err = archive_error_string(reader);
+                throw std::runtime_error(
+                        std::string("Error reading data from archive for ") + dest.string() + ": " +
+                        (err ? err : "unknown"));
+            }
+            read_stats.OnBlock(reader, size);
+            if (size == 0) continue;
+            if (digest) digest->Update(block, size, static_cast<uint64_t>(offset));
+            writer.WriteData(block, size, offset);
+        }
     }
 
     /**
-     * 写 header
-     * @throw std::runtime_error 包含 archive 的错误
+     * 将 reader 当前条目写出到 output_dir
+     * @param on_regular_file 常规文件写入数据前调用，用于报告进度
+     * @param digest 不为空时计算常规文件的校验和，以归档内路径记入清单
+     * @return 条目类型；目标路径无效时返回0且不写出
+     * @throw std::runtime_error 写入失败
      */
-    void WriteHeaderOrThrow(
-            archive *disk,
+    mode_t WriteCurrentEntryOrThrow(
+            archive *reader,
+            EntryWriter &writer,
             struct archive_entry *entry,
-            const std::filesystem::path &dest
+            const std::string &output_dir,
+            const ReadStats &read_stats,
+            const std::function<void(const std::filesystem::path &)> &on_regular_file,
+            ChecksumManifest::Digest *digest = nullptr
     ) {
-        if (archive_write_header(disk, entry) == ARCHIVE_OK) return;
-        auto err = archive_error_string(disk);
-        throw std::runtime_error(
-                std::string("Failed to write header for ") + dest.string() + ": " +
-                (err ? err : "unknown"));
+        // 解析目标路径
+        std::filesystem::path dest = ResolveDestinationPath(output_dir, entry);
+        if (dest.empty()) return 0;
+        // 硬链接条目没有数据，不计入清单
+        if (archive_entry_hardlink(entry)) digest = nullptr;
+        std::string pathname = digest ? EntryPathname(entry) : "";
+
+        // 将entry pathname替换为目标路径（写到output_dir）
+        archive_entry_set_pathname(entry, dest.string().c_str());
+        // 硬链接目标同样是归档内路径
+        if (auto hardlink = archive_entry_hardlink(entry)) {
+            auto target = (std::filesystem::path(output_dir) / std::string(hardlink)).string();
+            archive_entry_set_hardlink(entry, target.c_str());
+        }
+
+        // 写header（根据entry type创建目录、链接或准备写入文件）
+        writer.WriteHeader(entry, dest);
+
+        // 如果是常规文件则复制数据并报告进度
+        auto filetype = archive_entry_filetype(entry);
+        if (filetype == AE_IFREG) {
+            on_regular_file(dest);
+            CopyEntryDataOrThrow(reader, writer, dest, read_stats, digest);
+            if (digest) {
+                // 稀疏条目末尾的空洞不产生数据块
+                auto size = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : 0;
+                digest->Commit(std::move(pathname),
+                               static_cast<uint64_t>(std::max<la_int64_t>(0, size)));
+            }
+            if (read_stats.stats) read_stats.stats->AddFile();
+        }
+
+        writer.FinishEntry();
+        return filetype;
     }
 
     /**
-     * 从reader读取数据并写入disk
-     * @throw std::runtime_error 读取或者写入失败的时候抛出此错误
+     * 读取墓碑条目的数据并删除其中列出的路径及其在清单中的记录，拒绝绝对路径与包含 ".." 的路径
+     * @throw std::runtime_error 读取失败
      */
-    void CopyEntryDataOrThrow(
+    void RemoveTombstonedPaths(
             archive *reader,
-            archive *disk,
-            const std::filesystem::path &dest,
-            std::vector<char> &buffer
+            const std::string &output_dir,
+            ChecksumManifest *checksums
     ) {
+        std::string data;
+        char buffer[READ_BLOCK_SIZE];
         while (true) {
-            auto len = archive_read_data(reader, buffer.data(), buffer.size());
-            if (len == 0) break;
-            if (len < 0) {
+            auto n = archive_read_data(reader, buffer, sizeof(buffer));
+            if (n == 0) break;
+            if (n < 0) {
                 auto err = archive_error_string(reader);
-                throw std::runtime_error(
-                        std::string("Error reading data from archive for ") + dest.string() + ": " +
-                        (err ? err : "unknown"));
+                throw std::runtime_error(std::string("Error reading tombstones: ") +
+                                         (err ? err : "unknown"));
             }
-            auto wrote = archive_write_data(disk, buffer.data(), len);
-            if (wrote < 0) {
-                auto err = archive_error_string(disk);
-                throw std::runtime_error(
-                        std::string("Error writing data to disk for ") + dest.string() + ": " +
-                        (err ? err : "unknown"));
+            data.append(buffer, static_cast<size_t>(n));
+        }
+        for (size_t begin = 0; begin < data.size();) {
+            auto end = data.find('\0', begin);
+            if (end == std::string::npos) end = data.size();
+            std::filesystem::path path(data.substr(begin, end - begin));
+            begin = end + 1;
+            auto is_parent = [](const std::filesystem::path &part) { return part == ".."; };
+            if (path.empty() || path.is_absolute() ||
+                std::any_of(path.begin(), path.end(), is_parent)) {
+                continue;
             }
+            std::error_code ec;
+            std::filesystem::remove_all(std::filesystem::path(output_dir) / path, ec);
+            if (checksums) checksums->Remove(path.generic_string());
         }
     }
 
+    long ExtractDiskOptions(bool overwrite) {
+        long disk_options = ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_PERM | ARCHIVE_EXTRACT_ACL |
+                            ARCHIVE_EXTRACT_FFLAGS;
+        if (!overwrite) disk_options |= ARCHIVE_EXTRACT_NO_OVERWRITE;
+        return disk_options;
+    }
+
     /**
-     * 完成条目（finish entry）
-     * @throw std::runtime_error 调用archive_write_finish_entry失败时将抛出错误信息
+     * 将条目按权重切分为约 range_count 个连续区间 [begin, end)，每个条目另计固定的定位开销
+     * @param weight_of 条目数据部分的权重，无需处理数据的条目返回0
      */
-    void FinishEntryOrThrow(archive *disk, const std::filesystem::path &dest) {
-        if (archive_write_finish_entry(disk) == ARCHIVE_OK) return;
-        auto err = archive_error_string(disk);
-        throw std::runtime_error(std::string("Failed to finish entry ") + dest.string() + ": " +
-                                 (err ? err : "unknown"));
+    std::vector<std::pair<size_t, size_t>> SplitIntoRanges(
+            size_t entry_count,
+            size_t range_count,
+            const std::function<uint64_t(size_t)> &weight_of
+    ) {
+        uint64_t total_weight = 0;
+        for (size_t i = 0; i < entry_count; ++i) total_weight += k_zip_entry_overhead + weight_of(i);
+        std::vector<std::pair<size_t, size_t>> ranges;
+        uint64_t weight = 0;
+        size_t begin = 0;
+        for (size_t i = 0; i < entry_count; ++i) {
+            weight += k_zip_entry_overhead + weight_of(i);
+            if (weight * range_count >= total_weight * (ranges.size() + 1) || i + 1 == entry_count) {
+                ranges.emplace_back(begin, i + 1);
+                begin = i + 1;
+            }
+        }
+        return ranges;
+    }
+
+    /**
+     * 在线程池上运行 count 个 worker，调用线程每隔一段时间执行一次 on_poll（回调进度）
+     * worker 或 on_poll 抛出时置位 stopping，等待所有 worker 退出后重新抛出
+     */
+    void RunWorkers(
+            size_t count,
+            const std::function<void()> &worker,
+            std::atomic<bool> &stopping,
+            const std::function<void()> &on_poll
+    ) {
+        std::vector<std::future<void>> futures;
+        {
+            ThreadPool pool(count);
+            futures.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                futures.push_back(pool.Submit([&worker, &stopping]() {
+                    try {
+                        worker();
+                    } catch (...) {
+                        stopping.store(true, std::memory_order_relaxed);
+                        throw;
+                    }
+                }));
+            }
+            try {
+                for (auto &future: futures) {
+                    while (future.wait_for(k_parallel_progress_interval) !=
+                           std::future_status::ready) {
+                        if (on_poll) on_poll();
+                    }
+                }
+            } catch (...) {
+                stopping.store(true, std::memory_order_relaxed);
+                throw;
+            }
+        }
+        for (auto &future: futures) future.get();
+    }
+
+    /**
+     * 将已完整得到的条目列表按批回调
+     */
+    void EmitInChunks(
+            const std::vector<ArchiveExtractor::ArchiveEntry> &entries,
+            const ArchiveExtractor::EntryChunkListener &on_chunk
+    ) {
+        for (size_t i = 0; i < entries.size(); i += k_listing_chunk_entries) {
+            on_chunk(entries.data() + i, std::min(k_listing_chunk_entries, entries.size() - i));
+        }
     }
 }
 
 std::vector<ArchiveExtractor::ArchiveEntry> ArchiveExtractor::ListEntry() const {
+    return ListEntry(nullptr);
+}
+
+std::vector<ArchiveExtractor::ArchiveEntry>
+ArchiveExtractor::ListEntry(const EntryChunkListener &on_chunk) const {
+    if (auto index = ArchiveIndex::Open(index_dir_, archive_path_)) {
+        auto entries = index->ToEntries();
+        if (on_chunk) EmitInChunks(entries, on_chunk);
+        return entries;
+    }
+    auto entries = ReadEntries(on_chunk);
+    if (!index_dir_.empty()) ArchiveIndex::Write(index_dir_, archive_path_, entries);
+    return entries;
+}
+
+std::vector<ArchiveExtractor::ArchiveEntry>
+ArchiveExtractor::ReadEntries(const EntryChunkListener &on_chunk) const {
+    // zip 直接读取中央目录，无需逐个访问本地文件头
+    if (auto directory = ZipCentralDirectory::Open(archive_path_)) {
+        auto entries = std::move(directory->entries());
+        auto is_tombstone = [](const ArchiveEntry &entry) {
+            return IsTombstoneEntry(entry.pathname);
+        };
+        entries.erase(std::remove_if(entries.begin(), entries.end(), is_tombstone), entries.end());
+        if (on_chunk) EmitInChunks(entries, on_chunk);
+        return entries;
+    }
+
     std::vector<ArchiveEntry> entityList;
+    // 尚未回调的第一个条目下标
+    size_t emitted = 0;
+    auto last_emit = std::chrono::steady_clock::now();
+    auto emit = [&]() {
+        on_chunk(entityList.data() + emitted, entityList.size() - emitted);
+        emitted = entityList.size();
+        last_emit = std::chrono::steady_clock::now();
+    };
     auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
     struct archive_entry *entry = nullptr;
     while (true) {
@@ -128,16 +452,26 @@ std::vector<ArchiveExtractor::ArchiveEntry> ArchiveExtractor::ListEntry() const
             throw std::runtime_error(std::string("Error while listing archive entries: ") +
                                      (err ? err : "unknown"));
         }
-        auto pathname = archive_entry_pathname_utf8(entry);
-        if (pathname == nullptr) pathname = archive_entry_pathname(entry);
+        auto pathname = EntryPathname(entry);
+        if (IsTombstoneEntry(pathname)) continue;
         entityList.emplace_back(ArchiveEntry{
                 .pathname = pathname,
                 .mode = archive_entry_filetype(entry),
                 .modify_time_ms = (int64_t) archive_entry_mtime(entry) * 1000 +
                                   archive_entry_mtime_nsec(entry) / 1000000,
-                .entry_size = archive_entry_size(entry)
+                .entry_size = archive_entry_size(entry),
+                .compressed_offset = archive_filter_bytes(reader.get(), -1),
+                .uncompressed_offset = archive_read_header_position(reader.get())
         });
+        if (!on_chunk) continue;
+        auto pending = entityList.size() - emitted;
+        // 第一个条目立即回调，使界面尽快显示内容
+        if (emitted == 0 || pending >= k_listing_chunk_entries ||
+            std::chrono::steady_clock::now() - last_emit >= k_listing_chunk_interval) {
+            emit();
+        }
     }
+    if (on_chunk && emitted < entityList.size()) emit();
     return entityList;
 }
 
@@ -146,22 +480,106 @@ void ArchiveExtractor::Extract(
         const ProgressListener &listener,
         bool overwrite
 ) const {
-    // 统计total_files（可能抛出）
-    size_t total_files = CountFilesInArchive();
+    auto checksums = CreateChecksumManifest();
+    ExtractSelected(output_dir, nullptr, listener, overwrite, checksums.get());
+    if (checksums) checksums->WriteTo(checksum_path_);
+}
 
-    // 打开reader与disk
-    auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
-    long disk_options = ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_PERM | ARCHIVE_EXTRACT_ACL |
-                        ARCHIVE_EXTRACT_FFLAGS;
-    if (!overwrite) disk_options |= ARCHIVE_EXTRACT_NO_OVERWRITE;
-    auto disk = CreateArchiveWriteDisk(disk_options);
+void ArchiveExtractor::ExtractEntries(
+        const std::string &output_dir,
+        const EntrySelector &selector,
+        const ProgressListener &listener,
+        bool overwrite
+) const {
+    auto checksums = CreateChecksumManifest();
+    ExtractSelected(output_dir, &selector, listener, overwrite, checksums.get());
+    if (checksums) checksums->WriteTo(checksum_path_);
+}
+
+void ArchiveExtractor::ExtractChain(
+        const std::vector<std::string> &delta_paths,
+        const std::string &output_dir,
+        const ProgressListener &listener
+) const {
+    // 整条链共用一份清单：后面的归档覆盖同名条目，墓碑移除已删除的条目，最后只写出一次
+    auto checksums = CreateChecksumManifest();
+    auto extractor = *this;
+    extractor.apply_tombstones_ = true;
+    extractor.ExtractSelected(output_dir, nullptr, listener, true, checksums.get());
+    for (const auto &delta_path: delta_paths) {
+        extractor.archive_path_ = delta_path;
+        extractor.ExtractSelected(output_dir, nullptr, listener, true, checksums.get());
+    }
+    if (checksums) checksums->WriteTo(checksum_path_);
+}
+
+std::unique_ptr<ChecksumManifest> ArchiveExtractor::CreateChecksumManifest() const {
+    if (checksum_algorithm_ == ChecksumAlgorithm::None || checksum_path_.empty()) return nullptr;
+    return std::make_unique<ChecksumManifest>(checksum_algorithm_);
+}
 
+void ArchiveExtractor::ExtractSelected(
+        const std::string &output_dir,
+        const EntrySelector *selector,
+        const ProgressListener &listener,
+        bool overwrite,
+        ChecksumManifest *checksums
+) const {
+    // 精确路径选择且存在带偏移的索引时，尝试只解压目标条目所在的帧
+    if (selector && selector->ExactPathCount() > 0 && !apply_tombstones_) {
+        auto index = ArchiveIndex::Open(index_dir_, archive_path_);
+        auto stream = index ? SeekableStream::Open(archive_path_) : nullptr;
+        if (stream && ExtractSeekable(output_dir, *selector, *index, *stream, listener,
+                                      overwrite, checksums)) {
+            return;
+        }
+    }
+
+    // 并行解压中途回退时清单中已有部分条目，顺序解压重新记录的同名条目会取代它们
+    if (!apply_tombstones_ &&
+        ExtractParallel(output_dir, selector, listener, overwrite, checksums)) {
+        return;
+    }
+
+    BeginStats();
+    // 统计total_files（可能抛出），单遍模式下为0
+    size_t total_files = ResolveTotalFiles(selector);
+
+    // 打开reader与writer（decoder 需比 reader 存活更久）
+    std::unique_ptr<ParallelDecoder> decoder;
+    auto reader = OpenReader(decoder);
+    // 流水线模式下由独立线程写盘，当前线程只负责解压与回调进度
+    // 处理墓碑时删除需在此前的条目写出之后进行，只能同步写盘
+    auto disk_options = ExtractDiskOptions(overwrite);
+    auto writer = pipelined_ && !apply_tombstones_
+                  ? CreatePipelinedEntryWriter(disk_options, pipeline_listener_, stats_)
+                  : CreateDirectEntryWriter(disk_options, stats_);
+    auto small_file_writers = apply_tombstones_ ? 1 : ResolveThreadCount(small_file_writers_);
+    if (small_file_writers > 1) {
+        writer = CreatePooledEntryWriter(std::move(writer), disk_options, small_file_writers,
+                                         small_file_threshold_, stats_);
+    }
+    ReadStats read_stats{stats_, decoder.get()};
+    std::unique_ptr<ChecksumManifest::Digest> digest;
+    if (checksums) digest = std::make_unique<ChecksumManifest::Digest>(*checksums);
+
+    // 有索引时可得知被选中的条目（含追加写入的同名成员）共有多少个，全部写出后提前结束；
+    // 没有索引时后面可能还有同名条目的新版本，需读到结尾，使最后一个版本覆盖之前的版本
+    auto selected_in_index = selector ? CountSelectedInIndex(*selector) : std::nullopt;
+    bool stop_early = selected_in_index.has_value();
+    size_t remaining_selected = selected_in_index.value_or(0);
+    if (stop_early && remaining_selected == 0) {
+        writer->Close();
+        if (stats_) stats_->Finish();
+        return;
+    }
+
+    HardlinkTracker links;
     struct archive_entry *entry = nullptr;
-    std::vector<char> buffer(WRITE_BUFFER_SIZE);
 
     size_t current_index = 0;
     while (true) {
-        int rc = archive_read_next_header(reader.get(), &entry);
+        int rc = ReadNextHeader(reader.get(), &entry, stats_);
         if (rc == ARCHIVE_EOF) break;
         if (rc < ARCHIVE_OK) {
             auto err = archive_error_string(reader.get());
@@ -169,42 +587,212 @@ void ArchiveExtractor::Extract(
                     std::string("Failed to read next header: ") + (err ? err : "unknown"));
         }
 
-        // 解析目标路径并准备目录
-        std::filesystem::path dest = ResolveDestinationPath(output_dir, entry);
-        if (dest.empty()) continue;
-        EnsureParentDirectories(dest);
+        if (IsTombstoneEntry(EntryPathname(entry))) {
+            if (apply_tombstones_) {
+                RemoveTombstonedPaths(reader.get(), output_dir, checksums);
+            } else {
+                archive_read_data_skip(reader.get());
+            }
+            continue;
+        }
 
-        // 将entry pathname替换为目标路径（写到output_dir）
-        archive_entry_set_pathname(entry, dest.string().c_str());
+        // 未选中的条目直接跳过其数据
+        if (selector && !selector->Matches(EntryPathname(entry))) {
+            archive_read_data_skip(reader.get());
+            continue;
+        }
 
-        // 写header（根据entry type创建目录、链接或准备写入文件）
-        WriteHeaderOrThrow(disk.get(), entry, dest);
+        if (selector && links.Defer(entry, archive_read_header_position(reader.get()))) {
+            archive_read_data_skip(reader.get());
+        } else {
+            std::string pathname = selector ? EntryPathname(entry) : "";
+            auto filetype = WriteCurrentEntryOrThrow(
+                    reader.get(), *writer, entry, output_dir, read_stats,
+                    [&](const std::filesystem::path &dest) {
+                        ++current_index;
+                        if (!listener) return;
+                        auto total = total_files ? std::max(total_files, current_index)
+                                                 : EstimateTotalFiles(reader.get(), decoder.get(),
+                                                                      current_index);
+                        listener(dest.string(), current_index, total);
+                    }, digest.get());
+            if (selector && filetype == AE_IFREG) links.written.insert(std::move(pathname));
+        }
 
-        // 如果是常规文件则复制数据并报告进度
-        if (archive_entry_filetype(entry) == AE_IFREG) {
-            if (listener) listener(dest.string(), ++current_index, total_files);
-            CopyEntryDataOrThrow(reader.get(), disk.get(), dest, buffer);
+        // 索引中所有被选中的条目都已写出，无需继续解压后续数据
+        if (stop_early && --remaining_selected == 0) break;
+    }
+    writer->Close();
+    if (!links.deferred.empty()) ExtractDeferredLinks(output_dir, links, overwrite, checksums);
+    if (stats_) stats_->Finish();
+}
+
+bool ArchiveExtractor::ExtractSeekable(
+        const std::string &output_dir,
+        const EntrySelector &selector,
+        const ArchiveIndex &index,
+        const SeekableStream &stream,
+        const ProgressListener &listener,
+        bool overwrite,
+        ChecksumManifest *checksums
+) const {
+    // 按解压后流中的顺序收集目标条目的 header 偏移
+    std::vector<uint64_t> targets;
+    size_t total_files = 0;
+    uint64_t total_bytes = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        auto view = index.At(i);
+        if (!selector.Matches(view.pathname)) continue;
+        if (view.uncompressed_offset < 0) return false;
+        targets.push_back(static_cast<uint64_t>(view.uncompressed_offset));
+        if (view.mode != AE_IFREG) continue;
+        ++total_files;
+        total_bytes += static_cast<uint64_t>(std::max<int64_t>(0, view.entry_size));
+    }
+    std::sort(targets.begin(), targets.end());
+
+    // 只解压部分帧，进度按目标条目的数据量计算
+    if (stats_) stats_->Begin(total_bytes, OperationStats::Basis::BytesRead);
+    ReadStats read_stats{stats_, nullptr, false};
+    auto writer = CreateDirectEntryWriter(ExtractDiskOptions(overwrite), stats_);
+    std::unique_ptr<ChecksumManifest::Digest> digest;
+    if (checksums) digest = std::make_unique<ChecksumManifest::Digest>(*checksums);
+    std::unique_ptr<archive, ArchiveReadDeleter> reader;
+    // reader 起始位置对应的未压缩偏移，以及最近一个 header 所在的帧
+    uint64_t reader_base = 0;
+    size_t reader_frame = 0;
+
+    HardlinkTracker links;
+    struct archive_entry *entry = nullptr;
+    size_t current_index = 0;
+
+    for (auto target: targets) {
+        auto frame = stream.FrameOf(target);
+        // 目标与当前位置相距超过一帧时重新定位，否则顺序跳过中间条目
+        if (!reader || target < reader_base || frame > reader_frame + 1) {
+            reader = stream.OpenArchiveAt(target);
+            reader_base = target;
         }
+        while (true) {
+            int rc = ReadNextHeader(reader.get(), &entry, stats_);
+            if (rc == ARCHIVE_EOF) {
+                throw std::runtime_error("Indexed entry not found, the index may be stale");
+            }
+            if (rc < ARCHIVE_OK) {
+                auto err = archive_error_string(reader.get());
+                throw std::runtime_error(
+                        std::string("Failed to read next header: ") + (err ? err : "unknown"));
+            }
+            auto position = reader_base + archive_read_header_position(reader.get());
+            reader_frame = stream.FrameOf(position);
+            if (position == target) break;
+            if (position > target) {
+                throw std::runtime_error("Indexed entry offset mismatch, the index may be stale");
+            }
+            archive_read_data_skip(reader.get());
+        }
+
+        if (links.Defer(entry, static_cast<int64_t>(target))) continue;
+        std::string pathname = EntryPathname(entry);
+        auto filetype = WriteCurrentEntryOrThrow(
+                reader.get(), *writer, entry, output_dir, read_stats,
+                [&](const std::filesystem::path &dest) {
+                    ++current_index;
+                    if (listener) listener(dest.string(), current_index, total_files);
+                }, digest.get());
+        if (filetype == AE_IFREG) links.written.insert(std::move(pathname));
+    }
+    writer->Close();
+    if (!links.deferred.empty()) ExtractDeferredLinks(output_dir, links, overwrite, checksums);
+    if (stats_) stats_->Finish();
+    return true;
+}
+
+void ArchiveExtractor::ExtractDeferredLinks(
+        const std::string &output_dir,
+        const HardlinkTracker &tracker,
+        bool overwrite,
+        ChecksumManifest *checksums
+) const {
+    int64_t end = 0;
+    for (const auto &[target, links]: tracker.deferred) end = std::max(end, links.before);
+
+    std::unique_ptr<ParallelDecoder> decoder;
+    auto reader = OpenReader(decoder);
+    auto writer = CreateDirectEntryWriter(ExtractDiskOptions(overwrite), stats_);
+    // 归档数据已在第一遍计入进度，这里不再重复统计读取的字节与文件数
+    ReadStats read_stats{nullptr, decoder.get()};
+    std::unique_ptr<ChecksumManifest::Digest> digest;
+    if (checksums) digest = std::make_unique<ChecksumManifest::Digest>(*checksums);
+    std::unordered_set<std::string> found;
+
+    struct archive_entry *entry = nullptr;
+    while (true) {
+        int rc = ReadNextHeader(reader.get(), &entry, stats_);
+        if (rc == ARCHIVE_EOF) break;
+        if (rc < ARCHIVE_OK) {
+            auto err = archive_error_string(reader.get());
+            throw std::runtime_error(
+                    std::string("Failed to read next header: ") + (err ? err : "unknown"));
+        }
+        auto position = archive_read_header_position(reader.get());
+        if (position >= end) break;
+        auto it = tracker.deferred.find(EntryPathname(entry));
+        if (it == tracker.deferred.end() || position >= it->second.before) {
+            archive_read_data_skip(reader.get());
+            continue;
+        }
+        // 同名目标出现多次时后面的版本覆盖前面的版本
+        found.insert(it->first);
+        archive_entry_set_pathname(entry, it->second.pathnames.front().c_str());
+        WriteCurrentEntryOrThrow(reader.get(), *writer, entry, output_dir, read_stats,
+                                 [](const std::filesystem::path &) {}, digest.get());
+    }
 
-        FinishEntryOrThrow(disk.get(), dest);
+    for (const auto &[target, links]: tracker.deferred) {
+        if (!found.count(target)) {
+            throw std::runtime_error("Hard-link target not found in archive: " + target);
+        }
+        auto first = std::filesystem::path(output_dir) / links.pathnames.front();
+        for (size_t i = 1; i < links.pathnames.size(); ++i) {
+            auto dest = std::filesystem::path(output_dir) / links.pathnames[i];
+            std::unique_ptr<archive_entry, ArchiveEntryDeleter> link(archive_entry_new());
+            archive_entry_set_pathname(link.get(), dest.string().c_str());
+            archive_entry_set_filetype(link.get(), AE_IFREG);
+            archive_entry_set_perm(link.get(), 0644);
+            archive_entry_set_hardlink(link.get(), first.string().c_str());
+            writer->WriteHeader(link.get(), dest);
+            writer->FinishEntry();
+        }
+        if (stats_) {
+            for (size_t i = 0; i < links.pathnames.size(); ++i) stats_->AddFile();
+        }
     }
+    writer->Close();
 }
 
 ArchiveExtractor::TestResult ArchiveExtractor::Test(const ProgressListener& listener) const {
     try {
-        // 统计total_files（可能抛出）
-        size_t total_files = CountFilesInArchive();
+        BeginStats();
+        if (auto result = TestParallel(listener)) return *result;
 
-        // 打开reader
-        auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
+        // 统计total_files（可能抛出），单遍模式下为0
+        size_t total_files = ResolveTotalFiles();
+
+        // 打开reader（decoder 需比 reader 存活更久）
+        std::unique_ptr<ParallelDecoder> decoder;
+        auto reader = OpenReader(decoder);
+        ReadStats read_stats{stats_, decoder.get()};
 
         struct archive_entry *entry = nullptr;
-        std::vector<char> buffer(READ_BLOCK_SIZE);
+        const void *block = nullptr;
+        size_t block_size = 0;
+        la_int64_t block_offset = 0;
         size_t tested_files = 0;
         size_t current_index = 0;
 
         while (true) {
-            int rc = archive_read_next_header(reader.get(), &entry);
+            int rc = ReadNextHeader(reader.get(), &entry, stats_);
             if (rc == ARCHIVE_EOF) {
                 break;
             }
@@ -219,41 +807,55 @@ ArchiveExtractor::TestResult ArchiveExtractor::Test(const ProgressListener& list
                 };
             }
 
-            // 如果是常规文件，读取并验证所有数据
-            if (archive_entry_filetype(entry) == AE_IFREG) {
+            // 如果是常规文件（墓碑条目除外），读取并验证所有数据
+            if (archive_entry_filetype(entry) == AE_IFREG &&
+                !IsTombstoneEntry(EntryPathname(entry))) {
+                ++current_index;
                 if (listener) {
                     auto pathname = archive_entry_pathname_utf8(entry);
                     if (pathname == nullptr) pathname = archive_entry_pathname(entry);
-                    listener(std::string(pathname), ++current_index, total_files);
+                    auto total = total_files ? total_files
+                                             : EstimateTotalFiles(reader.get(), decoder.get(),
+                                                                  current_index);
+                    listener(std::string(pathname), current_index, total);
                 }
 
-                // 读取并丢弃所有数据以验证完整性
+                // 读取并丢弃所有数据以验证完整性（直接访问内部缓冲区，无需拷贝）
                 while (true) {
-                    auto len = archive_read_data(reader.get(), buffer.data(), buffer.size());
-                    if (len == 0) {
+                    int rc;
+                    {
+                        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Codec);
+                        rc = archive_read_data_block(reader.get(), &block, &block_size,
+                                                     &block_offset);
+                    }
+                    if (rc == ARCHIVE_EOF) {
                         // 数据读取完成
                         break;
                     }
-                    if (len < 0) {
+                    if (rc < ARCHIVE_OK) {
                         auto err = archive_error_string(reader.get());
                         return TestResult{
                             .success = false,
                             .error_message = std::string("Data integrity check failed: ") +
+                                             EntryPathname(entry) + ": " +
                                              (err ? err : "unknown"),
                             .tested_files = tested_files,
                             .total_files = total_files
                         };
                     }
+                    read_stats.OnBlock(reader.get(), block_size);
                 }
                 ++tested_files;
+                if (stats_) stats_->AddFile();
             }
         }
 
+        if (stats_) stats_->Finish();
         return TestResult{
             .success = true,
             .error_message = "",
             .tested_files = tested_files,
-            .total_files = total_files
+            .total_files = total_files ? total_files : tested_files
         };
     } catch (const std::exception& exception) {
         return TestResult{
@@ -263,4 +865,321 @@ ArchiveExtractor::TestResult ArchiveExtractor::Test(const ProgressListener& list
             .total_files = 0
         };
     }
-}
\ No newline at end of file
+}
+
+std::optional<ArchiveExtractor::TestResult>
+ArchiveExtractor::TestParallel(const ProgressListener &listener) const {
+    auto threads = static_cast<size_t>(ResolveThreadCount(threads_));
+    if (threads <= 1) return std::nullopt;
+    auto directory = ZipCentralDirectory::Open(archive_path_);
+    if (!directory) return std::nullopt;
+    const auto &entries = directory->entries();
+
+    // 墓碑条目不计入也不测试
+    auto is_tested = [&](size_t i) {
+        return entries[i].mode == AE_IFREG && !IsTombstoneEntry(entries[i].pathname);
+    };
+    size_t total_files = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (is_tested(i)) ++total_files;
+    }
+    if (total_files < 2) return std::nullopt;
+    threads = std::min(threads, total_files);
+
+    // 按压缩字节把条目（按 libarchive 的读取顺序）切分为连续区间
+    auto ranges = SplitIntoRanges(
+            entries.size(), threads * k_zip_ranges_per_thread, [&](size_t i) -> uint64_t {
+                if (!is_tested(i)) return 0;
+                return static_cast<uint64_t>(std::max<int64_t>(0, entries[i].compressed_size));
+            });
+
+    std::atomic<size_t> next_range{0};
+    std::atomic<size_t> tested_files{0};
+    std::atomic<uint64_t> tested_compressed{0};
+    std::atomic<bool> stopping{false};
+    // reader 读到的条目与中央目录顺序不一致时放弃并行，改为顺序测试
+    std::atomic<bool> mismatched{false};
+    std::mutex mutex;
+    std::string current_path;
+    // 失败时保留读取顺序上最靠前的条目
+    size_t failed_index = entries.size();
+    std::string error_message;
+
+    auto fail = [&](size_t index, std::string message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index < failed_index) {
+            failed_index = index;
+            error_message = std::move(message);
+        }
+        stopping.store(true, std::memory_order_relaxed);
+    };
+
+    auto worker = [&]() {
+        auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
+        ReadStats read_stats{stats_, nullptr, false};
+        struct archive_entry *entry = nullptr;
+        const void *block = nullptr;
+        size_t block_size = 0;
+        la_int64_t block_offset = 0;
+        // 下一个要读取的 header 序号；区间按顺序认领，同一 reader 只需向后跳过
+        size_t position = 0;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            auto range = next_range.fetch_add(1, std::memory_order_relaxed);
+            if (range >= ranges.size()) return;
+            auto [begin, end] = ranges[range];
+            for (; position < end; ++position) {
+                if (stopping.load(std::memory_order_relaxed)) return;
+                int rc = ReadNextHeader(reader.get(), &entry, stats_);
+                if (rc == ARCHIVE_EOF || rc < ARCHIVE_OK) {
+                    auto err = rc == ARCHIVE_EOF ? "unexpected end of archive"
+                                                 : archive_error_string(reader.get());
+                    fail(position, std::string("Failed to read header: ") +
+                                   entries[position].pathname + ": " + (err ? err : "unknown"));
+                    return;
+                }
+                if (entries[position].pathname != EntryPathname(entry)) {
+                    mismatched.store(true, std::memory_order_relaxed);
+                    stopping.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                if (position < begin || !is_tested(position)) continue;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    current_path = EntryPathname(entry);
+                }
+
+                while (true) {
+                    if (stopping.load(std::memory_order_relaxed)) return;
+                    {
+                        OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Codec);
+                        rc = archive_read_data_block(reader.get(), &block, &block_size,
+                                                     &block_offset);
+                    }
+                    if (rc == ARCHIVE_EOF) break;
+                    if (rc < ARCHIVE_OK) {
+                        auto err = archive_error_string(reader.get());
+                        fail(position, std::string("Data integrity check failed: ") +
+                                       EntryPathname(entry) + ": " + (err ? err : "unknown"));
+                        return;
+                    }
+                    read_stats.OnBlock(reader.get(), block_size);
+                }
+                tested_files.fetch_add(1, std::memory_order_relaxed);
+                auto compressed = static_cast<uint64_t>(
+                        std::max<int64_t>(0, entries[position].compressed_size));
+                auto done = tested_compressed.fetch_add(compressed, std::memory_order_relaxed);
+                if (stats_) {
+                    stats_->SetCompressedBytes(done + compressed);
+                    stats_->AddFile();
+                }
+            }
+        }
+    };
+
+    // 在调用线程上汇报进度
+    size_t reported = 0;
+    auto report = [&]() {
+        auto tested = tested_files.load(std::memory_order_relaxed);
+        if (!listener || tested == reported) return;
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            path = current_path;
+        }
+        listener(path, tested, total_files);
+        reported = tested;
+    };
+    RunWorkers(threads, worker, stopping, report);
+    if (mismatched.load()) {
+        BeginStats();
+        return std::nullopt;
+    }
+
+    auto tested = tested_files.load();
+    if (failed_index < entries.size()) {
+        return TestResult{
+                .success = false,
+                .error_message = error_message,
+                .tested_files = tested,
+                .total_files = total_files
+        };
+    }
+    report();
+    if (stats_) stats_->Finish();
+    return TestResult{
+            .success = true,
+            .error_message = "",
+            .tested_files = tested,
+            .total_files = total_files
+    };
+}
+
+bool ArchiveExtractor::ExtractParallel(
+        const std::string &output_dir,
+        const EntrySelector *selector,
+        const ProgressListener &listener,
+        bool overwrite,
+        ChecksumManifest *checksums
+) const {
+    auto threads = static_cast<size_t>(ResolveThreadCount(threads_));
+    if (threads <= 1) return false;
+    auto directory = ZipCentralDirectory::Open(archive_path_);
+    if (!directory) return false;
+    const auto &entries = directory->entries();
+
+    std::vector<bool> selected(entries.size());
+    size_t total_files = 0;
+    // 目录与符号链接不在工作线程上写出，记录最后一个的位置以便预处理时提前结束
+    size_t metadata_end = 0;
+    std::unordered_set<std::string_view> paths;
+    std::unordered_set<std::string_view> symlinks;
+    auto trim = [](std::string_view path) {
+        while (!path.empty() && path.back() == '/') path.remove_suffix(1);
+        return path;
+    };
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto &entry = entries[i];
+        selected[i] = !IsTombstoneEntry(entry.pathname) &&
+                      (!selector || selector->Matches(entry.pathname));
+        if (!selected[i]) continue;
+        // 同一路径出现多次时结果取决于写出顺序，只能顺序解压
+        if (!paths.insert(trim(entry.pathname)).second) return false;
+        if (entry.mode == AE_IFREG) {
+            ++total_files;
+        } else {
+            metadata_end = i + 1;
+            if (entry.mode == AE_IFLNK) symlinks.insert(trim(entry.pathname));
+        }
+    }
+    if (total_files < 2) return false;
+    // 符号链接最后创建，若其它条目需要经由符号链接写出，则与顺序解压的结果不同
+    if (!symlinks.empty()) {
+        for (auto path: paths) {
+            for (auto slash = path.find('/'); slash != std::string_view::npos;
+                 slash = path.find('/', slash + 1)) {
+                if (symlinks.count(path.substr(0, slash))) return false;
+            }
+        }
+    }
+    threads = std::min(threads, total_files);
+
+    BeginStats();
+    auto disk_options = ExtractDiskOptions(overwrite);
+    // 目录的权限与时间在 writer 关闭时才设置，因此该 writer 需在所有文件写出之后再关闭
+    auto metadata_writer = CreateDirectEntryWriter(disk_options, stats_);
+    ReadStats metadata_stats{stats_, nullptr, false};
+    auto ignore_regular_file = [](const std::filesystem::path &) {};
+
+    // 预处理：按归档顺序创建目录，复制符号链接条目留待最后创建
+    std::vector<std::unique_ptr<archive_entry, ArchiveEntryDeleter>> pending_links;
+    if (metadata_end > 0) {
+        auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
+        struct archive_entry *entry = nullptr;
+        for (size_t position = 0; position < metadata_end; ++position) {
+            int rc = ReadNextHeader(reader.get(), &entry, stats_);
+            if (rc == ARCHIVE_EOF || rc < ARCHIVE_OK) {
+                auto err = rc == ARCHIVE_EOF ? "unexpected end of archive"
+                                             : archive_error_string(reader.get());
+                throw std::runtime_error(
+                        std::string("Failed to read next header: ") + (err ? err : "unknown"));
+            }
+            // reader 读到的条目与中央目录顺序不一致，此时尚未写出任何常规文件
+            if (entries[position].pathname != EntryPathname(entry)) return false;
+            if (!selected[position]) continue;
+            auto filetype = archive_entry_filetype(entry);
+            if (filetype == AE_IFLNK) {
+                pending_links.emplace_back(archive_entry_clone(entry));
+            } else if (filetype != AE_IFREG) {
+                WriteCurrentEntryOrThrow(reader.get(), *metadata_writer, entry, output_dir,
+                                         metadata_stats, ignore_regular_file);
+            }
+        }
+    }
+
+    // 常规文件：每个工作线程使用独立的 reader 与 writer 依次认领区间
+    auto ranges = SplitIntoRanges(
+            entries.size(), threads * k_zip_ranges_per_thread, [&](size_t i) -> uint64_t {
+                if (!selected[i] || entries[i].mode != AE_IFREG) return 0;
+                return static_cast<uint64_t>(std::max<int64_t>(0, entries[i].compressed_size));
+            });
+    std::atomic<size_t> next_range{0};
+    std::atomic<size_t> extracted_files{0};
+    std::atomic<uint64_t> extracted_compressed{0};
+    std::atomic<bool> stopping{false};
+    // 条目与中央目录不一致时停止并回退到顺序解压；已写出的文件都与其路径对应，顺序解压时会被覆盖或跳过
+    std::atomic<bool> mismatched{false};
+    std::mutex mutex;
+    std::string current_path;
+
+    auto worker = [&]() {
+        auto reader = CreateArchiveReader(archive_path_, READ_BLOCK_SIZE);
+        auto writer = CreateDirectEntryWriter(disk_options, stats_);
+        ReadStats read_stats{stats_, nullptr, false};
+        std::unique_ptr<ChecksumManifest::Digest> digest;
+        if (checksums) digest = std::make_unique<ChecksumManifest::Digest>(*checksums);
+        struct archive_entry *entry = nullptr;
+        size_t position = 0;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            auto range = next_range.fetch_add(1, std::memory_order_relaxed);
+            if (range >= ranges.size()) break;
+            auto [begin, end] = ranges[range];
+            for (; position < end; ++position) {
+                if (stopping.load(std::memory_order_relaxed)) return;
+                int rc = ReadNextHeader(reader.get(), &entry, stats_);
+                if (rc == ARCHIVE_EOF || rc < ARCHIVE_OK) {
+                    auto err = rc == ARCHIVE_EOF ? "unexpected end of archive"
+                                                 : archive_error_string(reader.get());
+                    throw std::runtime_error(std::string("Failed to read next header: ") +
+                                             (err ? err : "unknown"));
+                }
+                if (entries[position].pathname != EntryPathname(entry)) {
+                    mismatched.store(true, std::memory_order_relaxed);
+                    stopping.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                if (position < begin || !selected[position] ||
+                    archive_entry_filetype(entry) != AE_IFREG) {
+                    continue;
+                }
+                WriteCurrentEntryOrThrow(
+                        reader.get(), *writer, entry, output_dir, read_stats,
+                        [&](const std::filesystem::path &dest) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            current_path = dest.string();
+                        }, digest.get());
+                extracted_files.fetch_add(1, std::memory_order_relaxed);
+                auto compressed = static_cast<uint64_t>(
+                        std::max<int64_t>(0, entries[position].compressed_size));
+                auto done = extracted_compressed.fetch_add(compressed, std::memory_order_relaxed);
+                if (stats_) stats_->SetCompressedBytes(done + compressed);
+            }
+        }
+        writer->Close();
+    };
+
+    size_t reported = 0;
+    auto report = [&]() {
+        auto extracted = extracted_files.load(std::memory_order_relaxed);
+        if (!listener || extracted == reported) return;
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            path = current_path;
+        }
+        listener(path, extracted, total_files);
+        reported = extracted;
+    };
+    RunWorkers(threads, worker, stopping, report);
+    if (mismatched.load()) return false;
+    report();
+
+    // 收尾：按归档顺序创建符号链接，最后设置目录属性
+    for (auto &link: pending_links) {
+        WriteCurrentEntryOrThrow(nullptr, *metadata_writer, link.get(), output_dir,
+                                 metadata_stats, ignore_regular_file);
+    }
+    metadata_writer->Close();
+    metadata_writer.reset();
+    if (stats_) stats_->Finish();
+    return true;
+}
@@ -3,7 +3,21 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "archive_common.hpp"
+#include "checksum_manifest.hpp"
+#include "entry_selector.hpp"
+#include "entry_writer.hpp"
+#include "operation_stats.hpp"
+
+class ArchiveIndex;
+class ParallelDecoder;
+class SeekableStream;
 
 class ArchiveExtractor {
 public:
@@ -15,18 +29,130 @@ public:
         mode_t mode;
         int64_t modify_time_ms;
         int64_t entry_size;
+        // 压缩后的数据大小，格式不提供时为 -1
+        int64_t compressed_size = -1;
+        // header 读取时已消耗的压缩字节数
+        int64_t compressed_offset = -1;
+        // header 在解压后数据流中的偏移
+        int64_t uncompressed_offset = -1;
+    };
+
+    /**
+     * 进度统计方式
+     * EntryCount: 处理前预先扫描一遍归档统计文件总数（压缩流会被完整解压两次）
+     * CompressedBytes: 单遍处理，按已消耗的压缩字节推算进度，文件总数随处理过程延迟估算
+     */
+    enum class ProgressMode {
+        EntryCount, CompressedBytes
     };
 
     explicit ArchiveExtractor(std::string archive_path);
 
+    ArchiveExtractor &SetProgressMode(ProgressMode mode) {
+        progress_mode_ = mode;
+        return *this;
+    }
+
+    /**
+     * 设置条目索引缓存目录，为空时不使用索引
+     */
+    ArchiveExtractor &SetIndexDirectory(std::string dir) {
+        index_dir_ = std::move(dir);
+        return *this;
+    }
+
+    /**
+     * 设置解压线程数，0 表示自动；多 block/帧/member 的压缩流会并行解压
+     */
+    ArchiveExtractor &SetThreads(int32_t threads) {
+        threads_ = threads;
+        return *this;
+    }
+
+    /**
+     * 流水线解压：解压与写盘分别在两个线程上进行，通过有界队列传递数据
+     * @param listener 解压完成后回调两端的背压统计，可为空
+     */
+    ArchiveExtractor &SetPipelined(bool pipelined, PipelineStatsListener listener = nullptr) {
+        pipelined_ = pipelined;
+        pipeline_listener_ = std::move(listener);
+        return *this;
+    }
+
+    /**
+     * 小文件写盘线程池：不超过 threshold 的常规文件由 writers 个线程并行写盘，0 表示自动，1 表示关闭
+     * 适用于包含大量小文件的归档，此时瓶颈在逐个文件的 open/write/close 等系统调用
+     */
+    ArchiveExtractor &SetSmallFileWriters(
+            int32_t writers,
+            size_t threshold = k_default_small_file_threshold
+    ) {
+        small_file_writers_ = writers;
+        small_file_threshold_ = threshold;
+        return *this;
+    }
+
+    /**
+     * 设置字节级统计对象（不持有，需在解压/测试期间保持有效），为空时不统计
+     */
+    ArchiveExtractor &SetStats(OperationStats *stats) {
+        stats_ = stats;
+        return *this;
+    }
+
+    /**
+     * 解压时同步计算每个常规文件的校验和，完成后将清单写到 manifest_path
+     * 数据取自写盘前已解压的数据块，不额外读取；None 或路径为空时不计算
+     */
+    ArchiveExtractor &SetChecksumManifest(ChecksumAlgorithm algorithm, std::string manifest_path) {
+        checksum_algorithm_ = algorithm;
+        checksum_path_ = std::move(manifest_path);
+        return *this;
+    }
+
+    /**
+     * 分块接收列表过程中新读到的条目，通过抛出异常（如 OperationCancelledException）中止列表
+     */
+    using EntryChunkListener = std::function<void(const ArchiveEntry *entries, size_t count)>;
+
     [[nodiscard]] std::vector<ArchiveEntry> ListEntry() const;
 
+    /**
+     * 与 ListEntry 相同，但在读取 header 的同时分块回调已读到的条目：
+     * 第一个条目立即回调，之后每累积一批或距上次回调超过一定时间再回调一次
+     */
+    std::vector<ArchiveEntry> ListEntry(const EntryChunkListener &on_chunk) const;
+
     void Extract(
             const std::string& output_dir,
             const ProgressListener& listener = nullptr,
             bool overwrite = true
     ) const;
 
+    /**
+     * 仅解压被选择器选中的条目，未选中条目的数据直接跳过；
+     * 存在有效索引时，索引中所有被选中的条目都写出后提前结束读取，否则读到结尾，
+     * 使追加写入的 tar 中同名条目的最后一个版本生效
+     */
+    void ExtractEntries(
+            const std::string &output_dir,
+            const EntrySelector &selector,
+            const ProgressListener &listener = nullptr,
+            bool overwrite = true
+    ) const;
+
+    /**
+     * 恢复增量打包的归档链：先解压当前归档，再按顺序解压各增量归档并覆盖已有文件；
+     * 遇到墓碑条目（k_tombstone_entry_name）时删除其中列出的路径而不写出该条目
+     * 原地追加的 tar 只需传入空的 delta_paths。进度按每个归档分别计数
+     * 设置了校验和清单时，整条链恢复完成后写出一份对应最终文件的清单
+     */
+    void ExtractChain(
+            const std::vector<std::string> &delta_paths,
+            const std::string &output_dir,
+            const ProgressListener &listener = nullptr
+    ) const;
+
     struct TestResult {
         bool success;
         std::string error_message;
@@ -37,8 +163,136 @@ public:
     [[nodiscard]] TestResult Test(const ProgressListener& listener = nullptr) const;
 
 private:
+    /**
+     * 选择性解压时记录本次写出的常规文件；被选中的硬链接的目标未被写出（数据已被跳过）时暂缓该链接，
+     * 由 ExtractDeferredLinks 再读一遍归档，把目标数据写到链接的路径
+     */
+    struct HardlinkTracker {
+        struct Links {
+            // 第一个链接 header 的未压缩偏移，目标取此前最后一次出现的版本
+            int64_t before;
+            std::vector<std::string> pathnames;
+        };
+
+        std::unordered_set<std::string> written;
+        // 键为目标的归档内路径
+        std::unordered_map<std::string, Links> deferred;
+
+        /**
+         * @param position 条目 header 的未压缩偏移
+         * @return 条目是需要暂缓的硬链接时返回true，调用方跳过该条目
+         */
+        bool Defer(struct archive_entry *entry, int64_t position);
+    };
+
     std::string archive_path_;
+    ProgressMode progress_mode_ = ProgressMode::EntryCount;
+    std::string index_dir_;
+    int32_t threads_ = 1;
+    bool pipelined_ = false;
+    PipelineStatsListener pipeline_listener_;
+    int32_t small_file_writers_ = 1;
+    size_t small_file_threshold_ = k_default_small_file_threshold;
+    OperationStats *stats_ = nullptr;
+    ChecksumAlgorithm checksum_algorithm_ = ChecksumAlgorithm::None;
+    std::string checksum_path_;
+    // 恢复归档链时处理墓碑条目，此时只使用顺序解压
+    bool apply_tombstones_ = false;
+    // 打开 reader 时读取的归档大小，用于估算条目总数，读取失败时为0
+    mutable int64_t archive_size_ = 0;
+
+    /**
+     * 并行测试 zip：按中央目录将条目划分为若干连续区间，多个线程各自打开 reader 依次认领区间，
+     * 跳过区间之前的条目并读取区间内常规文件的全部数据（libarchive 在条目读完时校验 CRC32）
+     * 进度回调始终在调用线程上执行
+     * @return 单线程、不是 zip、常规文件不足两个或 reader 读到的路径与中央目录不一致时返回 std::nullopt，
+     *         由调用方回退到顺序测试
+     */
+    [[nodiscard]] std::optional<TestResult> TestParallel(const ProgressListener &listener) const;
+
+    /**
+     * 并行解压 zip：按中央目录以压缩字节均衡地把常规文件划分给多个线程，各线程使用独立的 reader 与
+     * writer；目录在解压文件前按归档顺序创建，符号链接在文件之后创建，目录属性最后设置
+     * 此时不使用流水线与小文件写盘线程池
+     * @return 单线程、不是 zip、常规文件不足两个、存在重复路径或经由符号链接的路径，
+     *         以及 reader 读到的路径与中央目录不一致时返回false，由调用方回退到顺序解压
+     */
+    bool ExtractParallel(
+            const std::string &output_dir,
+            const EntrySelector *selector,
+            const ProgressListener &listener,
+            bool overwrite,
+            ChecksumManifest *checksums
+    ) const;
 
-    [[nodiscard]] size_t CountFilesInArchive() const;
+    [[nodiscard]] size_t CountFilesInArchive(const EntrySelector *selector = nullptr) const;
+
+    [[nodiscard]] std::vector<ArchiveEntry> ReadEntries(
+            const EntryChunkListener &on_chunk = nullptr) const;
+
+    [[nodiscard]] size_t ResolveTotalFiles(const EntrySelector *selector = nullptr) const;
+
+    /**
+     * 索引中被选中的条目数（不限类型，同名条目分别计数），没有有效索引时返回 std::nullopt
+     */
+    [[nodiscard]] std::optional<size_t> CountSelectedInIndex(const EntrySelector &selector) const;
+
+    [[nodiscard]] size_t EstimateTotalFiles(
+            archive *reader,
+            const ParallelDecoder *decoder,
+            size_t current_index
+    ) const;
+
+    /**
+     * 以归档大小作为总量开始统计
+     */
+    void BeginStats() const;
+
+    /**
+     * 打开顺序读取的 reader，可并行解压时 decoder 被设置为其数据源；同时记录归档大小
+     */
+    [[nodiscard]] std::unique_ptr<archive, ArchiveReadDeleter>
+    OpenReader(std::unique_ptr<ParallelDecoder> &decoder) const;
+
+    /**
+     * 未设置清单路径时返回nullptr
+     */
+    [[nodiscard]] std::unique_ptr<ChecksumManifest> CreateChecksumManifest() const;
+
+    /**
+     * @param checksums 不为空时记录写出的常规文件，由调用方在全部解压完成后写出
+     */
+    void ExtractSelected(
+            const std::string &output_dir,
+            const EntrySelector *selector,
+            const ProgressListener &listener,
+            bool overwrite,
+            ChecksumManifest *checksums
+    ) const;
+
+    /**
+     * 借助索引中的条目偏移与 seekable 压缩流，只解压包含目标条目的帧
+     * @return 条件不满足（缺少偏移信息）时返回false，由调用方回退到顺序读取
+     */
+    bool ExtractSeekable(
+            const std::string &output_dir,
+            const EntrySelector &selector,
+            const ArchiveIndex &index,
+            const SeekableStream &stream,
+            const ProgressListener &listener,
+            bool overwrite,
+            ChecksumManifest *checksums
+    ) const;
+
+    /**
+     * 补写 tracker 中暂缓的硬链接：每个目标的数据写到其第一个链接的路径，其余链接指向第一个链接
+     * @throw std::runtime_error 归档中找不到链接目标
+     */
+    void ExtractDeferredLinks(
+            const std::string &output_dir,
+            const HardlinkTracker &tracker,
+            bool overwrite,
+            ChecksumManifest *checksums
+    ) const;
 };
 
@@ -0,0 +1,250 @@
+#include "archive_index.hpp"
+
+#include <archive_entry.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "native_logger.hpp"
+
+namespace {
+    constexpr char k_index_magic[8] = {'A', 'R', 'C', 'H', 'I', 'D', 'X', '\0'};
+    constexpr uint32_t k_index_version = 2;
+    // 计算指纹时读取的归档头部与尾部字节数
+    constexpr size_t k_fingerprint_span = 4096;
+
+    struct IndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_count;
+        uint64_t archive_size;
+        int64_t archive_mtime_ns;
+        uint64_t fingerprint;
+        uint32_t archive_path_length;
+        uint32_t reserved;
+        uint64_t string_pool_size;
+    };
+
+    struct IndexRecord {
+        uint64_t path_offset;
+        uint32_t path_length;
+        uint32_t mode;
+        int64_t modify_time_ms;
+        int64_t entry_size;
+        int64_t compressed_size;
+        int64_t compressed_offset;
+        int64_t uncompressed_offset;
+    };
+
+    struct ArchiveKey {
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        uint64_t fingerprint = 0;
+    };
+
+    uint64_t Fnv1a(const void *data, size_t len, uint64_t hash = 0xcbf29ce484222325ULL) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < len; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * 读取归档的大小、修改时间与头尾指纹
+     */
+    bool ReadArchiveKey(const std::string &archive_path, ArchiveKey &key) {
+        int fd = open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        key.size = static_cast<uint64_t>(st.st_size);
+        key.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+        uint8_t buffer[k_fingerprint_span];
+        uint64_t hash = Fnv1a(&key.size, sizeof(key.size));
+        auto head = pread64(fd, buffer, sizeof(buffer), 0);
+        if (head > 0) hash = Fnv1a(buffer, static_cast<size_t>(head), hash);
+        if (key.size > k_fingerprint_span) {
+            auto tail = pread64(fd, buffer, sizeof(buffer),
+                                static_cast<off64_t>(key.size - k_fingerprint_span));
+            if (tail > 0) hash = Fnv1a(buffer, static_cast<size_t>(tail), hash);
+        }
+        close(fd);
+        key.fingerprint = hash;
+        return head >= 0;
+    }
+
+    std::filesystem::path IndexPathFor(const std::string &index_dir, const std::string &archive_path) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.idx",
+                 static_cast<unsigned long long>(Fnv1a(archive_path.data(), archive_path.size())));
+        return std::filesystem::path(index_dir) / name;
+    }
+
+    bool WriteAll(int fd, const void *data, size_t len) {
+        auto ptr = static_cast<const uint8_t *>(data);
+        while (len > 0) {
+            auto n = write(fd, ptr, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            ptr += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+std::unique_ptr<ArchiveIndex>
+ArchiveIndex::Open(const std::string &index_dir, const std::string &archive_path) {
+    if (index_dir.empty()) return nullptr;
+    ArchiveKey key;
+    if (!ReadArchiveKey(archive_path, key)) return nullptr;
+
+    auto index = std::unique_ptr<ArchiveIndex>(new ArchiveIndex());
+    if (!index->mapping_.Open(IndexPathFor(index_dir, archive_path).string())) return nullptr;
+
+    auto data = index->mapping_.data();
+    auto size = index->mapping_.size();
+    if (size < sizeof(IndexHeader)) return nullptr;
+    IndexHeader header{};
+    memcpy(&header, data, sizeof(header));
+
+    // 校验版本与归档键
+    if (memcmp(header.magic, k_index_magic, sizeof(k_index_magic)) != 0 ||
+        header.version != k_index_version ||
+        header.archive_size != key.size ||
+        header.archive_mtime_ns != key.mtime_ns ||
+        header.fingerprint != key.fingerprint) {
+        return nullptr;
+    }
+
+    // 校验布局：header | records | string pool
+    uint64_t records_size = static_cast<uint64_t>(header.entry_count) * sizeof(IndexRecord);
+    if (sizeof(IndexHeader) + records_size + header.string_pool_size != size ||
+        header.archive_path_length > header.string_pool_size) {
+        return nullptr;
+    }
+    index->entry_count_ = header.entry_count;
+    index->records_ = data + sizeof(IndexHeader);
+    index->string_pool_ = reinterpret_cast<const char *>(index->records_ + records_size);
+    index->string_pool_size_ = static_cast<size_t>(header.string_pool_size);
+
+    // 防止不同路径散列冲突
+    if (std::string_view(index->string_pool_, header.archive_path_length) != archive_path) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < index->entry_count_; ++i) {
+        IndexRecord record{};
+        memcpy(&record, index->records_ + i * sizeof(IndexRecord), sizeof(record));
+        if (record.path_offset + record.path_length > index->string_pool_size_) return nullptr;
+    }
+    return index;
+}
+
+bool ArchiveIndex::Write(
+        const std::string &index_dir,
+        const std::string &archive_path,
+        const std::vector<ArchiveExtractor::ArchiveEntry> &entries
+) {
+    if (index_dir.empty()) return false;
+    ArchiveKey key;
+    if (!ReadArchiveKey(archive_path, key)) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(index_dir, ec);
+
+    // 字符串池：归档路径 + 所有条目路径
+    std::string string_pool = archive_path;
+    std::vector<IndexRecord> records;
+    records.reserve(entries.size());
+    for (const auto &entry: entries) {
+        records.push_back(IndexRecord{
+                .path_offset = string_pool.size(),
+                .path_length = static_cast<uint32_t>(entry.pathname.size()),
+                .mode = static_cast<uint32_t>(entry.mode),
+                .modify_time_ms = entry.modify_time_ms,
+                .entry_size = entry.entry_size,
+                .compressed_size = entry.compressed_size,
+                .compressed_offset = entry.compressed_offset,
+                .uncompressed_offset = entry.uncompressed_offset
+        });
+        string_pool += entry.pathname;
+    }
+
+    IndexHeader header{};
+    memcpy(header.magic, k_index_magic, sizeof(k_index_magic));
+    header.version = k_index_version;
+    header.entry_count = static_cast<uint32_t>(records.size());
+    header.archive_size = key.size;
+    header.archive_mtime_ns = key.mtime_ns;
+    header.fingerprint = key.fingerprint;
+    header.archive_path_length = static_cast<uint32_t>(archive_path.size());
+    header.string_pool_size = string_pool.size();
+
+    auto index_path = IndexPathFor(index_dir, archive_path);
+    auto temp_path = index_path.string() + ".tmp";
+    int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    bool ok = WriteAll(fd, &header, sizeof(header)) &&
+              WriteAll(fd, records.data(), records.size() * sizeof(IndexRecord)) &&
+              WriteAll(fd, string_pool.data(), string_pool.size());
+    ok = (close(fd) == 0) && ok;
+    if (!ok || rename(temp_path.c_str(), index_path.c_str()) != 0) {
+        logger::error("ArchiveIndex::Write failed for %s", archive_path.c_str());
+        unlink(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+ArchiveIndex::EntryView ArchiveIndex::At(size_t index) const {
+    IndexRecord record{};
+    memcpy(&record, records_ + index * sizeof(IndexRecord), sizeof(record));
+    return EntryView{
+            .pathname = std::string_view(string_pool_ + record.path_offset, record.path_length),
+            .mode = static_cast<mode_t>(record.mode),
+            .modify_time_ms = record.modify_time_ms,
+            .entry_size = record.entry_size,
+            .compressed_size = record.compressed_size,
+            .compressed_offset = record.compressed_offset,
+            .uncompressed_offset = record.uncompressed_offset
+    };
+}
+
+size_t ArchiveIndex::CountRegularFiles() const {
+    size_t count = 0;
+    for (size_t i = 0; i < entry_count_; ++i) {
+        if (At(i).mode == AE_IFREG) ++count;
+    }
+    return count;
+}
+
+std::vector<ArchiveExtractor::ArchiveEntry> ArchiveIndex::ToEntries() const {
+    std::vector<ArchiveExtractor::ArchiveEntry> entries;
+    entries.reserve(entry_count_);
+    for (size_t i = 0; i < entry_count_; ++i) {
+        auto view = At(i);
+        entries.emplace_back(ArchiveExtractor::ArchiveEntry{
+                .pathname = std::string(view.pathname),
+                .mode = view.mode,
+                .modify_time_ms = view.modify_time_ms,
+                .entry_size = view.entry_size,
+                .compressed_size = view.compressed_size,
+                .compressed_offset = view.compressed_offset,
+                .uncompressed_offset = view.uncompressed_offset
+        });
+    }
+    return entries;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "archive_extractor.hpp"
+#include "utils/mapped_file.hpp"
+
+/**
+ * 归档条目索引缓存
+ * 以归档路径、大小、修改时间与头尾数据指纹作为键，将 ListEntry 的结果持久化到索引目录中，
+ * 归档未发生变化时直接通过内存映射读取索引，无需再次解压整个归档
+ */
+class ArchiveIndex {
+public:
+    /**
+     * 索引中的单个条目（字符串指向映射内存，生命周期与 ArchiveIndex 相同）
+     */
+    struct EntryView {
+        std::string_view pathname;
+        mode_t mode;
+        int64_t modify_time_ms;
+        int64_t entry_size;
+        int64_t compressed_size;
+        int64_t compressed_offset;
+        int64_t uncompressed_offset;
+    };
+
+    /**
+     * 打开归档对应的索引，索引不存在、已损坏或归档已被修改时返回nullptr
+     */
+    static std::unique_ptr<ArchiveIndex>
+    Open(const std::string &index_dir, const std::string &archive_path);
+
+    /**
+     * 将条目列表写入索引目录（先写临时文件再原子替换）
+     * @return 写入成功返回true；写入失败不影响调用方，只需退回到普通读取流程
+     */
+    static bool Write(
+            const std::string &index_dir,
+            const std::string &archive_path,
+            const std::vector<ArchiveExtractor::ArchiveEntry> &entries
+    );
+
+    [[nodiscard]] size_t size() const { return entry_count_; }
+
+    [[nodiscard]] EntryView At(size_t index) const;
+
+    /**
+     * 常规文件数量
+     */
+    [[nodiscard]] size_t CountRegularFiles() const;
+
+    [[nodiscard]] std::vector<ArchiveExtractor::ArchiveEntry> ToEntries() const;
+
+private:
+    MappedFile mapping_;
+    size_t entry_count_ = 0;
+    const uint8_t *records_ = nullptr;
+    const char *string_pool_ = nullptr;
+    size_t string_pool_size_ = 0;
+
+    ArchiveIndex() = default;
+};
@@ -0,0 +1,75 @@
+#include "archive_tree.hpp"
+
+#include <algorithm>
+#include <string>
+
+std::optional<size_t> ArchiveTree::ChildCount(std::string_view dir) const {
+    uint32_t node;
+    if (!trie_.Find(dir, node)) return std::nullopt;
+    return trie_.ChildCount(node);
+}
+
+bool ArchiveTree::ListChildren(
+        std::string_view dir,
+        SortOrder order,
+        size_t offset,
+        size_t limit,
+        EntryListing &out
+) {
+    uint32_t node;
+    if (!trie_.Find(dir, node)) return false;
+    auto [begin, end] = SortedChildren(node, order);
+    auto count = static_cast<size_t>(end - begin);
+    auto first = begin + std::min(offset, count);
+    auto last = first + std::min(limit, static_cast<size_t>(end - first));
+
+    // 子项共享目录路径前缀，只需替换最后一个分量
+    std::string path;
+    trie_.AppendPath(node, path);
+    if (!path.empty()) path += '/';
+    auto prefix_length = path.size();
+    for (auto it = first; it != last; ++it) {
+        const auto &child = trie_.At(*it);
+        path.resize(prefix_length);
+        path += trie_.NameOf(*it);
+        out.Add(path, child.is_directory, child.size, child.compressed_size, child.modify_time_ms);
+    }
+    return true;
+}
+
+std::pair<const uint32_t *, const uint32_t *>
+ArchiveTree::SortedChildren(uint32_t node, SortOrder order) {
+    auto begin = trie_.ChildrenBegin(node);
+    auto end = trie_.ChildrenEnd(node);
+    if (order.key == SortKey::Name && !order.descending && !order.directories_first) {
+        return {begin, end};
+    }
+
+    uint64_t cache_key = static_cast<uint64_t>(node) << 8 |
+                         static_cast<uint64_t>(order.key) << 2 |
+                         (order.descending ? 2u : 0u) |
+                         (order.directories_first ? 1u : 0u);
+    std::lock_guard<std::mutex> lock(sorted_mutex_);
+    auto cached = sorted_children_.find(cache_key);
+    if (cached == sorted_children_.end()) {
+        std::vector<uint32_t> sorted(begin, end);
+        auto value_of = [&](uint32_t index) {
+            const auto &child = trie_.At(index);
+            return order.key == SortKey::Size ? child.size : child.modify_time_ms;
+        };
+        // 子项已按名称升序，稳定排序使相同值的子项保持名称顺序
+        if (order.key != SortKey::Name) {
+            std::stable_sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+                return value_of(a) < value_of(b);
+            });
+        }
+        if (order.descending) std::reverse(sorted.begin(), sorted.end());
+        if (order.directories_first) {
+            std::stable_partition(sorted.begin(), sorted.end(), [&](uint32_t index) {
+                return trie_.At(index).is_directory;
+            });
+        }
+        cached = sorted_children_.emplace(cache_key, std::move(sorted)).first;
+    }
+    return {cached->second.data(), cached->second.data() + cached->second.size()};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "entry_listing.hpp"
+#include "entry_trie.hpp"
+
+/**
+ * 归档的目录树，每个打开的归档构建一次，按目录分页返回排好序的直接子项
+ * 构建完成后结构不再变化；各目录非默认顺序的排序结果在首次请求时计算并缓存
+ */
+class ArchiveTree {
+public:
+    enum class SortKey {
+        Name = 0, Size = 1, ModifyTime = 2
+    };
+
+    struct SortOrder {
+        SortKey key = SortKey::Name;
+        bool descending = false;
+        // 目录排在文件之前
+        bool directories_first = true;
+    };
+
+    /**
+     * @param trie 已 Finalize 的条目树
+     */
+    explicit ArchiveTree(EntryTrie trie) : trie_(std::move(trie)) {}
+
+    ArchiveTree(const ArchiveTree &) = delete;
+
+    ArchiveTree &operator=(const ArchiveTree &) = delete;
+
+    /**
+     * 目录的直接子项数量，目录不存在时返回空
+     * @param dir 目录路径，空字符串表示根目录
+     */
+    [[nodiscard]] std::optional<size_t> ChildCount(std::string_view dir) const;
+
+    /**
+     * 将目录下排序后的 [offset, offset + limit) 子项追加到 out
+     * @return 目录不存在时返回false
+     */
+    bool ListChildren(std::string_view dir, SortOrder order, size_t offset, size_t limit,
+                      EntryListing &out);
+
+private:
+    EntryTrie trie_;
+
+    std::mutex sorted_mutex_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> sorted_children_;
+
+    /**
+     * 返回按 order 排序的子项，名称升序且不区分目录时直接使用条目树中的顺序
+     */
+    std::pair<const uint32_t *, const uint32_t *> SortedChildren(uint32_t node, SortOrder order);
+};
@@ -0,0 +1,212 @@
+#include "checksum_manifest.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <zlib.h>
+#include <sha2.h>
+
+#define XXH_INLINE_ALL
+#include <common/xxhash.h>
+
+namespace {
+    // 填充稀疏空洞时每次追加的 0 字节数
+    constexpr size_t k_zero_block_size = 64 * 1024;
+
+    std::string ToHex(const uint8_t *data, size_t length) {
+        static constexpr char k_hex[] = "0123456789abcdef";
+        std::string hex(length * 2, '\0');
+        for (size_t i = 0; i < length; ++i) {
+            hex[2 * i] = k_hex[data[i] >> 4];
+            hex[2 * i + 1] = k_hex[data[i] & 0x0f];
+        }
+        return hex;
+    }
+
+    /**
+     * 整数摘要按大端序输出，与 crc32 / xxhsum 一致
+     */
+    std::string ToHex(uint64_t value, size_t bytes) {
+        uint8_t data[8];
+        for (size_t i = 0; i < bytes; ++i) {
+            data[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+        }
+        return ToHex(data, bytes);
+    }
+
+    bool WriteAll(int fd, const void *data, size_t len) {
+        auto ptr = static_cast<const uint8_t *>(data);
+        while (len > 0) {
+            auto n = write(fd, ptr, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            ptr += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+struct ChecksumManifest::Digest::State {
+    uLong crc = 0;
+    XXH64_state_t xxh64{};
+    SHA2_CTX sha256{};
+};
+
+ChecksumManifest::Digest::Digest(ChecksumManifest &manifest)
+        : manifest_(manifest), state_(std::make_unique<State>()) {
+    Reset();
+}
+
+ChecksumManifest::Digest::~Digest() = default;
+
+void ChecksumManifest::Digest::Reset() {
+    length_ = 0;
+    switch (manifest_.algorithm_) {
+        case ChecksumAlgorithm::None:
+            break;
+        case ChecksumAlgorithm::Crc32:
+            state_->crc = crc32(0L, Z_NULL, 0);
+            break;
+        case ChecksumAlgorithm::XxHash64:
+            XXH64_reset(&state_->xxh64, 0);
+            break;
+        case ChecksumAlgorithm::Sha256:
+            SHA256Init(&state_->sha256);
+            break;
+    }
+}
+
+void ChecksumManifest::Digest::Update(const void *data, size_t length, uint64_t offset) {
+    if (offset > length_) UpdateZeros(offset - length_);
+    auto bytes = static_cast<const uint8_t *>(data);
+    switch (manifest_.algorithm_) {
+        case ChecksumAlgorithm::None:
+            break;
+        case ChecksumAlgorithm::Crc32:
+            // zlib 的长度参数为 uInt，超大块需分段
+            for (size_t done = 0; done < length;) {
+                auto chunk = static_cast<uInt>(std::min<size_t>(length - done, 1u << 30));
+                state_->crc = crc32(state_->crc, bytes + done, chunk);
+                done += chunk;
+            }
+            break;
+        case ChecksumAlgorithm::XxHash64:
+            XXH64_update(&state_->xxh64, bytes, length);
+            break;
+        case ChecksumAlgorithm::Sha256:
+            SHA256Update(&state_->sha256, bytes, length);
+            break;
+    }
+    length_ += length;
+}
+
+void ChecksumManifest::Digest::UpdateZeros(uint64_t length) {
+    static const uint8_t k_zeros[k_zero_block_size] = {};
+    while (length > 0) {
+        auto chunk = static_cast<size_t>(std::min<uint64_t>(length, sizeof(k_zeros)));
+        Update(k_zeros, chunk, length_);
+        length -= chunk;
+    }
+}
+
+void ChecksumManifest::Digest::Commit(std::string path, uint64_t length) {
+    if (length > length_) UpdateZeros(length - length_);
+    std::string digest;
+    switch (manifest_.algorithm_) {
+        case ChecksumAlgorithm::None:
+            break;
+        case ChecksumAlgorithm::Crc32:
+            digest = ToHex(state_->crc, 4);
+            break;
+        case ChecksumAlgorithm::XxHash64:
+            digest = ToHex(XXH64_digest(&state_->xxh64), 8);
+            break;
+        case ChecksumAlgorithm::Sha256: {
+            uint8_t sha256[SHA256_DIGEST_LENGTH];
+            SHA256Final(sha256, &state_->sha256);
+            digest = ToHex(sha256, sizeof(sha256));
+            break;
+        }
+    }
+    manifest_.Add(std::move(path), std::move(digest));
+    Reset();
+}
+
+const char *ChecksumManifest::FileName(ChecksumAlgorithm algorithm) {
+    switch (algorithm) {
+        case ChecksumAlgorithm::Crc32:
+            return "CHECKSUMS.crc32";
+        case ChecksumAlgorithm::XxHash64:
+            return "CHECKSUMS.xxh64";
+        case ChecksumAlgorithm::Sha256:
+            return "CHECKSUMS.sha256";
+        default:
+            return "CHECKSUMS";
+    }
+}
+
+void ChecksumManifest::Add(std::string path, std::string digest) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.emplace_back(std::move(path), std::move(digest));
+}
+
+void ChecksumManifest::Remove(std::string_view path) {
+    while (!path.empty() && path.back() == '/') path.remove_suffix(1);
+    if (path.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto removed = [path](const std::pair<std::string, std::string> &entry) {
+        std::string_view entry_path = entry.first;
+        return entry_path.compare(0, path.size(), path) == 0 &&
+               (entry_path.size() == path.size() || entry_path[path.size()] == '/');
+    };
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), removed), entries_.end());
+}
+
+std::string ChecksumManifest::Serialize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 多线程解压时条目完成的顺序不确定，按路径排序使输出稳定
+    std::vector<const std::pair<std::string, std::string> *> sorted;
+    sorted.reserve(entries_.size());
+    for (const auto &entry: entries_) sorted.push_back(&entry);
+    std::stable_sort(sorted.begin(), sorted.end(), [](auto a, auto b) {
+        return a->first < b->first;
+    });
+
+    std::string result;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        // 同一路径记录了多次时只保留最后一次，与写出后磁盘上的文件一致
+        if (i + 1 < sorted.size() && sorted[i + 1]->first == sorted[i]->first) continue;
+        const auto &[path, digest] = *sorted[i];
+        // 与 sha256sum 相同：路径含反斜杠或换行时整行以反斜杠开头并转义
+        bool escape = path.find_first_of("\\\n") != std::string::npos;
+        if (escape) result += '\\';
+        result += digest;
+        result += "  ";
+        if (!escape) {
+            result += path;
+        } else {
+            for (auto c: path) {
+                if (c == '\\') result += "\\\\";
+                else if (c == '\n') result += "\\n";
+                else result += c;
+            }
+        }
+        result += '\n';
+    }
+    return result;
+}
+
+void ChecksumManifest::WriteTo(const std::string &path) const {
+    auto content = Serialize();
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error("Failed to create checksum manifest: " + path);
+    bool ok = WriteAll(fd, content.data(), content.size());
+    ok = (close(fd) == 0) && ok;
+    if (!ok) throw std::runtime_error("Failed to write checksum manifest: " + path);
+}
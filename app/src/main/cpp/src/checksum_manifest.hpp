@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum class ChecksumAlgorithm {
+    None = 0, Crc32 = 1, XxHash64 = 2, Sha256 = 3
+};
+
+/**
+ * 条目校验和清单，由打包/解压时已经流经的数据块计算，不额外读取数据
+ * 输出格式与 sha256sum / xxhsum 相同（"<摘要>  <路径>"，按路径排序），可直接用对应工具的 -c 校验
+ */
+class ChecksumManifest {
+public:
+    /**
+     * 单个条目的流式摘要，计算完一个条目后通过 Commit 记入清单并重置
+     * 不是线程安全的，多线程时每个线程使用各自的 Digest（清单本身可并发写入）
+     */
+    class Digest {
+    public:
+        explicit Digest(ChecksumManifest &manifest);
+
+        ~Digest();
+
+        /**
+         * 追加条目数据；offset 大于已追加的长度时（稀疏条目的空洞）先以 0 填充
+         */
+        void Update(const void *data, size_t length, uint64_t offset);
+
+        /**
+         * 以 0 填充到 length 后将摘要记入清单，并重置以计算下一个条目
+         */
+        void Commit(std::string path, uint64_t length = 0);
+
+    private:
+        struct State;
+
+        ChecksumManifest &manifest_;
+        std::unique_ptr<State> state_;
+        uint64_t length_ = 0;
+
+        void Reset();
+
+        void UpdateZeros(uint64_t length);
+    };
+
+    explicit ChecksumManifest(ChecksumAlgorithm algorithm) : algorithm_(algorithm) {}
+
+    [[nodiscard]] ChecksumAlgorithm algorithm() const { return algorithm_; }
+
+    /**
+     * 清单写入压缩包时使用的条目名，扩展名与算法对应
+     */
+    [[nodiscard]] static const char *FileName(ChecksumAlgorithm algorithm);
+
+    /**
+     * 移除路径本身及其下所有条目的记录（恢复归档链时处理墓碑条目）
+     */
+    void Remove(std::string_view path);
+
+    /**
+     * 同一路径记录了多次时（原地追加的 tar、归档链）只输出最后一次记录
+     */
+    [[nodiscard]] std::string Serialize() const;
+
+    /**
+     * @throw std::runtime_error 写入失败
+     */
+    void WriteTo(const std::string &path) const;
+
+private:
+    ChecksumAlgorithm algorithm_;
+    mutable std::mutex mutex_;
+    std::vector<std::pair<std::string, std::string>> entries_;
+
+    void Add(std::string path, std::string digest);
+};
@@ -0,0 +1,85 @@
+#include "entry_listing.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    struct ListingHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t string_pool_size;
+    };
+
+    // 每个条目在各数组中占用的字节数：3 个 int64 与 4 个 int32
+    constexpr size_t k_bytes_per_entry = 3 * sizeof(int64_t) + 4 * sizeof(int32_t);
+
+    /**
+     * 名称在路径中的起始位置，与 ExtractNameFromPath 的结果一致
+     */
+    size_t NameStart(std::string_view path) {
+        if (path.empty() || path == "/") return 0;
+        auto last_slash = path.find_last_of('/');
+        if (last_slash == std::string_view::npos || last_slash == path.size() - 1) return 0;
+        return last_slash + 1;
+    }
+
+    template<typename T, typename Field>
+    uint8_t *WriteColumn(uint8_t *dest, const std::vector<T> &records, Field field) {
+        for (const auto &record: records) {
+            auto value = record.*field;
+            memcpy(dest, &value, sizeof(value));
+            dest += sizeof(value);
+        }
+        return dest;
+    }
+}
+
+void EntryListing::Add(
+        std::string_view path,
+        bool is_directory,
+        int64_t size,
+        int64_t compressed_size,
+        int64_t modify_time_ms
+) {
+    records_.push_back(Record{
+            .size = size,
+            .compressed_size = compressed_size,
+            .modify_time_ms = modify_time_ms,
+            .path_offset = static_cast<uint32_t>(string_pool_.size()),
+            .path_length = static_cast<uint32_t>(path.size()),
+            .name_start = static_cast<uint32_t>(NameStart(path)),
+            .flags = is_directory ? k_flag_directory : 0
+    });
+    string_pool_.append(path);
+}
+
+size_t EntryListing::EncodedSize() const {
+    return sizeof(ListingHeader) + records_.size() * k_bytes_per_entry + string_pool_.size();
+}
+
+void EntryListing::EncodeTo(void *dest) const {
+    // Kotlin 端以 int 索引 ByteBuffer
+    if (EncodedSize() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw std::runtime_error("Entry listing is too large");
+    }
+
+    ListingHeader header{};
+    memcpy(header.magic, k_magic, sizeof(header.magic));
+    header.version = k_version;
+    header.entry_count = static_cast<uint32_t>(records_.size());
+    header.string_pool_size = static_cast<uint32_t>(string_pool_.size());
+
+    auto out = static_cast<uint8_t *>(dest);
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    out = WriteColumn(out, records_, &Record::size);
+    out = WriteColumn(out, records_, &Record::compressed_size);
+    out = WriteColumn(out, records_, &Record::modify_time_ms);
+    out = WriteColumn(out, records_, &Record::path_offset);
+    out = WriteColumn(out, records_, &Record::path_length);
+    out = WriteColumn(out, records_, &Record::name_start);
+    out = WriteColumn(out, records_, &Record::flags);
+    memcpy(out, string_pool_.data(), string_pool_.size());
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 条目列表的批量传输格式，一次性交给 Kotlin 端按需解码，避免为每个条目创建 Java 对象
+ * 布局（本机字节序，各数组按 8/4 字节对齐）：
+ *   header    : magic "ARCL", version u32, entry_count u32, string_pool_size u32
+ *   size      : int64[entry_count]
+ *   compressed: int64[entry_count]
+ *   modified  : int64[entry_count]（毫秒）
+ *   path_off  : int32[entry_count]（在字符串池中的偏移）
+ *   path_len  : int32[entry_count]
+ *   name_start: int32[entry_count]（名称在路径中的起始字节）
+ *   flags     : int32[entry_count]（k_flag_*）
+ *   pool      : UTF-8 字符串池
+ */
+class EntryListing {
+public:
+    static constexpr char k_magic[4] = {'A', 'R', 'C', 'L'};
+    static constexpr uint32_t k_version = 1;
+    static constexpr int32_t k_flag_directory = 1;
+
+    /**
+     * 按调用顺序追加一个条目
+     * @param path 标准化后的条目路径
+     */
+    void Add(std::string_view path, bool is_directory, int64_t size, int64_t compressed_size,
+             int64_t modify_time_ms);
+
+    [[nodiscard]] size_t size() const { return records_.size(); }
+
+    /**
+     * 编码后的字节数
+     */
+    [[nodiscard]] size_t EncodedSize() const;
+
+    /**
+     * 编码到 dest，dest 至少为 EncodedSize() 字节
+     * @throw std::runtime_error 列表超出格式可表示的范围（2GB）
+     */
+    void EncodeTo(void *dest) const;
+
+private:
+    struct Record {
+        int64_t size;
+        int64_t compressed_size;
+        int64_t modify_time_ms;
+        uint32_t path_offset;
+        uint32_t path_length;
+        uint32_t name_start;
+        int32_t flags;
+    };
+
+    std::vector<Record> records_;
+    std::string string_pool_;
+};
@@ -0,0 +1,84 @@
+#include "entry_selector.hpp"
+
+#include <fnmatch.h>
+
+#include "utils/file_utils.hpp"
+
+namespace {
+    /**
+     * 统一条目路径的比较形式：正斜杠、无末尾斜杠、无 "./" 前缀
+     */
+    std::string NormalizeEntryPath(std::string_view pathname) {
+        auto normalized = NormalizePath(std::string(pathname));
+        while (normalized.size() > 2 && normalized.compare(0, 2, "./") == 0) {
+            normalized.erase(0, 2);
+        }
+        return normalized;
+    }
+}
+
+EntrySelector::EntrySelector(
+        const std::vector<std::string> &paths,
+        const std::vector<std::string> &include_patterns,
+        const std::vector<std::string> &exclude_patterns
+) {
+    for (const auto &path: paths) {
+        auto normalized = NormalizeEntryPath(path);
+        if (normalized.empty()) continue;
+        paths_.insert(normalized);
+    }
+    for (const auto &pattern: include_patterns) {
+        if (!pattern.empty()) includes_.push_back(Compile(pattern));
+    }
+    for (const auto &pattern: exclude_patterns) {
+        if (!pattern.empty()) excludes_.push_back(Compile(pattern));
+    }
+}
+
+EntrySelector::Pattern EntrySelector::Compile(const std::string &pattern) {
+    auto normalized = NormalizeEntryPath(pattern);
+    return Pattern{
+            .pattern = normalized,
+            .match_basename = normalized.find('/') == std::string::npos,
+            .literal = normalized.find_first_of("*?[\\") == std::string::npos
+    };
+}
+
+bool EntrySelector::MatchPattern(const Pattern &pattern, std::string_view pathname) {
+    if (pattern.match_basename) {
+        auto last_slash = pathname.find_last_of('/');
+        if (last_slash != std::string_view::npos) pathname.remove_prefix(last_slash + 1);
+    }
+    if (pattern.literal) return pathname == pattern.pattern;
+    return fnmatch(pattern.pattern.c_str(), std::string(pathname).c_str(), 0) == 0;
+}
+
+bool EntrySelector::MatchesPath(std::string_view pathname) const {
+    // 条目自身或其任一祖先目录被选中
+    auto current = pathname;
+    while (!current.empty()) {
+        if (paths_.count(std::string(current))) return true;
+        auto last_slash = current.find_last_of('/');
+        if (last_slash == std::string_view::npos) break;
+        current = current.substr(0, last_slash);
+    }
+    return false;
+}
+
+bool EntrySelector::Matches(std::string_view pathname) const {
+    auto normalized = NormalizeEntryPath(pathname);
+    if (normalized.empty()) return false;
+    for (const auto &pattern: excludes_) {
+        if (MatchPattern(pattern, normalized)) return false;
+    }
+    if (paths_.empty() && includes_.empty()) return true;
+    if (!paths_.empty() && MatchesPath(normalized)) return true;
+    for (const auto &pattern: includes_) {
+        if (MatchPattern(pattern, normalized)) return true;
+    }
+    return false;
+}
+
+size_t EntrySelector::ExactPathCount() const {
+    return includes_.empty() ? paths_.size() : 0;
+}
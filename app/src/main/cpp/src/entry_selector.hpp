@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * 归档条目选择器
+ * 由精确路径集合与 include/exclude 通配符组成，用于选择性解压：
+ * - 选中目录路径时，其下所有条目一并选中
+ * - 不含 '/' 的通配符匹配文件名，含 '/' 的通配符匹配完整路径
+ * - 未指定任何路径与 include 时默认选中全部条目（仍受 exclude 约束）
+ */
+class EntrySelector {
+public:
+    EntrySelector(
+            const std::vector<std::string> &paths,
+            const std::vector<std::string> &include_patterns = {},
+            const std::vector<std::string> &exclude_patterns = {}
+    );
+
+    /**
+     * 判断条目是否被选中
+     */
+    [[nodiscard]] bool Matches(std::string_view pathname) const;
+
+    /**
+     * 仅由精确路径组成时返回路径数量，否则返回0（无法预知匹配数量）
+     */
+    [[nodiscard]] size_t ExactPathCount() const;
+
+private:
+    struct Pattern {
+        std::string pattern;
+        // 不含 '/' 时只匹配文件名
+        bool match_basename;
+        // 不含通配符时直接比较字符串
+        bool literal;
+    };
+
+    std::unordered_set<std::string> paths_;
+    std::vector<Pattern> includes_;
+    std::vector<Pattern> excludes_;
+
+    static Pattern Compile(const std::string &pattern);
+
+    static bool MatchPattern(const Pattern &pattern, std::string_view pathname);
+
+    [[nodiscard]] bool MatchesPath(std::string_view pathname) const;
+};
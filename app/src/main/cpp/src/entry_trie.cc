@@ -0,0 +1,188 @@
+#include "entry_trie.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    // 散列表的最大负载为 1/2
+    constexpr size_t k_min_slots = 16;
+
+    size_t SlotCountFor(size_t nodes) {
+        size_t slots = k_min_slots;
+        while (slots < nodes * 2) slots *= 2;
+        return slots;
+    }
+
+    /**
+     * 按 NormalizePath 的规则去掉末尾的一个 '/'
+     */
+    std::string_view TrimTrailingSlash(std::string_view path) {
+        if (path.size() > 1 && path.back() == '/') path.remove_suffix(1);
+        return path;
+    }
+
+    /**
+     * 下一个路径分量的结束位置；绝对路径的顶层分量包含开头的 '/'
+     */
+    size_t ComponentEnd(std::string_view path, size_t begin) {
+        auto search_from = (begin == 0 && !path.empty() && path[0] == '/') ? 1 : begin;
+        auto end = path.find('/', search_from);
+        return end == std::string_view::npos ? path.size() : end;
+    }
+}
+
+EntryTrie::EntryTrie(size_t expected_entries) {
+    nodes_.reserve(expected_entries + 1);
+    nodes_.push_back(Node{k_root, 0, 0, true, true, 0, 0, 0});
+    slots_.assign(SlotCountFor(expected_entries + 1), k_root);
+}
+
+uint64_t EntryTrie::HashOf(uint32_t parent, std::string_view name) {
+    // FNV-1a，以父节点下标作为种子
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (static_cast<uint64_t>(parent) * 0x9e3779b97f4a7c15ULL);
+    for (auto c: name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+size_t EntryTrie::SlotOf(uint32_t parent, std::string_view name) const {
+    auto mask = slots_.size() - 1;
+    auto slot = static_cast<size_t>(HashOf(parent, name)) & mask;
+    while (true) {
+        auto node = slots_[slot];
+        if (node == k_root) return slot;
+        if (nodes_[node].parent == parent && NameOf(node) == name) return slot;
+        slot = (slot + 1) & mask;
+    }
+}
+
+uint32_t EntryTrie::FindChild(uint32_t parent, std::string_view name) const {
+    return slots_[SlotOf(parent, name)];
+}
+
+uint32_t EntryTrie::FindOrAddChild(uint32_t parent, std::string_view name, int64_t modify_time_ms) {
+    auto slot = SlotOf(parent, name);
+    if (slots_[slot] != k_root) return slots_[slot];
+
+    if (nodes_.size() >= std::numeric_limits<uint32_t>::max() ||
+        names_.size() + name.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Too many archive entries");
+    }
+    auto node = static_cast<uint32_t>(nodes_.size());
+    // 新节点先作为由子项推导出的目录，若它就是被插入的条目则由调用方覆盖
+    nodes_.push_back(Node{
+            parent,
+            static_cast<uint32_t>(names_.size()),
+            static_cast<uint32_t>(name.size()),
+            true,
+            true,
+            0,
+            0,
+            modify_time_ms
+    });
+    names_.append(name);
+    slots_[slot] = node;
+    if (nodes_.size() * 2 > slots_.size()) Rehash(slots_.size() * 2);
+    return node;
+}
+
+void EntryTrie::Rehash(size_t slot_count) {
+    slots_.assign(slot_count, k_root);
+    auto mask = slot_count - 1;
+    for (uint32_t node = 1; node < nodes_.size(); ++node) {
+        auto slot = static_cast<size_t>(HashOf(nodes_[node].parent, NameOf(node))) & mask;
+        while (slots_[slot] != k_root) slot = (slot + 1) & mask;
+        slots_[slot] = node;
+    }
+}
+
+bool EntryTrie::Insert(
+        std::string_view pathname,
+        bool is_directory,
+        int64_t size,
+        int64_t compressed_size,
+        int64_t modify_time_ms
+) {
+    // 统一使用正斜杠，与 NormalizePath 一致
+    std::string backslash_free;
+    if (pathname.find('\\') != std::string_view::npos) {
+        backslash_free.assign(pathname);
+        std::replace(backslash_free.begin(), backslash_free.end(), '\\', '/');
+        pathname = backslash_free;
+    }
+    auto path = TrimTrailingSlash(pathname);
+    if (path.empty()) return false;
+
+    auto node = k_root;
+    for (size_t begin = 0; begin <= path.size();) {
+        auto end = ComponentEnd(path, begin);
+        node = FindOrAddChild(node, path.substr(begin, end - begin), modify_time_ms);
+        begin = end + 1;
+    }
+    auto &entry = nodes_[node];
+    entry.is_directory = is_directory;
+    entry.is_synthesized = false;
+    entry.size = size;
+    entry.compressed_size = compressed_size;
+    entry.modify_time_ms = modify_time_ms;
+    return true;
+}
+
+void EntryTrie::Finalize() {
+    // 计数排序得到按父节点分组的子项表，再对每组按名称排序
+    child_offsets_.assign(nodes_.size() + 1, 0);
+    for (uint32_t node = 1; node < nodes_.size(); ++node) ++child_offsets_[nodes_[node].parent + 1];
+    for (size_t i = 1; i < child_offsets_.size(); ++i) child_offsets_[i] += child_offsets_[i - 1];
+    children_.resize(nodes_.size() - 1);
+    std::vector<uint32_t> cursor(child_offsets_.begin(), child_offsets_.end() - 1);
+    for (uint32_t node = 1; node < nodes_.size(); ++node) {
+        children_[cursor[nodes_[node].parent]++] = node;
+    }
+    for (uint32_t node = 0; node < nodes_.size(); ++node) {
+        std::sort(children_.begin() + child_offsets_[node],
+                  children_.begin() + child_offsets_[node + 1],
+                  [this](uint32_t a, uint32_t b) { return NameOf(a) < NameOf(b); });
+    }
+    // 构建完成后不再插入，释放散列表外的多余容量
+    nodes_.shrink_to_fit();
+    names_.shrink_to_fit();
+}
+
+bool EntryTrie::Find(std::string_view path, uint32_t &node) const {
+    path = TrimTrailingSlash(path);
+    node = k_root;
+    if (path.empty()) return true;
+    for (size_t begin = 0; begin <= path.size();) {
+        auto end = ComponentEnd(path, begin);
+        node = FindChild(node, path.substr(begin, end - begin));
+        if (node == k_root) return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+void EntryTrie::AppendPath(uint32_t node, std::string &out) const {
+    if (node == k_root) return;
+    // 先收集祖先链，再自顶向下拼接
+    uint32_t chain[256];
+    size_t depth = 0;
+    std::vector<uint32_t> deep_chain;
+    for (auto current = node; current != k_root; current = nodes_[current].parent) {
+        if (depth < std::size(chain)) {
+            chain[depth++] = current;
+        } else {
+            deep_chain.push_back(current);
+        }
+    }
+    auto start = out.size();
+    auto append = [&](uint32_t current) {
+        if (out.size() > start) out += '/';
+        out += NameOf(current);
+    };
+    for (auto it = deep_chain.rbegin(); it != deep_chain.rend(); ++it) append(*it);
+    while (depth > 0) append(chain[--depth]);
+}
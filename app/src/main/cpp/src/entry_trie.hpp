@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * 归档条目的路径前缀树
+ * 每个节点只保存自身的路径分量，分量集中存放在一块字符串池中，节点之间以 32 位下标相互引用；
+ * 插入条目时自动补全缺失的父目录。所有数据保存在少数几块连续内存中，不为每个条目单独分配
+ */
+class EntryTrie {
+public:
+    static constexpr uint32_t k_root = 0;
+
+    struct Node {
+        uint32_t parent;
+        // 路径分量在字符串池中的位置；绝对路径的顶层分量包含开头的 '/'
+        uint32_t name_offset;
+        uint32_t name_length;
+        bool is_directory;
+        // 由子项推导出的目录，归档中没有对应条目
+        bool is_synthesized;
+        int64_t size;
+        int64_t compressed_size;
+        int64_t modify_time_ms;
+    };
+
+    /**
+     * @param expected_entries 预计的条目数量，用于预留空间
+     */
+    explicit EntryTrie(size_t expected_entries = 0);
+
+    /**
+     * 插入一个条目，路径按 NormalizePath 的规则处理；同一路径重复出现时以最后一次为准
+     * @return 路径为空时不插入并返回false
+     */
+    bool Insert(std::string_view pathname, bool is_directory, int64_t size, int64_t compressed_size,
+                int64_t modify_time_ms);
+
+    /**
+     * 插入完成后按名称排序各目录的子项，之后不能再插入
+     */
+    void Finalize();
+
+    /**
+     * 节点总数（含根节点）
+     */
+    [[nodiscard]] size_t size() const { return nodes_.size(); }
+
+    [[nodiscard]] const Node &At(uint32_t node) const { return nodes_[node]; }
+
+    [[nodiscard]] std::string_view NameOf(uint32_t node) const {
+        const auto &n = nodes_[node];
+        return {names_.data() + n.name_offset, n.name_length};
+    }
+
+    /**
+     * 查找直接子项，不存在时返回 k_root
+     */
+    [[nodiscard]] uint32_t FindChild(uint32_t parent, std::string_view name) const;
+
+    /**
+     * 按路径查找节点，空路径为根节点
+     * @return 不存在时返回false
+     */
+    bool Find(std::string_view path, uint32_t &node) const;
+
+    /**
+     * 按名称升序的直接子项（Finalize 之后有效）
+     */
+    [[nodiscard]] const uint32_t *ChildrenBegin(uint32_t node) const {
+        return children_.data() + child_offsets_[node];
+    }
+
+    [[nodiscard]] const uint32_t *ChildrenEnd(uint32_t node) const {
+        return children_.data() + child_offsets_[node + 1];
+    }
+
+    [[nodiscard]] size_t ChildCount(uint32_t node) const {
+        return child_offsets_[node + 1] - child_offsets_[node];
+    }
+
+    /**
+     * 将节点的完整路径追加到 out
+     */
+    void AppendPath(uint32_t node, std::string &out) const;
+
+    /**
+     * 以深度优先、同级按名称升序的顺序遍历除根以外的所有节点（Finalize 之后有效）
+     * @param visitor void(uint32_t node, std::string_view path)
+     */
+    template<typename Visitor>
+    void VisitDepthFirst(Visitor &&visitor) const {
+        struct Frame {
+            const uint32_t *cursor;
+            const uint32_t *end;
+            size_t path_length;
+        };
+        std::string path;
+        std::vector<Frame> stack{{ChildrenBegin(k_root), ChildrenEnd(k_root), 0}};
+        while (!stack.empty()) {
+            auto &frame = stack.back();
+            if (frame.cursor == frame.end) {
+                stack.pop_back();
+                continue;
+            }
+            auto node = *frame.cursor++;
+            path.resize(frame.path_length);
+            if (!path.empty()) path += '/';
+            path += NameOf(node);
+            visitor(node, std::string_view(path));
+            if (ChildCount(node) > 0) {
+                stack.push_back(Frame{ChildrenBegin(node), ChildrenEnd(node), path.size()});
+            }
+        }
+    }
+
+private:
+    std::vector<Node> nodes_;
+    std::string names_;
+    // (parent, name) -> 节点的开放寻址散列表，空槽为 k_root
+    std::vector<uint32_t> slots_;
+    std::vector<uint32_t> child_offsets_;
+    std::vector<uint32_t> children_;
+
+    [[nodiscard]] static uint64_t HashOf(uint32_t parent, std::string_view name);
+
+    [[nodiscard]] size_t SlotOf(uint32_t parent, std::string_view name) const;
+
+    uint32_t FindOrAddChild(uint32_t parent, std::string_view name, int64_t modify_time_ms);
+
+    void Rehash(size_t slot_count);
+};
@@ -0,0 +1,481 @@
+#include "entry_writer.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "utils/bounded_queue.hpp"
+
+namespace {
+    // 流水线中单个数据块的大小与队列容量（约 8 MiB 在途数据）
+    constexpr size_t k_chunk_size = 256 * 1024;
+    constexpr size_t k_queue_capacity = 32;
+    // 每个小文件写盘线程的队列容量
+    constexpr size_t k_pool_queue_capacity = 16;
+
+    /**
+     * 确保目标文件的父目录存在；失败不会抛出错误
+     */
+    void EnsureParentDirectories(const std::filesystem::path &dest) noexcept {
+        if (!dest.has_parent_path()) return;
+        std::error_code ec;
+        std::filesystem::create_directories(dest.parent_path(), ec);
+    }
+
+    /**
+     * 将条目写到 disk，所有方法都必须在同一线程上调用
+     */
+    class DiskWriter {
+    public:
+        DiskWriter(long disk_options, OperationStats *stats)
+                : disk_(CreateArchiveWriteDisk(disk_options)), stats_(stats),
+                  no_overwrite_((disk_options & ARCHIVE_EXTRACT_NO_OVERWRITE) != 0) {}
+
+        /**
+         * 写 header（根据entry type创建目录、链接或准备写入文件）
+         * @throw std::runtime_error 包含 archive 的错误
+         */
+        void WriteHeader(struct archive_entry *entry, const std::filesystem::path &dest) {
+            OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+            dest_ = dest;
+            EnsureParentDirectories(dest);
+            // 不覆盖时 libarchive 对已存在的文件不打开写入，之后的数据需要丢弃
+            std::error_code ec;
+            skip_data_ = no_overwrite_ && std::filesystem::exists(std::filesystem::symlink_status(dest, ec));
+            if (archive_write_header(disk_.get(), entry) == ARCHIVE_OK) return;
+            auto err = archive_error_string(disk_.get());
+            throw std::runtime_error(
+                    std::string("Failed to write header for ") + dest.string() + ": " +
+                    (err ? err : "unknown"));
+        }
+
+        /**
+         * @throw std::runtime_error 写入失败
+         */
+        void WriteData(const void *data, size_t length, int64_t offset) {
+            if (skip_data_) return;
+            OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Io);
+            if (archive_write_data_block(disk_.get(), data, length, offset) >= 0) {
+                if (stats_) stats_->AddBytesWritten(length);
+                return;
+            }
+            auto err = archive_error_string(disk_.get());
+            throw std::runtime_error(
+                    std::string("Error writing data to disk for ") + dest_.string() + ": " +
+                    (err ? err : "unknown"));
+        }
+
+        /**
+         * 完成条目（finish entry）
+         * @throw std::runtime_error 调用archive_write_finish_entry失败时将抛出错误信息
+         */
+        void FinishEntry() {
+            // 关闭文件并设置时间、权限等属性
+            OperationStats::ScopedPhase phase(stats_, OperationStats::Phase::Metadata);
+            if (archive_write_finish_entry(disk_.get()) == ARCHIVE_OK) return;
+            auto err = archive_error_string(disk_.get());
+            throw std::runtime_error(std::string("Failed to finish entry ") + dest_.string() + ": " +
+                                     (err ? err : "unknown"));
+        }
+
+    private:
+        std::unique_ptr<archive, ArchiveWriteDiskDeleter> disk_;
+        OperationStats *stats_;
+        bool no_overwrite_;
+        bool skip_data_ = false;
+        std::filesystem::path dest_;
+    };
+
+    class DirectEntryWriter : public EntryWriter {
+    public:
+        DirectEntryWriter(long disk_options, OperationStats *stats) : disk_(disk_options, stats) {}
+
+        void WriteHeader(struct archive_entry *entry, const std::filesystem::path &dest) override {
+            disk_.WriteHeader(entry, dest);
+        }
+
+        void WriteData(const void *data, size_t length, int64_t offset) override {
+            disk_.WriteData(data, length, offset);
+        }
+
+        void FinishEntry() override { disk_.FinishEntry(); }
+
+    private:
+        DiskWriter disk_;
+    };
+
+    class PipelinedEntryWriter : public EntryWriter {
+    public:
+        PipelinedEntryWriter(long disk_options, PipelineStatsListener listener, OperationStats *stats)
+                : listener_(std::move(listener)), queue_(k_queue_capacity) {
+            // disk 对象在写盘线程上创建和使用
+            writer_ = std::thread([this, disk_options, stats] { WriterLoop(disk_options, stats); });
+        }
+
+        ~PipelinedEntryWriter() override {
+            // 未正常 Close（读取端出错或取消）时丢弃剩余数据
+            if (writer_.joinable()) {
+                queue_.Abort();
+                writer_.join();
+            }
+        }
+
+        void WriteHeader(struct archive_entry *entry, const std::filesystem::path &dest) override {
+            Item item;
+            item.type = Item::Type::Header;
+            // libarchive 会在读取下一个 header 时复用 entry，因此需要复制
+            item.entry.reset(archive_entry_clone(entry));
+            item.dest = dest;
+            Push(std::move(item));
+        }
+
+        void WriteData(const void *data, size_t length, int64_t offset) override {
+            // 只合并连续的数据，遇到空洞时先提交当前数据块
+            if (!chunk_.empty() && offset != chunk_offset_ + static_cast<int64_t>(chunk_.size())) {
+                FlushChunk();
+            }
+            auto ptr = static_cast<const char *>(data);
+            while (length > 0) {
+                if (chunk_.capacity() == 0) chunk_ = AcquireChunk();
+                if (chunk_.empty()) chunk_offset_ = offset;
+                auto n = std::min(length, k_chunk_size - chunk_.size());
+                chunk_.insert(chunk_.end(), ptr, ptr + n);
+                ptr += n;
+                length -= n;
+                offset += static_cast<int64_t>(n);
+                if (chunk_.size() == k_chunk_size) FlushChunk();
+            }
+        }
+
+        void FinishEntry() override {
+            FlushChunk();
+            Item item;
+            item.type = Item::Type::Finish;
+            Push(std::move(item));
+        }
+
+        void Flush() override {
+            FlushChunk();
+            Item item;
+            item.type = Item::Type::Sync;
+            item.synced = std::make_shared<std::promise<void>>();
+            auto synced = item.synced->get_future();
+            Push(std::move(item));
+            try {
+                synced.get();
+            } catch (const std::future_error &) {
+                // 写盘线程出错时会丢弃队列中的同步点
+                writer_.join();
+                if (error_) std::rethrow_exception(error_);
+                throw;
+            }
+        }
+
+        void Close() override {
+            queue_.Close();
+            writer_.join();
+            if (error_) std::rethrow_exception(error_);
+            if (listener_) {
+                listener_(PipelineStats{
+                        .chunks = chunks_,
+                        .bytes = bytes_,
+                        .reader_blocked_ns = queue_.PushWaitNanos(),
+                        .writer_idle_ns = queue_.PopWaitNanos(),
+                        .queue_capacity = queue_.capacity(),
+                        .peak_depth = queue_.PeakSize()
+                });
+            }
+        }
+
+    private:
+        struct Item {
+            enum class Type {
+                Header, Data, Finish, Sync
+            };
+            Type type = Type::Data;
+            std::unique_ptr<archive_entry, ArchiveEntryDeleter> entry;
+            std::filesystem::path dest;
+            std::vector<char> data;
+            int64_t offset = 0;
+            std::shared_ptr<std::promise<void>> synced;
+        };
+
+        PipelineStatsListener listener_;
+        BoundedQueue<Item> queue_;
+        std::thread writer_;
+        // 写盘线程出错时记录异常，由读取线程重新抛出
+        std::exception_ptr error_;
+        std::vector<char> chunk_;
+        int64_t chunk_offset_ = 0;
+        std::mutex free_mutex_;
+        std::vector<std::vector<char>> free_chunks_;
+        uint64_t chunks_ = 0;
+        uint64_t bytes_ = 0;
+
+        void Push(Item item) {
+            if (queue_.Push(std::move(item))) return;
+            // 队列只会因写盘线程出错而被提前关闭
+            writer_.join();
+            if (error_) std::rethrow_exception(error_);
+            throw std::runtime_error("Extract pipeline closed unexpectedly");
+        }
+
+        std::vector<char> AcquireChunk() {
+            std::vector<char> chunk;
+            {
+                std::lock_guard<std::mutex> lock(free_mutex_);
+                if (!free_chunks_.empty()) {
+                    chunk = std::move(free_chunks_.back());
+                    free_chunks_.pop_back();
+                }
+            }
+            chunk.clear();
+            chunk.reserve(k_chunk_size);
+            return chunk;
+        }
+
+        void RecycleChunk(std::vector<char> chunk) {
+            std::lock_guard<std::mutex> lock(free_mutex_);
+            free_chunks_.push_back(std::move(chunk));
+        }
+
+        void FlushChunk() {
+            if (chunk_.empty()) return;
+            ++chunks_;
+            bytes_ += chunk_.size();
+            Item item;
+            item.data = std::move(chunk_);
+            item.offset = chunk_offset_;
+            chunk_ = std::vector<char>();
+            Push(std::move(item));
+        }
+
+        void WriterLoop(long disk_options, OperationStats *stats) {
+            try {
+                DiskWriter disk(disk_options, stats);
+                Item item;
+                while (queue_.Pop(item)) {
+                    switch (item.type) {
+                        case Item::Type::Header:
+                            disk.WriteHeader(item.entry.get(), item.dest);
+                            break;
+                        case Item::Type::Data:
+                            disk.WriteData(item.data.data(), item.data.size(), item.offset);
+                            RecycleChunk(std::move(item.data));
+                            break;
+                        case Item::Type::Finish:
+                            disk.FinishEntry();
+                            break;
+                        case Item::Type::Sync:
+                            item.synced->set_value();
+                            break;
+                    }
+                }
+            } catch (...) {
+                error_ = std::current_exception();
+                queue_.Abort();
+            }
+        }
+    };
+
+    class PooledEntryWriter : public EntryWriter {
+    public:
+        PooledEntryWriter(
+                std::unique_ptr<EntryWriter> inner,
+                long disk_options,
+                int32_t workers,
+                size_t threshold,
+                OperationStats *stats
+        ) : inner_(std::move(inner)), threshold_(threshold) {
+            workers = std::max<int32_t>(1, workers);
+            for (int32_t i = 0; i < workers; ++i) {
+                workers_.push_back(std::make_unique<Worker>());
+            }
+            // 每个线程持有独立的 disk 对象，archive_write_disk 不能跨线程共享
+            for (auto &worker: workers_) {
+                worker->thread = std::thread([this, w = worker.get(), disk_options, stats] {
+                    WorkerLoop(*w, disk_options, stats);
+                });
+            }
+        }
+
+        ~PooledEntryWriter() override {
+            for (auto &worker: workers_) worker->queue.Abort();
+            for (auto &worker: workers_) {
+                if (worker->thread.joinable()) worker->thread.join();
+            }
+        }
+
+        void WriteHeader(struct archive_entry *entry, const std::filesystem::path &dest) override {
+            buffered_ = IsSmallFile(entry);
+            if (buffered_) {
+                // 同一路径可能先经 inner 写出（链接、大文件），需先落盘再交给线程池
+                if (inner_dirty_) {
+                    inner_->Flush();
+                    inner_dirty_ = false;
+                }
+                job_.entry.reset(archive_entry_clone(entry));
+                job_.dest = dest;
+                job_.data.clear();
+                job_.data.reserve(static_cast<size_t>(archive_entry_size(entry)));
+                return;
+            }
+            // 链接可能指向线程池中尚未写出的文件；大文件可能与其中的小文件同名
+            // 目录由 inner 写出，线程池会自行创建父目录，无需等待
+            if (archive_entry_filetype(entry) != AE_IFDIR) {
+                Barrier();
+                inner_dirty_ = true;
+            }
+            inner_->WriteHeader(entry, dest);
+        }
+
+        void WriteData(const void *data, size_t length, int64_t offset) override {
+            if (!buffered_) {
+                inner_->WriteData(data, length, offset);
+                return;
+            }
+            // 小文件不保留空洞，按偏移放入缓冲区，跳过的区间补零
+            auto end = static_cast<size_t>(offset) + length;
+            if (job_.data.size() < end) job_.data.resize(end);
+            memcpy(job_.data.data() + offset, data, length);
+        }
+
+        void FinishEntry() override {
+            if (!buffered_) {
+                inner_->FinishEntry();
+                return;
+            }
+            buffered_ = false;
+            Submit(std::move(job_));
+            job_ = Job();
+        }
+
+        void Flush() override {
+            Barrier();
+            inner_->Flush();
+            inner_dirty_ = false;
+        }
+
+        void Close() override {
+            for (auto &worker: workers_) worker->queue.Close();
+            for (auto &worker: workers_) worker->thread.join();
+            ThrowIfFailed();
+            inner_->Close();
+        }
+
+    private:
+        struct Job {
+            std::unique_ptr<archive_entry, ArchiveEntryDeleter> entry;
+            std::filesystem::path dest;
+            std::vector<char> data;
+        };
+
+        struct Worker {
+            BoundedQueue<Job> queue{k_pool_queue_capacity};
+            std::thread thread;
+        };
+
+        std::unique_ptr<EntryWriter> inner_;
+        size_t threshold_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        // 当前条目是否缓存后交给线程池
+        bool buffered_ = false;
+        Job job_;
+        // inner 是否有尚未确认落盘的非目录条目
+        bool inner_dirty_ = false;
+        // 已提交但尚未写完的小文件数量，以及首个写盘错误
+        std::mutex state_mutex_;
+        std::condition_variable idle_;
+        size_t pending_ = 0;
+        std::exception_ptr error_;
+
+        [[nodiscard]] bool IsSmallFile(struct archive_entry *entry) const {
+            return archive_entry_filetype(entry) == AE_IFREG &&
+                   archive_entry_hardlink(entry) == nullptr &&
+                   archive_entry_size_is_set(entry) &&
+                   archive_entry_size(entry) >= 0 &&
+                   static_cast<uint64_t>(archive_entry_size(entry)) <= threshold_;
+        }
+
+        void Submit(Job job) {
+            ThrowIfFailed();
+            // 同一路径总是落在同一线程上，保证重复条目按归档顺序覆盖
+            auto &worker = *workers_[std::hash<std::string>{}(job.dest.string()) % workers_.size()];
+            {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                ++pending_;
+            }
+            if (worker.queue.Push(std::move(job))) return;
+            // 队列只会因写盘线程出错而被提前关闭
+            ThrowIfFailed();
+            throw std::runtime_error("Small file writer closed unexpectedly");
+        }
+
+        /**
+         * 等待线程池中所有已提交的小文件写完
+         * @throw std::runtime_error 写入失败
+         */
+        void Barrier() {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            idle_.wait(lock, [this] { return pending_ == 0 || error_; });
+            if (error_) std::rethrow_exception(error_);
+        }
+
+        void ThrowIfFailed() {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            if (error_) std::rethrow_exception(error_);
+        }
+
+        void WorkerLoop(Worker &worker, long disk_options, OperationStats *stats) {
+            try {
+                DiskWriter disk(disk_options, stats);
+                Job job;
+                while (worker.queue.Pop(job)) {
+                    disk.WriteHeader(job.entry.get(), job.dest);
+                    if (!job.data.empty()) disk.WriteData(job.data.data(), job.data.size(), 0);
+                    disk.FinishEntry();
+                    job = Job();
+                    std::lock_guard<std::mutex> lock(state_mutex_);
+                    if (--pending_ == 0) idle_.notify_all();
+                }
+            } catch (...) {
+                worker.queue.Abort();
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                if (!error_) error_ = std::current_exception();
+                idle_.notify_all();
+            }
+        }
+    };
+}
+
+std::unique_ptr<EntryWriter> CreateDirectEntryWriter(long disk_options, OperationStats *stats) {
+    return std::make_unique<DirectEntryWriter>(disk_options, stats);
+}
+
+std::unique_ptr<EntryWriter> CreatePipelinedEntryWriter(
+        long disk_options,
+        PipelineStatsListener listener,
+        OperationStats *stats
+) {
+    return std::make_unique<PipelinedEntryWriter>(disk_options, std::move(listener), stats);
+}
+
+std::unique_ptr<EntryWriter> CreatePooledEntryWriter(
+        std::unique_ptr<EntryWriter> inner,
+        long disk_options,
+        int32_t workers,
+        size_t threshold,
+        OperationStats *stats
+) {
+    return std::make_unique<PooledEntryWriter>(std::move(inner), disk_options, workers, threshold,
+                                               stats);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+#include "archive_common.hpp"
+#include "operation_stats.hpp"
+
+/**
+ * 解压流水线的统计信息
+ * reader_blocked_ns 越大说明写盘是瓶颈，writer_idle_ns 越大说明解压是瓶颈
+ */
+struct PipelineStats {
+    // 传递的数据块数量与字节数
+    uint64_t chunks;
+    uint64_t bytes;
+    // 读取（解压）线程因队列已满而等待的时间
+    uint64_t reader_blocked_ns;
+    // 写盘线程因队列为空而等待的时间
+    uint64_t writer_idle_ns;
+    size_t queue_capacity;
+    size_t peak_depth;
+};
+
+using PipelineStatsListener = std::function<void(const PipelineStats &stats)>;
+
+/**
+ * 将条目写到磁盘的一端，读取端按 WriteHeader -> WriteData* -> FinishEntry 的顺序调用
+ */
+class EntryWriter {
+public:
+    virtual ~EntryWriter() = default;
+
+    /**
+     * @param entry 已将 pathname 设置为目标路径的条目
+     * @throw std::runtime_error 写入失败
+     */
+    virtual void WriteHeader(struct archive_entry *entry, const std::filesystem::path &dest) = 0;
+
+    /**
+     * @param offset 数据在条目中的偏移；跳过的区间作为稀疏空洞保留
+     */
+    virtual void WriteData(const void *data, size_t length, int64_t offset) = 0;
+
+    virtual void FinishEntry() = 0;
+
+    /**
+     * 等待已提交的条目全部落盘，之后的条目保证在其之后写出
+     * @throw std::runtime_error 写入失败
+     */
+    virtual void Flush() {}
+
+    /**
+     * 等待所有数据写出
+     * @throw std::runtime_error 写入失败
+     */
+    virtual void Close() {}
+};
+
+/**
+ * 在调用线程上直接写盘
+ * @param stats 记录写盘字节数与耗时，可为空（以下同）
+ */
+std::unique_ptr<EntryWriter> CreateDirectEntryWriter(
+        long disk_options,
+        OperationStats *stats = nullptr
+);
+
+/**
+ * 由独立的写盘线程通过有界队列消费数据，读取线程只负责解压
+ * @param listener Close 成功后回调统计信息，可为空
+ */
+std::unique_ptr<EntryWriter> CreatePipelinedEntryWriter(
+        long disk_options,
+        PipelineStatsListener listener,
+        OperationStats *stats = nullptr
+);
+
+// 默认的小文件阈值：不超过该大小的常规文件交给写盘线程池
+constexpr size_t k_default_small_file_threshold = 128 * 1024;
+
+/**
+ * 小文件写盘线程池：完整缓存不超过 threshold 的常规文件，按目标路径哈希分配给 workers 个写盘线程
+ * 目录与其余条目交给 inner；写出链接、大文件前会等待线程池清空，保证依赖顺序
+ * @param inner 写出非小文件条目的 writer（直接或流水线）
+ */
+std::unique_ptr<EntryWriter> CreatePooledEntryWriter(
+        std::unique_ptr<EntryWriter> inner,
+        long disk_options,
+        int32_t workers,
+        size_t threshold,
+        OperationStats *stats = nullptr
+);
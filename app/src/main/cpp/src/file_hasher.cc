@@ -0,0 +1,189 @@
+#include "file_hasher.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <sha2.h>
+
+#define XXH_INLINE_ALL
+#include <common/xxhash.h>
+
+#include "utils/file_reader.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace {
+    // 预哈希读取的首尾字节数
+    constexpr size_t k_prehash_span = 64 * 1024;
+    // 等待任务完成时汇报进度的间隔
+    constexpr std::chrono::milliseconds k_progress_interval{50};
+
+    struct FdCloser {
+        int fd;
+
+        ~FdCloser() { if (fd >= 0) close(fd); }
+    };
+
+    bool ReadFully(int fd, uint8_t *buffer, size_t length, uint64_t offset) {
+        while (length > 0) {
+            auto n = pread64(fd, buffer, length, static_cast<off64_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer += n;
+            length -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * 首尾各 k_prehash_span 字节的 XXH64（以文件大小为种子），文件不超过两段长度时即为整个文件
+     * @return 读取失败时返回false
+     */
+    bool PreHash(const std::string &path, uint64_t &hash) {
+        thread_local std::vector<uint8_t> buffer(2 * k_prehash_span);
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        FdCloser closer{fd};
+        struct stat st{};
+        if (fstat(fd, &st) != 0) return false;
+        auto size = static_cast<uint64_t>(std::max<off_t>(0, st.st_size));
+
+        size_t length;
+        if (size <= buffer.size()) {
+            length = static_cast<size_t>(size);
+            if (!ReadFully(fd, buffer.data(), length, 0)) return false;
+        } else {
+            length = buffer.size();
+            if (!ReadFully(fd, buffer.data(), k_prehash_span, 0) ||
+                !ReadFully(fd, buffer.data() + k_prehash_span, k_prehash_span,
+                           size - k_prehash_span)) {
+                return false;
+            }
+        }
+        hash = XXH64(buffer.data(), length, size);
+        return true;
+    }
+
+    /**
+     * 完整文件的 SHA-256，stopping 被置位时放弃
+     * @return 小写十六进制摘要，读取失败或被取消时为空字符串
+     */
+    std::string Sha256Of(const std::string &path, const std::atomic<bool> &stopping) {
+        thread_local FileReader reader;
+        SHA2_CTX context;
+        SHA256Init(&context);
+        try {
+            reader.ReadFile(path, [&](const void *data, size_t length) {
+                if (stopping.load(std::memory_order_relaxed)) {
+                    throw std::runtime_error("Hashing cancelled");
+                }
+                SHA256Update(&context, static_cast<const uint8_t *>(data), length);
+            });
+        } catch (const std::exception &) {
+            return {};
+        }
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        SHA256Final(digest, &context);
+
+        static constexpr char k_hex[] = "0123456789abcdef";
+        std::string hex(SHA256_DIGEST_LENGTH * 2, '\0');
+        for (size_t i = 0; i < SHA256_DIGEST_LENGTH; ++i) {
+            hex[2 * i] = k_hex[digest[i] >> 4];
+            hex[2 * i + 1] = k_hex[digest[i] & 0x0f];
+        }
+        return hex;
+    }
+}
+
+std::vector<std::string> FileHasher::HashCandidates(
+        const std::vector<std::string> &paths,
+        const std::vector<int32_t> &groups
+) const {
+    if (paths.size() != groups.size()) {
+        throw std::invalid_argument("paths and groups must have the same length");
+    }
+    auto total = paths.size();
+    std::vector<std::string> results(total);
+    std::vector<uint64_t> prehashes(total);
+    std::unique_ptr<bool[]> readable(new bool[total]());
+    std::atomic<bool> stopping{false};
+    size_t processed = 0;
+
+    // 线程池在以上状态之前析构，保证任务不会访问已销毁的对象
+    ThreadPool pool(static_cast<size_t>(ResolveThreadCount(threads_)));
+
+    // 按提交顺序等待任务，等待期间在调用线程上汇报进度；回调抛出时令剩余任务直接返回
+    auto await_all = [&](std::vector<std::future<void>> &futures,
+                         const std::vector<size_t> &files, bool count_processed) {
+        try {
+            for (size_t i = 0; i < futures.size(); ++i) {
+                while (futures[i].wait_for(k_progress_interval) != std::future_status::ready) {
+                    if (listener_) listener_(paths[files[i]], processed, total);
+                }
+                futures[i].get();
+                if (count_processed) ++processed;
+                if (listener_) listener_(paths[files[i]], processed, total);
+            }
+        } catch (...) {
+            stopping.store(true, std::memory_order_relaxed);
+            throw;
+        }
+    };
+
+    // 第一阶段：预哈希
+    std::vector<size_t> files(total);
+    std::iota(files.begin(), files.end(), 0);
+    std::vector<std::future<void>> futures;
+    futures.reserve(total);
+    for (auto file: files) {
+        futures.push_back(pool.Submit([&, file]() {
+            if (stopping.load(std::memory_order_relaxed)) return;
+            readable[file] = PreHash(paths[file], prehashes[file]);
+        }));
+    }
+    await_all(futures, files, false);
+
+    // 同组内预哈希相同的文件才需要计算完整哈希
+    std::vector<size_t> order;
+    order.reserve(total);
+    for (size_t i = 0; i < total; ++i) {
+        if (readable[i]) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (groups[a] != groups[b]) return groups[a] < groups[b];
+        if (prehashes[a] != prehashes[b]) return prehashes[a] < prehashes[b];
+        return a < b;
+    });
+    files.clear();
+    for (size_t begin = 0; begin < order.size();) {
+        auto end = begin + 1;
+        while (end < order.size() && groups[order[end]] == groups[order[begin]] &&
+               prehashes[order[end]] == prehashes[order[begin]]) {
+            ++end;
+        }
+        if (end - begin > 1) files.insert(files.end(), order.begin() + begin, order.begin() + end);
+        begin = end;
+    }
+    std::sort(files.begin(), files.end());
+    processed = total - files.size();
+
+    // 第二阶段：完整 SHA-256
+    futures.clear();
+    for (auto file: files) {
+        futures.push_back(pool.Submit([&, file]() {
+            if (stopping.load(std::memory_order_relaxed)) return;
+            results[file] = Sha256Of(paths[file], stopping);
+        }));
+    }
+    await_all(futures, files, true);
+    return results;
+}
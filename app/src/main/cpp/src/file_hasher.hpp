@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * 查找重复文件使用的多线程哈希
+ * 候选文件按大小分组；先用 XXH64 计算首尾各 64 KiB 的预哈希，组内预哈希唯一的文件不可能与其它文件重复，
+ * 直接排除；其余文件在线程池上以大块 pread 读取并计算完整的 SHA-256
+ */
+class FileHasher {
+public:
+    /**
+     * @param processed 已确定结果（被排除或已完成 SHA-256）的文件数
+     */
+    using ProgressListener = std::function<void(const std::string &current_file,
+                                                size_t processed, size_t total)>;
+
+    /**
+     * 设置线程数，0 表示按 CPU 核心数自动选择
+     */
+    FileHasher &SetThreads(int32_t threads) {
+        threads_ = threads;
+        return *this;
+    }
+
+    /**
+     * 设置进度回调，始终在调用 HashCandidates 的线程上执行；通过抛出异常（如 OperationCancelledException）中止
+     */
+    FileHasher &SetListener(ProgressListener listener) {
+        listener_ = std::move(listener);
+        return *this;
+    }
+
+    /**
+     * @param paths 候选文件路径
+     * @param groups 每个文件所属的分组编号（同组文件大小相同），与 paths 一一对应
+     * @return 与 paths 一一对应的小写十六进制 SHA-256；被预哈希排除或读取失败的文件为空字符串
+     * @throw std::invalid_argument paths 与 groups 长度不一致
+     */
+    [[nodiscard]] std::vector<std::string> HashCandidates(
+            const std::vector<std::string> &paths,
+            const std::vector<int32_t> &groups
+    ) const;
+
+private:
+    int32_t threads_ = 0;
+    ProgressListener listener_;
+};
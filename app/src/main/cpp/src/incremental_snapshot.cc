@@ -0,0 +1,175 @@
+#include "incremental_snapshot.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+    constexpr char k_snapshot_magic[8] = {'A', 'R', 'C', 'H', 'S', 'N', 'P', '\0'};
+    constexpr uint32_t k_snapshot_version = 1;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_count;
+        uint64_t string_pool_size;
+    };
+
+    struct SnapshotRecord {
+        uint64_t name_offset;
+        uint32_t name_length;
+        uint32_t mode;
+        int64_t size;
+        int64_t mtime;
+        uint64_t ino;
+        int32_t mtime_nsec;
+        uint32_t reserved;
+    };
+
+    struct FdCloser {
+        int fd;
+
+        ~FdCloser() { if (fd >= 0) close(fd); }
+    };
+
+    bool WriteAll(int fd, const void *data, size_t len) {
+        auto ptr = static_cast<const uint8_t *>(data);
+        while (len > 0) {
+            auto n = write(fd, ptr, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            ptr += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool ReadAll(int fd, void *data, size_t len) {
+        auto ptr = static_cast<uint8_t *>(data);
+        while (len > 0) {
+            auto n = read(fd, ptr, len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            ptr += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+std::optional<IncrementalSnapshot> IncrementalSnapshot::Load(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return std::nullopt;
+        throw std::runtime_error("Cannot open incremental snapshot: " + path + ": " +
+                                 strerror(errno));
+    }
+    FdCloser closer{fd};
+
+    SnapshotHeader header{};
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || !ReadAll(fd, &header, sizeof(header)) ||
+        memcmp(header.magic, k_snapshot_magic, sizeof(k_snapshot_magic)) != 0 ||
+        header.version != k_snapshot_version) {
+        throw std::runtime_error("Invalid incremental snapshot: " + path);
+    }
+    auto records_size = uint64_t{header.record_count} * sizeof(SnapshotRecord);
+    if (static_cast<uint64_t>(st.st_size) !=
+        sizeof(header) + records_size + header.string_pool_size) {
+        throw std::runtime_error("Invalid incremental snapshot: " + path);
+    }
+    std::vector<SnapshotRecord> records(header.record_count);
+    std::string names(header.string_pool_size, '\0');
+    if (!ReadAll(fd, records.data(), records.size() * sizeof(SnapshotRecord)) ||
+        !ReadAll(fd, names.data(), names.size())) {
+        throw std::runtime_error("Cannot read incremental snapshot: " + path);
+    }
+
+    IncrementalSnapshot snapshot;
+    snapshot.records_.reserve(records.size());
+    for (const auto &record: records) {
+        if (record.name_offset > names.size() ||
+            record.name_length > names.size() - record.name_offset) {
+            throw std::runtime_error("Invalid incremental snapshot: " + path);
+        }
+        snapshot.records_.emplace(
+                names.substr(record.name_offset, record.name_length),
+                Record{record.mode, record.mtime_nsec, record.size, record.mtime, record.ino});
+    }
+    return snapshot;
+}
+
+IncrementalSnapshot IncrementalSnapshot::FromManifest(const ScanManifest &manifest) {
+    IncrementalSnapshot snapshot;
+    snapshot.records_.reserve(manifest.entries().size());
+    for (const auto &entry: manifest.entries()) {
+        snapshot.records_.insert_or_assign(
+                std::string(manifest.Name(entry)),
+                Record{static_cast<uint32_t>(entry.mode), entry.mtime_nsec, entry.size,
+                       entry.mtime, entry.ino});
+    }
+    return snapshot;
+}
+
+bool IncrementalSnapshot::IsUnchanged(
+        std::string_view name,
+        const ScanManifest::Entry &entry
+) const {
+    auto it = records_.find(std::string(name));
+    if (it == records_.end()) return false;
+    const auto &record = it->second;
+    return (record.mode & S_IFMT) == (entry.mode & S_IFMT) &&
+           record.size == entry.size &&
+           record.mtime == entry.mtime &&
+           record.mtime_nsec == entry.mtime_nsec &&
+           record.ino == entry.ino;
+}
+
+std::vector<std::string> IncrementalSnapshot::RemovedFrom(const ScanManifest &manifest) const {
+    std::unordered_set<std::string_view> present;
+    present.reserve(manifest.entries().size());
+    for (const auto &entry: manifest.entries()) present.insert(manifest.Name(entry));
+    std::vector<std::string> removed;
+    for (const auto &[name, record]: records_) {
+        if (!present.count(name)) removed.push_back(name);
+    }
+    std::sort(removed.begin(), removed.end());
+    return removed;
+}
+
+void IncrementalSnapshot::Save(const std::string &path) const {
+    std::vector<SnapshotRecord> records;
+    records.reserve(records_.size());
+    std::string names;
+    for (const auto &[name, record]: records_) {
+        records.push_back(SnapshotRecord{
+                names.size(), static_cast<uint32_t>(name.size()), record.mode, record.size,
+                record.mtime, record.ino, record.mtime_nsec, 0});
+        names += name;
+    }
+    SnapshotHeader header{};
+    memcpy(header.magic, k_snapshot_magic, sizeof(k_snapshot_magic));
+    header.version = k_snapshot_version;
+    header.record_count = static_cast<uint32_t>(records.size());
+    header.string_pool_size = names.size();
+
+    auto temp_path = path + ".tmp";
+    int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) throw std::runtime_error("Cannot create incremental snapshot: " + temp_path);
+    bool ok = WriteAll(fd, &header, sizeof(header)) &&
+              WriteAll(fd, records.data(), records.size() * sizeof(SnapshotRecord)) &&
+              WriteAll(fd, names.data(), names.size());
+    ok = (fsync(fd) == 0) && ok;
+    ok = (close(fd) == 0) && ok;
+    if (!ok || rename(temp_path.c_str(), path.c_str()) != 0) {
+        unlink(temp_path.c_str());
+        throw std::runtime_error("Cannot write incremental snapshot: " + path);
+    }
+}
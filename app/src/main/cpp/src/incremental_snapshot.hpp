@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "scan_manifest.hpp"
+
+/**
+ * 增量打包的快照文件（与 GNU tar 的 --listed-incremental 类似）
+ * 记录上一次打包时每个目录与常规文件的类型、大小、修改时间与 inode，
+ * 下一次打包只写出新增或发生变化的条目，已删除的条目记为墓碑
+ */
+class IncrementalSnapshot {
+public:
+    /**
+     * 读取快照文件，文件不存在时返回 std::nullopt（首次打包，写出全部条目）
+     * @throw std::runtime_error 文件无法读取或已损坏
+     */
+    static std::optional<IncrementalSnapshot> Load(const std::string &path);
+
+    /**
+     * 由本次扫描清单构建快照
+     */
+    static IncrementalSnapshot FromManifest(const ScanManifest &manifest);
+
+    /**
+     * 条目与快照中的记录相比没有变化（类型、大小、修改时间与 inode 均相同）
+     * 不比较设备号：部分文件系统（如 FUSE）的设备号在重新挂载后会改变
+     */
+    [[nodiscard]] bool IsUnchanged(std::string_view name, const ScanManifest::Entry &entry) const;
+
+    /**
+     * 快照中存在、本次扫描中已不存在的条目名称（按名称排序）
+     */
+    [[nodiscard]] std::vector<std::string> RemovedFrom(const ScanManifest &manifest) const;
+
+    /**
+     * 先写临时文件再原子替换
+     * @throw std::runtime_error 写入失败
+     */
+    void Save(const std::string &path) const;
+
+private:
+    struct Record {
+        uint32_t mode;
+        int32_t mtime_nsec;
+        int64_t size;
+        int64_t mtime;
+        uint64_t ino;
+    };
+
+    std::unordered_map<std::string, Record> records_;
+
+    IncrementalSnapshot() = default;
+};
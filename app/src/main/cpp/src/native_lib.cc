@@ -1,7 +1,9 @@
 
 #include <jni.h>
+#include <cstdlib>
 #include <vector>
 #include <string>
+#include <limits>
 #include <map>
 #include <algorithm>
 #include <filesystem>
@@ -10,14 +12,87 @@
 #include "native_logger.hpp"
 #include "utils/jni_utils.hpp"
 #include "utils/archive_utils.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/progress_throttle.hpp"
 #include "src/archive_builder.hpp"
 #include "src/archive_extractor.hpp"
+#include "src/archive_tree.hpp"
+#include "src/entry_listing.hpp"
+#include "src/file_hasher.hpp"
+#include "src/operation_stats.hpp"
 
 #define JNI_METHOD(cls, name) Java_cc_kafuu_archandler_libs_jni_##cls##_##name
 
 namespace internal {
     thread_local auto s_latest_error_message = std::string("none");
 
+    /**
+     * 将引擎的进度节流后转发给 Kotlin 的 NativeCallback，避免每个条目都跨越一次 JNI
+     */
+    class ProgressReporter {
+    public:
+        ProgressReporter(JNIEnv *env, jobject listener) : env_(env), listener_(listener) {}
+
+        /**
+         * @throw OperationCancelledException 操作已被取消
+         */
+        void Report(const std::string &path, size_t index, size_t total) {
+            if (!listener_) return;
+            throttle_.Report(path, index, total, [this](auto &&...args) { Emit(args...); });
+        }
+
+        /**
+         * 补发最后一条被合并的进度
+         * @throw OperationCancelledException 操作已被取消
+         */
+        void Flush() {
+            if (!listener_) return;
+            throttle_.Flush([this](auto &&...args) { Emit(args...); });
+        }
+
+    private:
+        JNIEnv *env_;
+        jobject listener_;
+        ProgressThrottle throttle_;
+
+        void Emit(const std::string &path, size_t index, size_t total) {
+            CallNativeCallback(env_, listener_, path, static_cast<jint>(index),
+                               static_cast<jint>(total));
+        }
+    };
+
+    /**
+     * Kotlin 持有的统计句柄，0 表示不统计
+     */
+    OperationStats *StatsFromHandle(jlong handle) {
+        return reinterpret_cast<OperationStats *>(static_cast<intptr_t>(handle));
+    }
+
+    /**
+     * 输出解压流水线的背压统计
+     */
+    void LogPipelineStats(const PipelineStats &stats) {
+        logger::debug(
+                "Extract pipeline: %llu chunks, %llu bytes, reader blocked %llu ms, "
+                "writer idle %llu ms, peak depth %zu/%zu",
+                static_cast<unsigned long long>(stats.chunks),
+                static_cast<unsigned long long>(stats.bytes),
+                static_cast<unsigned long long>(stats.reader_blocked_ns / 1000000),
+                static_cast<unsigned long long>(stats.writer_idle_ns / 1000000),
+                stats.peak_depth, stats.queue_capacity);
+    }
+
+    /**
+     * 背压统计只在调试构建中输出
+     */
+    PipelineStatsListener PipelineStatsLogger() {
+#ifdef NDEBUG
+        return nullptr;
+#else
+        return LogPipelineStats;
+#endif
+    }
+
     jboolean CreateArchive(
             JNIEnv *env,
             jstring output_path,
@@ -26,28 +101,40 @@ namespace internal {
             jobject listener,
             ArchiveFormat format = ArchiveFormat::TarPax,
             CompressionType compression = CompressionType::None,
-            jint compression_level = -1
+            jint compression_level = -1,
+            bool seekable = false,
+            jint threads = 1,
+            jlong stats_handle = 0,
+            jint checksum_algorithm = 0,
+            jstring checksum_path = nullptr,
+            jstring snapshot_path = nullptr,
+            bool deduplicate = false
     ) {
         auto builder = ArchiveBuilder(
                 JStringToCString(env, output_path),
                 JStringToCString(env, base_dir),
                 JStringListToCVector(env, input_files)
         );
-        builder.SetListener([=](const std::string &path, size_t index, size_t total) -> auto {
-            auto j_path = CreateJavaString(env, path);
-            auto j_index = CreateJavaInteger(env, static_cast<jint>(index));
-            auto j_total = CreateJavaInteger(env, static_cast<jint>(total));
-            auto params = std::vector<jobject>{j_path.get(), j_index.get(), j_total.get()};
-            // 如果检测到取消异常，会抛出 OperationCancelledException
-            CallNativeCallback(env, listener, params);
+        ProgressReporter reporter(env, listener);
+        builder.SetListener([&reporter](const std::string &path, size_t index, size_t total) {
+            // 如果检测到取消，会抛出 OperationCancelledException
+            reporter.Report(path, index, total);
         });
         builder.SetFormat(format);
         builder.SetCompression(compression);
         if (compression_level >= 0) {
             builder.SetCompressionLevel(compression_level);
         }
+        builder.SetSeekable(seekable);
+        builder.SetThreads(threads);
+        builder.SetStats(StatsFromHandle(stats_handle));
+        builder.SetChecksumManifest(static_cast<ChecksumAlgorithm>(checksum_algorithm),
+                                    JStringToCString(env, checksum_path));
+        builder.SetIncremental(JStringToCString(env, snapshot_path));
+        builder.SetDeduplicate(deduplicate);
         try {
             builder.Create();
+            reporter.Flush();
             return JNI_TRUE;
         } catch (const OperationCancelledException &) {
             // 操作被取消，这是正常情况，不需要记录错误
@@ -65,23 +152,36 @@ namespace internal {
             jstring archive_path,
             jstring output_dir,
             jobject listener,
-            bool overwrite = true
+            bool overwrite = true,
+            jstring index_dir = nullptr,
+            jint threads = 0,
+            bool pipelined = false,
+            jint small_file_writers = 1,
+            jlong stats_handle = 0,
+            jint checksum_algorithm = 0,
+            jstring checksum_path = nullptr
     ) {
         try {
             ArchiveExtractor extractor(JStringToCString(env, archive_path));
+            // 单遍处理，避免压缩流被完整解压两次
+            extractor.SetProgressMode(ArchiveExtractor::ProgressMode::CompressedBytes);
+            extractor.SetThreads(threads);
+            extractor.SetPipelined(pipelined, PipelineStatsLogger());
+            extractor.SetSmallFileWriters(small_file_writers);
+            extractor.SetIndexDirectory(JStringToCString(env, index_dir));
+            extractor.SetStats(StatsFromHandle(stats_handle));
+            extractor.SetChecksumManifest(static_cast<ChecksumAlgorithm>(checksum_algorithm),
+                                          JStringToCString(env, checksum_path));
+            ProgressReporter reporter(env, listener);
             extractor.Extract(
                     JStringToCString(env, output_dir),
-                    [=](const std::string &path, size_t index, size_t total) {
-                        if (!listener) return;
-                        auto j_path = CreateJavaString(env, path);
-                        auto j_index = CreateJavaInteger(env, static_cast<jint>(index));
-                        auto j_total = CreateJavaInteger(env, static_cast<jint>(total));
-                        std::vector<jobject> params{j_path.get(), j_index.get(), j_total.get()};
-                        // 如果检测到取消异常，会抛出 OperationCancelledException
-                        CallNativeCallback(env, listener, params);
+                    [&reporter](const std::string &path, size_t index, size_t total) {
+                        // 如果检测到取消，会抛出 OperationCancelledException
+                        reporter.Report(path, index, total);
                     },
                     overwrite
             );
+            reporter.Flush();
             return JNI_TRUE;
         } catch (const OperationCancelledException &) {
             // 操作被取消，这是正常情况，不需要记录错误
@@ -94,25 +194,120 @@ namespace internal {
         }
     }
 
+    /**
+     * 依次解压基础归档与各增量归档，并处理其中的墓碑条目
+     */
+    jboolean ExtractArchiveChain(
+            JNIEnv *env,
+            jstring base_path,
+            jobjectArray delta_paths,
+            jstring output_dir,
+            jobject listener,
+            jint threads = 0,
+            jint checksum_algorithm = 0,
+            jstring checksum_path = nullptr
+    ) {
+        try {
+            ArchiveExtractor extractor(JStringToCString(env, base_path));
+            extractor.SetProgressMode(ArchiveExtractor::ProgressMode::CompressedBytes);
+            extractor.SetThreads(threads);
+            extractor.SetChecksumManifest(static_cast<ChecksumAlgorithm>(checksum_algorithm),
+                                          JStringToCString(env, checksum_path));
+            ProgressReporter reporter(env, listener);
+            extractor.ExtractChain(
+                    JStringArrayToCVector(env, delta_paths),
+                    JStringToCString(env, output_dir),
+                    [&reporter](const std::string &path, size_t index, size_t total) {
+                        // 如果检测到取消，会抛出 OperationCancelledException
+                        reporter.Report(path, index, total);
+                    }
+            );
+            reporter.Flush();
+            return JNI_TRUE;
+        } catch (const OperationCancelledException &) {
+            s_latest_error_message = "Operation cancelled";
+            return JNI_FALSE;
+        } catch (const std::exception &exception) {
+            s_latest_error_message = exception.what();
+            logger::error("ExtractArchiveChain failed: %s", exception.what());
+            return JNI_FALSE;
+        }
+    }
+
+    jboolean ExtractArchiveEntries(
+            JNIEnv *env,
+            jstring archive_path,
+            jstring output_dir,
+            jobjectArray entry_paths,
+            jobjectArray include_patterns,
+            jobjectArray exclude_patterns,
+            jobject listener,
+            bool overwrite,
+            jstring index_dir,
+            jint threads,
+            bool pipelined,
+            jint small_file_writers,
+            jlong stats_handle
+    ) {
+        try {
+            ArchiveExtractor extractor(JStringToCString(env, archive_path));
+            extractor.SetProgressMode(ArchiveExtractor::ProgressMode::CompressedBytes);
+            extractor.SetThreads(threads);
+            extractor.SetPipelined(pipelined, PipelineStatsLogger());
+            extractor.SetSmallFileWriters(small_file_writers);
+            extractor.SetIndexDirectory(JStringToCString(env, index_dir));
+            extractor.SetStats(StatsFromHandle(stats_handle));
+            EntrySelector selector(
+                    JStringArrayToCVector(env, entry_paths),
+                    JStringArrayToCVector(env, include_patterns),
+                    JStringArrayToCVector(env, exclude_patterns)
+            );
+            ProgressReporter reporter(env, listener);
+            extractor.ExtractEntries(
+                    JStringToCString(env, output_dir),
+                    std::move(selector),
+                    [&reporter](const std::string &path, size_t index, size_t total) {
+                        // 如果检测到取消，会抛出 OperationCancelledException
+                        reporter.Report(path, index, total);
+                    },
+                    overwrite
+            );
+            reporter.Flush();
+            return JNI_TRUE;
+        } catch (const OperationCancelledException &) {
+            s_latest_error_message = "Operation cancelled";
+            return JNI_FALSE;
+        } catch (const std::exception &exception) {
+            s_latest_error_message = exception.what();
+            logger::error("ExtractArchiveEntries failed: %s", exception.what());
+            return JNI_FALSE;
+        }
+    }
+
     jobject TestArchive(
             JNIEnv *env,
             jobject thiz,
             jstring archive_path,
-            jobject listener
+            jobject listener,
+            jstring index_dir,
+            jint threads,
+            jlong stats_handle
     ) {
         auto c_archive_path = JStringToCString(env, archive_path);
         try {
             ArchiveExtractor extractor(c_archive_path);
+            extractor.SetProgressMode(ArchiveExtractor::ProgressMode::CompressedBytes);
+            extractor.SetThreads(threads);
+            extractor.SetIndexDirectory(JStringToCString(env, index_dir));
+            extractor.SetStats(StatsFromHandle(stats_handle));
 
-            auto result = extractor.Test([=](const std::string &path, size_t index, size_t total) {
-                if (!listener) return;
-                auto j_path = CreateJavaString(env, path);
-                auto j_index = CreateJavaInteger(env, static_cast<jint>(index));
-                auto j_total = CreateJavaInteger(env, static_cast<jint>(total));
-                std::vector<jobject> params{j_path.get(), j_index.get(), j_total.get()};
-                // 如果检测到取消异常，会抛出 OperationCancelledException
-                CallNativeCallback(env, listener, params);
-            });
+            ProgressReporter reporter(env, listener);
+            auto result = extractor.Test(
+                    [&reporter](const std::string &path, size_t index, size_t total) {
+                        // 如果检测到取消，会抛出 OperationCancelledException
+                        reporter.Report(path, index, total);
+                    });
+            reporter.Flush();
 
             return CreateArchiveTestResult(
                     env,
@@ -136,42 +331,179 @@ namespace internal {
         }
     }
 
-    jobjectArray ListArchiveFiles(JNIEnv *env, jobject thiz, jstring archive_path) {
+    /**
+     * 将 EntryListing 编码到 malloc 分配的内存并包装为直接 ByteBuffer，
+     * 由 Kotlin 端通过 releaseArchiveListing 释放
+     * @throw std::runtime_error 分配失败
+     */
+    jobject CreateListingBuffer(JNIEnv *env, const EntryListing &listing) {
+        std::unique_ptr<void, decltype(&free)> buffer(
+                malloc(std::max<size_t>(1, listing.EncodedSize())), &free);
+        if (!buffer) throw std::runtime_error("Failed to allocate entry listing");
+        listing.EncodeTo(buffer.get());
+        auto result = env->NewDirectByteBuffer(
+                buffer.get(), static_cast<jlong>(listing.EncodedSize()));
+        if (!result) {
+            env->ExceptionClear();
+            throw std::runtime_error("Failed to create entry listing buffer");
+        }
+        buffer.release();
+        return result;
+    }
+
+    /**
+     * 以 EntryListing 格式列出全部条目
+     */
+    jobject ListArchiveFiles(
+            JNIEnv *env,
+            jobject thiz,
+            jstring archive_path,
+            jstring index_dir
+    ) {
         auto c_archive_path = JStringToCString(env, archive_path);
         try {
             ArchiveExtractor extractor(c_archive_path);
-            auto list_entity = extractor.ListEntry();
-            auto entry_map = BuildCompleteEntryMap(list_entity);
-            auto mapper = [&](const auto &pair) {
-                const auto &[pathname, entity] = pair;
-                bool is_directory = (entity.mode == AE_IFDIR);
-                std::string name = ExtractNameFromPath(pathname, is_directory);
-                int64_t entry_size = is_directory ? 0 : std::max<int64_t>(0, entity.entry_size);
-                return CreateArchiveEntry(
-                        env, pathname, name, is_directory, entry_size, entry_size,
-                        entity.modify_time_ms
-                );
-            };
-            auto result_array = CreateJObjectArray(
-                    env, "cc/kafuu/archandler/libs/archive/model/ArchiveEntry",
-                    entry_map.cbegin(), entry_map.cend(), mapper
-            );
-            if (!result_array) {
-                if (s_latest_error_message.empty()) {
-                    s_latest_error_message = "Failed to create array or convert entries";
+            extractor.SetIndexDirectory(JStringToCString(env, index_dir));
+            auto trie = BuildEntryTrie(extractor.ListEntry());
+            EntryListing listing;
+            trie.VisitDepthFirst([&](uint32_t node, std::string_view path) {
+                const auto &entry = trie.At(node);
+                listing.Add(path, entry.is_directory, entry.size, entry.compressed_size,
+                            entry.modify_time_ms);
+            });
+            return CreateListingBuffer(env, listing);
+        } catch (const std::exception &exception) {
+            s_latest_error_message = exception.what();
+            logger::error("ListArchiveFiles exception: %s", exception.what());
+            return nullptr;
+        }
+    }
+
+    ArchiveTree *TreeFromHandle(jlong handle) {
+        return reinterpret_cast<ArchiveTree *>(static_cast<intptr_t>(handle));
+    }
+
+    /**
+     * 列出全部条目并构建目录树
+     * @param listener 不为空时在读取过程中分块推送新读到的条目（EntryListing 格式，路径已标准化）
+     * @return 目录树句柄，失败或被取消时返回0
+     */
+    jlong OpenArchiveTree(JNIEnv *env, jstring archive_path, jstring index_dir, jobject listener) {
+        auto c_archive_path = JStringToCString(env, archive_path);
+        try {
+            ArchiveExtractor extractor(c_archive_path);
+            extractor.SetIndexDirectory(JStringToCString(env, index_dir));
+            std::vector<uint8_t> chunk_buffer;
+            auto on_chunk = [&](const ArchiveExtractor::ArchiveEntry *entries, size_t count) {
+                EntryListing listing;
+                for (size_t i = 0; i < count; ++i) {
+                    const auto &entity = entries[i];
+                    auto pathname = NormalizePath(entity.pathname);
+                    if (pathname.empty()) continue;
+                    bool is_directory = (entity.mode == AE_IFDIR);
+                    int64_t entry_size = is_directory ? 0 : std::max<int64_t>(0, entity.entry_size);
+                    int64_t compressed_size = is_directory ? 0
+                            : entity.compressed_size >= 0 ? entity.compressed_size : entry_size;
+                    listing.Add(pathname, is_directory, entry_size, compressed_size,
+                                entity.modify_time_ms);
                 }
-                logger::error("ListArchiveFiles error: %s", s_latest_error_message.c_str());
+                if (listing.size() == 0) return;
+                chunk_buffer.resize(listing.EncodedSize());
+                listing.EncodeTo(chunk_buffer.data());
+                CallNativeListingCallback(env, listener, chunk_buffer.data(), chunk_buffer.size());
+            };
+            auto entries = listener ? extractor.ListEntry(on_chunk) : extractor.ListEntry();
+            auto tree = new ArchiveTree(BuildEntryTrie(entries));
+            return static_cast<jlong>(reinterpret_cast<intptr_t>(tree));
+        } catch (const OperationCancelledException &) {
+            s_latest_error_message = "Operation cancelled";
+            return 0;
+        } catch (const std::exception &exception) {
+            s_latest_error_message = exception.what();
+            logger::error("OpenArchiveTree exception: %s", exception.what());
+            return 0;
+        }
+    }
+
+    /**
+     * 以 EntryListing 格式返回目录下的一页子项
+     */
+    jobject ListArchiveTree(
+            JNIEnv *env,
+            jlong handle,
+            jstring dir,
+            ArchiveTree::SortOrder order,
+            jint offset,
+            jint limit
+    ) {
+        auto tree = TreeFromHandle(handle);
+        if (!tree || offset < 0 || limit < 0) {
+            s_latest_error_message = "Invalid archive tree request";
+            return nullptr;
+        }
+        try {
+            EntryListing listing;
+            auto c_dir = JStringToCString(env, dir);
+            if (!tree->ListChildren(c_dir, order, static_cast<size_t>(offset),
+                                    static_cast<size_t>(limit), listing)) {
+                s_latest_error_message = "Directory not found: " + c_dir;
                 return nullptr;
             }
-            return result_array.release();
+            return CreateListingBuffer(env, listing);
         } catch (const std::exception &exception) {
             s_latest_error_message = exception.what();
-            logger::error("ListArchiveFiles exception: %s", exception.what());
+            logger::error("ListArchiveTree exception: %s", exception.what());
+            return nullptr;
+        }
+    }
+
+    /**
+     * 计算查找重复文件的候选文件的 SHA-256
+     * @return 与 paths 一一对应的哈希数组（被排除或读取失败的文件为空字符串），失败或被取消时返回nullptr
+     */
+    jobjectArray HashDuplicateCandidates(
+            JNIEnv *env,
+            jobjectArray paths,
+            jintArray groups,
+            jobject listener,
+            jint threads
+    ) {
+        try {
+            ProgressReporter reporter(env, listener);
+            auto hashes = FileHasher()
+                    .SetThreads(threads)
+                    .SetListener([&reporter](const std::string &path, size_t processed, size_t total) {
+                        // 如果检测到取消，会抛出 OperationCancelledException
+                        reporter.Report(path, processed, total);
+                    })
+                    .HashCandidates(JStringArrayToCVector(env, paths), JIntArrayToCVector(env, groups));
+            reporter.Flush();
+            return CreateJStringArray(env, hashes.cbegin(), hashes.cend()).release();
+        } catch (const OperationCancelledException &) {
+            s_latest_error_message = "Operation cancelled";
+            return nullptr;
+        } catch (const std::exception &exception) {
+            s_latest_error_message = exception.what();
+            logger::error("HashDuplicateCandidates exception: %s", exception.what());
             return nullptr;
         }
     }
 }
 
+extern "C"
+JNIEXPORT jint JNICALL
+JNI_OnLoad(JavaVM *vm, void *reserved) {
+    JNIEnv *env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) return JNI_ERR;
+    // 缓存回调相关的类与方法 ID，避免每次回调时查找
+    if (!InitJniCache(env)) {
+        env->ExceptionClear();
+        logger::error("JNI_OnLoad: failed to cache class or method IDs");
+        return JNI_ERR;
+    }
+    return JNI_VERSION_1_6;
+}
+
 extern "C"
 JNIEXPORT jstring JNICALL
 JNI_METHOD(NativeLib, getLatestErrorMessage)(JNIEnv *env, jobject thiz) {
@@ -189,13 +521,27 @@ JNI_METHOD(NativeLib, createArchive)(
         jint format,
         jint compression,
         jint compression_level,
-        jobject listener
+        jobject listener,
+        jboolean seekable,
+        jint threads,
+        jlong stats_handle,
+        jint checksum_algorithm,
+        jstring checksum_path,
+        jstring snapshot_path,
+        jboolean deduplicate
 ) {
     return internal::CreateArchive(
             env, output_path, base_dir, input_files, listener,
             static_cast<ArchiveFormat>(format),
             static_cast<CompressionType>(compression),
-            compression_level
+            compression_level,
+            seekable,
+            threads,
+            stats_handle,
+            checksum_algorithm,
+            checksum_path,
+            snapshot_path,
+            deduplicate
     );
 }
 
@@ -207,28 +553,194 @@ JNI_METHOD(NativeLib, extractArchive)(
         jstring archive_path,
         jstring output_dir,
         jobject listener,
-        jboolean overwrite
+        jboolean overwrite,
+        jstring index_dir,
+        jint threads,
+        jboolean pipelined,
+        jint small_file_writers,
+        jlong stats_handle,
+        jint checksum_algorithm,
+        jstring checksum_path
 ) {
-    return internal::ExtractArchive(env, archive_path, output_dir, listener, overwrite);
+    return internal::ExtractArchive(
+            env, archive_path, output_dir, listener, overwrite, index_dir, threads, pipelined,
+            small_file_writers, stats_handle, checksum_algorithm, checksum_path
+    );
 }
 
 extern "C"
-JNIEXPORT jobjectArray JNICALL
-JNI_METHOD(NativeLib, fetchArchiveFiles)(
+JNIEXPORT jboolean JNICALL
+JNI_METHOD(NativeLib, extractArchiveChain)(
         JNIEnv *env,
         jobject thiz,
-        jstring archive_path
+        jstring base_path,
+        jobjectArray delta_paths,
+        jstring output_dir,
+        jobject listener,
+        jint threads,
+        jint checksum_algorithm,
+        jstring checksum_path
+) {
+    return internal::ExtractArchiveChain(env, base_path, delta_paths, output_dir, listener,
+                                         threads, checksum_algorithm, checksum_path);
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+JNI_METHOD(NativeLib, extractArchiveEntries)(
+        JNIEnv *env,
+        jobject thiz,
+        jstring archive_path,
+        jstring output_dir,
+        jobjectArray entry_paths,
+        jobjectArray include_patterns,
+        jobjectArray exclude_patterns,
+        jobject listener,
+        jboolean overwrite,
+        jstring index_dir,
+        jint threads,
+        jboolean pipelined,
+        jint small_file_writers,
+        jlong stats_handle
 ) {
-    return internal::ListArchiveFiles(env, thiz, archive_path);
+    return internal::ExtractArchiveEntries(
+            env, archive_path, output_dir, entry_paths, include_patterns, exclude_patterns,
+            listener, overwrite, index_dir, threads, pipelined, small_file_writers, stats_handle
+    );
 }
 
 extern "C"
 JNIEXPORT jobject JNICALL
-JNI_METHOD(NativeLib, testArchive)(
+JNI_METHOD(NativeLib, fetchArchiveListing)(
+        JNIEnv *env,
+        jobject thiz,
+        jstring archive_path,
+        jstring index_dir
+) {
+    return internal::ListArchiveFiles(env, thiz, archive_path, index_dir);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+JNI_METHOD(NativeLib, openArchiveTree)(
         JNIEnv *env,
         jobject thiz,
         jstring archive_path,
+        jstring index_dir,
         jobject listener
 ) {
-    return internal::TestArchive(env, thiz, archive_path, listener);
+    return internal::OpenArchiveTree(env, archive_path, index_dir, listener);
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+JNI_METHOD(NativeLib, archiveTreeChildCount)(JNIEnv *env, jobject thiz, jlong handle, jstring dir) {
+    auto tree = internal::TreeFromHandle(handle);
+    if (!tree) return -1;
+    auto count = tree->ChildCount(JStringToCString(env, dir));
+    if (!count) return -1;
+    return static_cast<jint>(std::min<size_t>(*count, std::numeric_limits<jint>::max()));
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+JNI_METHOD(NativeLib, listArchiveTree)(
+        JNIEnv *env,
+        jobject thiz,
+        jlong handle,
+        jstring dir,
+        jint sort_key,
+        jboolean descending,
+        jboolean directories_first,
+        jint offset,
+        jint limit
+) {
+    ArchiveTree::SortOrder order{
+            .key = sort_key >= 0 && sort_key <= static_cast<jint>(ArchiveTree::SortKey::ModifyTime)
+                   ? static_cast<ArchiveTree::SortKey>(sort_key) : ArchiveTree::SortKey::Name,
+            .descending = descending == JNI_TRUE,
+            .directories_first = directories_first == JNI_TRUE
+    };
+    return internal::ListArchiveTree(env, handle, dir, order, offset, limit);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+JNI_METHOD(NativeLib, releaseArchiveTree)(JNIEnv *env, jobject thiz, jlong handle) {
+    delete internal::TreeFromHandle(handle);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+JNI_METHOD(NativeLib, releaseArchiveListing)(JNIEnv *env, jobject thiz, jobject buffer) {
+    if (!buffer) return;
+    free(env->GetDirectBufferAddress(buffer));
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+JNI_METHOD(NativeLib, testArchive)(
+        JNIEnv *env,
+        jobject thiz,
+        jstring archive_path,
+        jobject listener,
+        jstring index_dir,
+        jint threads,
+        jlong stats_handle
+) {
+    return internal::TestArchive(env, thiz, archive_path, listener, index_dir, threads, stats_handle);
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+JNI_METHOD(NativeLib, hashDuplicateCandidates)(
+        JNIEnv *env,
+        jobject thiz,
+        jobjectArray paths,
+        jintArray groups,
+        jobject listener,
+        jint threads
+) {
+    return internal::HashDuplicateCandidates(env, paths, groups, listener, threads);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+JNI_METHOD(NativeLib, createStats)(JNIEnv *env, jobject thiz) {
+    return static_cast<jlong>(reinterpret_cast<intptr_t>(new OperationStats()));
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+JNI_METHOD(NativeLib, pollStats)(JNIEnv *env, jobject thiz, jlong handle, jlongArray out) {
+    auto stats = internal::StatsFromHandle(handle);
+    if (!stats || !out) return JNI_FALSE;
+    auto snapshot = stats->Poll();
+    // 字段顺序需与 Kotlin 端 NativeStats.Snapshot 保持一致
+    jlong values[] = {
+            static_cast<jlong>(snapshot.total_bytes),
+            static_cast<jlong>(snapshot.progress_bytes),
+            static_cast<jlong>(snapshot.bytes_read),
+            static_cast<jlong>(snapshot.bytes_written),
+            static_cast<jlong>(snapshot.compressed_bytes),
+            static_cast<jlong>(snapshot.files),
+            static_cast<jlong>(snapshot.elapsed_ms),
+            static_cast<jlong>(snapshot.bytes_per_second),
+            static_cast<jlong>(snapshot.eta_ms),
+            static_cast<jlong>(snapshot.codec_ms),
+            static_cast<jlong>(snapshot.io_ms),
+            static_cast<jlong>(snapshot.metadata_ms),
+            static_cast<jlong>(snapshot.deduplicated_bytes),
+            static_cast<jlong>(snapshot.dedup_ms)
+    };
+    constexpr auto count = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    if (env->GetArrayLength(out) < count) return JNI_FALSE;
+    env->SetLongArrayRegion(out, 0, count, values);
+    return JNI_TRUE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+JNI_METHOD(NativeLib, releaseStats)(JNIEnv *env, jobject thiz, jlong handle) {
+    delete internal::StatsFromHandle(handle);
 }
\ No newline at end of file
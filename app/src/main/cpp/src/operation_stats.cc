@@ -0,0 +1,77 @@
+#include "operation_stats.hpp"
+
+#include <algorithm>
+
+namespace {
+    // 计算速度的最小采样窗口，轮询过于频繁时沿用上一次的结果
+    constexpr int64_t k_min_sample_window_ns = 250 * 1000 * 1000;
+
+    int64_t NowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+void OperationStats::Begin(uint64_t total_bytes, Basis basis) {
+    total_bytes_.store(total_bytes, std::memory_order_relaxed);
+    basis_.store(basis, std::memory_order_relaxed);
+    bytes_read_.store(0, std::memory_order_relaxed);
+    bytes_written_.store(0, std::memory_order_relaxed);
+    compressed_bytes_.store(0, std::memory_order_relaxed);
+    files_.store(0, std::memory_order_relaxed);
+    deduplicated_bytes_.store(0, std::memory_order_relaxed);
+    for (auto &phase: phase_ns_) phase.store(0, std::memory_order_relaxed);
+    finished_.store(false, std::memory_order_relaxed);
+    start_ns_.store(NowNanos(), std::memory_order_release);
+}
+
+OperationStats::Snapshot OperationStats::Poll() {
+    Snapshot snapshot{};
+    snapshot.eta_ms = -1;
+    auto start = start_ns_.load(std::memory_order_acquire);
+    if (start == 0) return snapshot;
+    auto finished = finished_.load(std::memory_order_acquire);
+
+    snapshot.total_bytes = total_bytes_.load(std::memory_order_relaxed);
+    snapshot.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    snapshot.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    snapshot.compressed_bytes = compressed_bytes_.load(std::memory_order_relaxed);
+    snapshot.files = files_.load(std::memory_order_relaxed);
+    snapshot.codec_ms = phase_ns_[static_cast<size_t>(Phase::Codec)] / 1000000;
+    snapshot.io_ms = phase_ns_[static_cast<size_t>(Phase::Io)] / 1000000;
+    snapshot.metadata_ms = phase_ns_[static_cast<size_t>(Phase::Metadata)] / 1000000;
+    snapshot.deduplicated_bytes = deduplicated_bytes_.load(std::memory_order_relaxed);
+    snapshot.dedup_ms = phase_ns_[static_cast<size_t>(Phase::Dedup)] / 1000000;
+    snapshot.progress_bytes = basis_.load(std::memory_order_relaxed) == Basis::CompressedBytes
+                              ? snapshot.compressed_bytes : snapshot.bytes_read;
+    if (finished) snapshot.progress_bytes = std::max(snapshot.progress_bytes, snapshot.total_bytes);
+
+    auto now = NowNanos();
+    snapshot.elapsed_ms = static_cast<uint64_t>(now - start) / 1000000;
+
+    std::lock_guard<std::mutex> lock(poll_mutex_);
+    // 新的操作开始后重新采样
+    if (sample_ns_ < start) {
+        sample_ns_ = start;
+        sample_bytes_ = 0;
+        bytes_per_second_ = 0;
+    }
+    auto window = now - sample_ns_;
+    if (window >= k_min_sample_window_ns && snapshot.progress_bytes >= sample_bytes_) {
+        bytes_per_second_ = static_cast<uint64_t>(
+                static_cast<double>(snapshot.progress_bytes - sample_bytes_) * 1e9 /
+                static_cast<double>(window));
+        sample_ns_ = now;
+        sample_bytes_ = snapshot.progress_bytes;
+    }
+    snapshot.bytes_per_second = bytes_per_second_;
+
+    if (finished || (snapshot.total_bytes > 0 && snapshot.progress_bytes >= snapshot.total_bytes)) {
+        snapshot.eta_ms = 0;
+    } else if (snapshot.total_bytes > 0 && bytes_per_second_ > 0) {
+        snapshot.eta_ms = static_cast<int64_t>(
+                static_cast<double>(snapshot.total_bytes - snapshot.progress_bytes) * 1000.0 /
+                static_cast<double>(bytes_per_second_));
+    }
+    return snapshot;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * 打包/解压过程中的字节级统计，由引擎的热循环更新，可被其它线程随时轮询
+ * 各计数使用 relaxed 原子操作，轮询得到的是近似一致的快照
+ */
+class OperationStats {
+public:
+    /**
+     * 耗时分类：压缩/解压、数据读写、元数据（目录遍历、header、创建文件与设置属性）、
+     * 打包去重时查找重复文件（调用线程的实际耗时）
+     * 多线程时为各线程耗时之和
+     */
+    enum class Phase {
+        Codec, Io, Metadata, Dedup
+    };
+
+    /**
+     * 进度依据：打包按已读取的源文件字节，解压按已消耗的压缩字节
+     */
+    enum class Basis {
+        BytesRead, CompressedBytes
+    };
+
+    struct Snapshot {
+        uint64_t total_bytes;
+        uint64_t progress_bytes;
+        uint64_t bytes_read;
+        uint64_t bytes_written;
+        uint64_t compressed_bytes;
+        uint64_t files;
+        uint64_t elapsed_ms;
+        // 最近一个轮询窗口内按进度依据计算的速度
+        uint64_t bytes_per_second;
+        // 剩余时间，无法估算时为 -1
+        int64_t eta_ms;
+        uint64_t codec_ms;
+        uint64_t io_ms;
+        uint64_t metadata_ms;
+        // 打包去重时写为硬链接、未写出数据的字节数
+        uint64_t deduplicated_bytes;
+        uint64_t dedup_ms;
+    };
+
+    /**
+     * 计时作用域，stats 为空时不做任何事
+     */
+    class ScopedPhase {
+    public:
+        ScopedPhase(OperationStats *stats, Phase phase) : stats_(stats), phase_(phase) {
+            if (stats_) start_ = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedPhase() {
+            if (!stats_) return;
+            stats_->AddPhaseNanos(phase_, static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start_).count()));
+        }
+
+        ScopedPhase(const ScopedPhase &) = delete;
+
+        ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+    private:
+        OperationStats *stats_;
+        Phase phase_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * 开始一次操作，重置所有计数
+     * @param total_bytes 进度依据的总字节数，未知时为0
+     */
+    void Begin(uint64_t total_bytes, Basis basis);
+
+    void SetTotalBytes(uint64_t total_bytes) {
+        total_bytes_.store(total_bytes, std::memory_order_relaxed);
+    }
+
+    void AddBytesRead(uint64_t bytes) { bytes_read_.fetch_add(bytes, std::memory_order_relaxed); }
+
+    void AddBytesWritten(uint64_t bytes) {
+        bytes_written_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void SetCompressedBytes(uint64_t bytes) {
+        compressed_bytes_.store(bytes, std::memory_order_relaxed);
+    }
+
+    void AddFile() { files_.fetch_add(1, std::memory_order_relaxed); }
+
+    void AddDeduplicatedBytes(uint64_t bytes) {
+        deduplicated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void AddPhaseNanos(Phase phase, uint64_t nanos) {
+        phase_ns_[static_cast<size_t>(phase)].fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    /**
+     * 标记操作成功结束：进度视为已达总量，ETA 为0
+     * 归档尾部的填充等不会计入进度字节，结束时由此补齐
+     */
+    void Finish() { finished_.store(true, std::memory_order_release); }
+
+    /**
+     * 读取当前快照，并以距上次轮询的增量更新速度
+     */
+    Snapshot Poll();
+
+private:
+    static constexpr size_t k_phase_count = 4;
+
+    std::atomic<uint64_t> total_bytes_{0};
+    std::atomic<Basis> basis_{Basis::BytesRead};
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> compressed_bytes_{0};
+    std::atomic<uint64_t> files_{0};
+    std::atomic<uint64_t> deduplicated_bytes_{0};
+    std::atomic<uint64_t> phase_ns_[k_phase_count]{};
+    std::atomic<int64_t> start_ns_{0};
+    std::atomic<bool> finished_{false};
+
+    // 速度采样状态，仅在 Poll 中使用
+    std::mutex poll_mutex_;
+    int64_t sample_ns_ = 0;
+    uint64_t sample_bytes_ = 0;
+    uint64_t bytes_per_second_ = 0;
+};
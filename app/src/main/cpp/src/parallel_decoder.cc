@@ -0,0 +1,554 @@
+#include "parallel_decoder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <bzlib.h>
+#include <lzma.h>
+#include <zlib.h>
+
+#define ZSTD_STATIC_LINKING_ONLY
+
+#include <zstd.h>
+
+#include "seekable_format.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace {
+    using Block = std::vector<uint8_t>;
+
+    // 单个并行段解压后的最大大小，超过时不并行以免占用过多内存
+    constexpr uint64_t k_max_segment_output = 64ULL << 20;
+    // 同时驻留内存的解压结果总量上限（含正交给 libarchive 的段）
+    constexpr uint64_t k_max_in_flight_output = 256ULL << 20;
+    constexpr size_t k_xz_buffer_size = 1 << 20;
+    constexpr size_t k_stream_chunk_size = 1 << 20;
+
+    struct Segment {
+        size_t offset;
+        size_t size;
+        // 解压后大小的上限（bzip2 为块大小的预估值，可能被超出）
+        uint64_t output_bound;
+    };
+
+    /**
+     * 解压一个段到 output，解压结果超过 limit 时返回false
+     */
+    using SegmentDecoder = bool (*)(const uint8_t *data, size_t size, uint64_t limit, Block &output);
+
+    /**
+     * 在读取线程中逐块解压一个段，用于解压结果超出预估大小、不适合整段缓存的段
+     */
+    class SegmentStream {
+    public:
+        virtual ~SegmentStream() = default;
+
+        /**
+         * 解压下一块到 output，段结束时返回0
+         * @throw std::runtime_error 解压失败
+         */
+        virtual size_t Read(uint8_t *output, size_t capacity) = 0;
+    };
+
+    using SegmentStreamFactory = std::unique_ptr<SegmentStream> (*)(const uint8_t *data, size_t size);
+
+    uint64_t DecoderMemoryLimit() {
+        auto pages = sysconf(_SC_PHYS_PAGES);
+        auto page_size = sysconf(_SC_PAGESIZE);
+        if (pages <= 0 || page_size <= 0) return 256ULL << 20;
+        return static_cast<uint64_t>(pages) * static_cast<uint64_t>(page_size) / 4;
+    }
+
+    uint64_t InFlightOutputLimit() {
+        // 至少容纳正在读取的段和一个待解压的最大段，保证总能继续推进
+        return std::clamp(DecoderMemoryLimit() / 2, k_max_segment_output * 2, k_max_in_flight_output);
+    }
+
+    /**
+     * xz 流式多线程解压，不满足并行条件的 block 由 liblzma 自行单线程处理
+     */
+    class XzDecoder : public ParallelDecoder {
+    public:
+        XzDecoder(const std::string &archive_path, int32_t threads)
+                : in_(k_xz_buffer_size), out_(k_xz_buffer_size) {
+            fd_ = open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd_ < 0) {
+                throw std::runtime_error(
+                        "Failed to open archive: " + archive_path + ": " + strerror(errno));
+            }
+            lzma_mt mt{};
+            mt.threads = static_cast<uint32_t>(threads);
+            mt.flags = LZMA_CONCATENATED;
+            mt.memlimit_threading = DecoderMemoryLimit();
+            mt.memlimit_stop = UINT64_MAX;
+            if (lzma_stream_decoder_mt(&stream_, &mt) != LZMA_OK) {
+                throw std::runtime_error("Failed to initialize xz decoder");
+            }
+        }
+
+        ~XzDecoder() override {
+            lzma_end(&stream_);
+            if (fd_ >= 0) close(fd_);
+        }
+
+        [[nodiscard]] int64_t ConsumedBytes() const override {
+            return static_cast<int64_t>(stream_.total_in);
+        }
+
+    protected:
+        size_t Read(const void **buffer) override {
+            stream_.next_out = out_.data();
+            stream_.avail_out = out_.size();
+            while (!finished_ && stream_.avail_out == out_.size()) {
+                if (stream_.avail_in == 0 && !eof_) FillInput();
+                auto ret = lzma_code(&stream_, eof_ ? LZMA_FINISH : LZMA_RUN);
+                if (ret == LZMA_STREAM_END) {
+                    finished_ = true;
+                } else if (ret != LZMA_OK) {
+                    throw std::runtime_error(
+                            "xz decompression failed: " + std::to_string(static_cast<int>(ret)));
+                }
+            }
+            *buffer = out_.data();
+            return out_.size() - stream_.avail_out;
+        }
+
+    private:
+        int fd_ = -1;
+        lzma_stream stream_ = LZMA_STREAM_INIT;
+        std::vector<uint8_t> in_;
+        std::vector<uint8_t> out_;
+        bool eof_ = false;
+        bool finished_ = false;
+
+        void FillInput() {
+            ssize_t n;
+            do {
+                n = read(fd_, in_.data(), in_.size());
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) throw std::runtime_error(std::string("Read failed: ") + strerror(errno));
+            eof_ = n == 0;
+            stream_.next_in = in_.data();
+            stream_.avail_in = static_cast<size_t>(n);
+        }
+    };
+
+    /**
+     * 将映射后的文件切分为互相独立的段，在线程池中解压并按顺序输出
+     * 同时解压的段数与解压结果的总大小都受限，避免大量段同时驻留内存
+     */
+    class SegmentedDecoder : public ParallelDecoder {
+    public:
+        SegmentedDecoder(
+                MappedFile file,
+                std::vector<Segment> segments,
+                SegmentDecoder decoder,
+                SegmentStreamFactory stream_factory,
+                int32_t threads
+        ) : file_(std::move(file)),
+            segments_(std::move(segments)),
+            decoder_(decoder),
+            stream_factory_(stream_factory),
+            max_in_flight_(static_cast<size_t>(threads) * 2),
+            max_in_flight_output_(InFlightOutputLimit()),
+            pool_(static_cast<size_t>(threads)) {}
+
+        ~SegmentedDecoder() override {
+            // 任务引用了映射内存，需在 file_ 释放前全部结束
+            for (auto &pending: pending_) pending.wait();
+        }
+
+        [[nodiscard]] int64_t ConsumedBytes() const override { return consumed_; }
+
+    protected:
+        size_t Read(const void **buffer) override {
+            // 返回0会被 libarchive 视为结束，因此跳过解压结果为空的段
+            while (true) {
+                if (stream_) {
+                    current_.resize(k_stream_chunk_size);
+                    auto n = stream_->Read(current_.data(), current_.size());
+                    if (n > 0) {
+                        *buffer = current_.data();
+                        return n;
+                    }
+                    stream_.reset();
+                }
+                // 上一段已被 libarchive 读取完毕，释放其占用的额度
+                current_ = Block();
+                in_flight_output_ -= current_bound_;
+                current_bound_ = 0;
+
+                SubmitSegments();
+                if (pending_.empty()) return 0;
+                auto decoded = pending_.front().get();
+                pending_.pop_front();
+                const auto &segment = segments_[completed_++];
+                consumed_ += static_cast<int64_t>(segment.size);
+                current_bound_ = segment.output_bound;
+                if (!decoded) {
+                    // 解压结果超出预估大小的段改为在当前线程中逐块解压
+                    if (!stream_factory_) {
+                        throw std::runtime_error("Decompressed segment exceeds its size bound");
+                    }
+                    stream_ = stream_factory_(file_.data() + segment.offset, segment.size);
+                    continue;
+                }
+                current_ = std::move(*decoded);
+                if (!current_.empty()) {
+                    *buffer = current_.data();
+                    return current_.size();
+                }
+            }
+        }
+
+    private:
+        MappedFile file_;
+        std::vector<Segment> segments_;
+        SegmentDecoder decoder_;
+        SegmentStreamFactory stream_factory_;
+        size_t max_in_flight_;
+        uint64_t max_in_flight_output_;
+        uint64_t in_flight_output_ = 0;
+        uint64_t current_bound_ = 0;
+        size_t submitted_ = 0;
+        size_t completed_ = 0;
+        int64_t consumed_ = 0;
+        Block current_;
+        std::unique_ptr<SegmentStream> stream_;
+        ThreadPool pool_;
+        std::deque<std::future<std::optional<Block>>> pending_;
+
+        void SubmitSegments() {
+            while (submitted_ < segments_.size() && pending_.size() < max_in_flight_) {
+                const auto &segment = segments_[submitted_];
+                // 没有待解压的段时总是提交，否则可能因单个大段而永远无法推进
+                if (!pending_.empty() &&
+                    in_flight_output_ + segment.output_bound > max_in_flight_output_) {
+                    break;
+                }
+                ++submitted_;
+                in_flight_output_ += segment.output_bound;
+                pending_.push_back(pool_.Submit(
+                        [decoder = decoder_, data = file_.data() + segment.offset,
+                                size = segment.size, limit = segment.output_bound] {
+                            Block output;
+                            if (!decoder(data, size, limit, output)) return std::optional<Block>();
+                            return std::optional<Block>(std::move(output));
+                        }));
+            }
+        }
+    };
+
+    /**
+     * 遍历 zstd 帧的块头得到帧长度与解压大小上限
+     * 解压大小超过 k_max_segment_output 时立即返回false，不再继续读取后面的块头
+     */
+    bool MeasureZstdFrame(const uint8_t *data, size_t size, Segment &segment) {
+        ZSTD_frameHeader header;
+        if (ZSTD_getFrameHeader(&header, data, size) != 0) return false;
+        if (header.frameContentSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+            header.frameContentSize > k_max_segment_output) {
+            return false;
+        }
+        size_t pos = header.headerSize;
+        uint64_t bound = 0;
+        bool last = false;
+        while (!last) {
+            if (size - pos < 3) return false;
+            auto block = static_cast<uint32_t>(data[pos]) | (static_cast<uint32_t>(data[pos + 1]) << 8) |
+                         (static_cast<uint32_t>(data[pos + 2]) << 16);
+            pos += 3;
+            last = block & 1;
+            auto type = (block >> 1) & 3;
+            size_t block_size = block >> 3;
+            // 类型 1 为 RLE 块，只存储一个字节；类型 3 保留
+            if (type == 3) return false;
+            size_t payload = type == 1 ? 1 : block_size;
+            if (size - pos < payload) return false;
+            pos += payload;
+            bound += type == 2 ? header.blockSizeMax : block_size;
+            if (bound > k_max_segment_output) return false;
+        }
+        if (header.checksumFlag) {
+            if (size - pos < 4) return false;
+            pos += 4;
+        }
+        if (header.frameContentSize != ZSTD_CONTENTSIZE_UNKNOWN) {
+            bound = std::min<uint64_t>(bound, header.frameContentSize);
+        }
+        segment.size = pos;
+        segment.output_bound = bound;
+        return true;
+    }
+
+    std::vector<Segment> ScanZstdFrames(const uint8_t *data, size_t size) {
+        std::vector<Segment> segments;
+        size_t offset = 0;
+        while (offset < size) {
+            // seek table 等 skippable frame 不产生数据
+            if (ZSTD_isSkippableFrame(data + offset, size - offset)) {
+                auto n = ZSTD_findFrameCompressedSize(data + offset, size - offset);
+                if (ZSTD_isError(n)) return {};
+                offset += n;
+                continue;
+            }
+            Segment segment{.offset = offset, .size = 0, .output_bound = 0};
+            if (!MeasureZstdFrame(data + offset, size - offset, segment)) return {};
+            segments.push_back(segment);
+            offset += segment.size;
+        }
+        return segments;
+    }
+
+    bool DecodeZstdFrame(const uint8_t *data, size_t size, uint64_t limit, Block &output) {
+        output.resize(limit);
+        auto n = ZSTD_decompress(output.data(), output.size(), data, size);
+        if (ZSTD_isError(n)) {
+            throw std::runtime_error(
+                    std::string("zstd decompression failed: ") + ZSTD_getErrorName(n));
+        }
+        output.resize(n);
+        return true;
+    }
+
+    /**
+     * 仅识别 ParallelBlockCompressor 写出的 member：FEXTRA 中带有 member 总长度
+     */
+    std::vector<Segment> ScanGzipMembers(const uint8_t *data, size_t size) {
+        constexpr size_t header_size = 10 + 2 + 4 + seekable::k_gzip_member_field_size;
+        std::vector<Segment> segments;
+        size_t offset = 0;
+        while (offset < size) {
+            auto ptr = data + offset;
+            if (size - offset < header_size + 8 || ptr[0] != 0x1f || ptr[1] != 0x8b ||
+                ptr[2] != Z_DEFLATED || !(ptr[3] & 0x04) ||
+                ptr[12] != seekable::k_gzip_member_si1 || ptr[13] != seekable::k_gzip_member_si2 ||
+                ptr[14] != seekable::k_gzip_member_field_size || ptr[15] != 0) {
+                return {};
+            }
+            size_t member_size = seekable::ReadLE32(ptr + 16);
+            if (member_size < header_size + 8 || member_size > size - offset) return {};
+            auto output_size = seekable::ReadLE32(ptr + member_size - 4);
+            if (output_size > k_max_segment_output) return {};
+            segments.push_back(
+                    Segment{.offset = offset, .size = member_size, .output_bound = output_size});
+            offset += member_size;
+        }
+        return segments;
+    }
+
+    bool DecodeGzipMember(const uint8_t *data, size_t size, uint64_t limit, Block &output) {
+        auto flags = data[3];
+        size_t pos = 10;
+        if (flags & 0x04) pos += 2 + (data[10] | (data[11] << 8));
+        if (flags & 0x08) while (pos < size && data[pos++] != 0);
+        if (flags & 0x10) while (pos < size && data[pos++] != 0);
+        if (flags & 0x02) pos += 2;
+        if (pos + 8 > size) throw std::runtime_error("Corrupted gzip member header");
+
+        // 扫描时已确认上限即为 ISIZE
+        output.resize(limit);
+        z_stream stream{};
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            throw std::runtime_error("Failed to initialize inflate");
+        }
+        stream.next_in = const_cast<Bytef *>(data + pos);
+        stream.avail_in = static_cast<uInt>(size - pos - 8);
+        stream.next_out = output.data();
+        stream.avail_out = static_cast<uInt>(output.size());
+        auto ret = inflate(&stream, Z_FINISH);
+        auto total_out = stream.total_out;
+        inflateEnd(&stream);
+        auto crc = crc32(crc32(0L, Z_NULL, 0), output.data(), static_cast<uInt>(output.size()));
+        if (ret != Z_STREAM_END || total_out != output.size() ||
+            crc != seekable::ReadLE32(data + size - 8)) {
+            throw std::runtime_error("Corrupted gzip member");
+        }
+        return true;
+    }
+
+    bool IsBzip2StreamStart(const uint8_t *data, size_t size, size_t pos) {
+        static const uint8_t block_magic[] = {0x31, 0x41, 0x59, 0x26, 0x53, 0x59};
+        return pos + 10 <= size && memcmp(data + pos, "BZh", 3) == 0 &&
+               data[pos + 3] >= '1' && data[pos + 3] <= '9' &&
+               memcmp(data + pos + 4, block_magic, sizeof(block_magic)) == 0;
+    }
+
+    /**
+     * 在 [from, to) 内查找下一个 stream 起点，找不到时返回 to
+     */
+    size_t FindBzip2Stream(const uint8_t *data, size_t size, size_t from, size_t to) {
+        while (from < to) {
+            // 多搜索两个字节，使起点在 to 之前但跨越 to 的签名也能被找到
+            auto end = std::min(size, to + 2);
+            auto found = static_cast<const uint8_t *>(memmem(data + from, end - from, "BZh", 3));
+            if (!found) break;
+            auto pos = static_cast<size_t>(found - data);
+            if (IsBzip2StreamStart(data, size, pos)) return pos;
+            from = pos + 1;
+        }
+        return to;
+    }
+
+    uint64_t Bzip2BlockSize(const uint8_t *stream) {
+        return static_cast<uint64_t>(stream[3] - '0') * 100000;
+    }
+
+    /**
+     * 按 stream 签名（"BZh1-9" + 块魔数）切分；stream 总是从字节边界开始
+     * pbzip2 等并行压缩工具每个 stream 只包含一个块，首个 stream 在一个块的最大压缩大小内
+     * 没有结束时即为普通的单 stream 文件，此时不再扫描文件的剩余部分
+     */
+    std::vector<Segment> ScanBzip2Streams(const uint8_t *data, size_t size) {
+        if (!IsBzip2StreamStart(data, size, 0)) return {};
+        auto block_size = Bzip2BlockSize(data);
+        // bzip2 对不可压缩数据的膨胀不超过 1% + 600 字节
+        auto first_end = std::min<size_t>(size, block_size + block_size / 100 + 4096);
+        std::vector<size_t> starts{0};
+        auto next = FindBzip2Stream(data, size, 1, first_end);
+        if (next == first_end) return {};
+        while (next < size) {
+            starts.push_back(next);
+            next = FindBzip2Stream(data, size, next + 1, size);
+        }
+        std::vector<Segment> segments;
+        for (size_t i = 0; i < starts.size(); ++i) {
+            auto end = i + 1 < starts.size() ? starts[i + 1] : size;
+            segments.push_back(Segment{
+                    .offset = starts[i],
+                    .size = end - starts[i],
+                    .output_bound = Bzip2BlockSize(data + starts[i])
+            });
+        }
+        return segments;
+    }
+
+    /**
+     * 逐块解压一段 bzip2 数据，段内可能还包含空 stream 等未被切分的后续 stream
+     */
+    class Bzip2SegmentStream : public SegmentStream {
+    public:
+        Bzip2SegmentStream(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+        ~Bzip2SegmentStream() override {
+            if (active_) BZ2_bzDecompressEnd(&stream_);
+        }
+
+        size_t Read(uint8_t *output, size_t capacity) override {
+            while (true) {
+                if (!active_) {
+                    if (consumed_ >= size_) return 0;
+                    stream_ = bz_stream{};
+                    if (BZ2_bzDecompressInit(&stream_, 0, 0) != BZ_OK) {
+                        throw std::runtime_error("Failed to initialize bzip2 decoder");
+                    }
+                    active_ = true;
+                    stream_.next_in = const_cast<char *>(
+                            reinterpret_cast<const char *>(data_ + consumed_));
+                    stream_.avail_in = static_cast<unsigned int>(size_ - consumed_);
+                }
+                stream_.next_out = reinterpret_cast<char *>(output);
+                stream_.avail_out = static_cast<unsigned int>(capacity);
+                auto ret = BZ2_bzDecompress(&stream_);
+                // 输入耗尽却没有到达 stream 结尾，说明数据被截断或切分位置有误
+                if (ret == BZ_OK && stream_.avail_in == 0 && stream_.avail_out != 0) {
+                    ret = BZ_DATA_ERROR;
+                }
+                if (ret == BZ_STREAM_END) {
+                    consumed_ = size_ - stream_.avail_in;
+                    BZ2_bzDecompressEnd(&stream_);
+                    active_ = false;
+                } else if (ret != BZ_OK) {
+                    throw std::runtime_error("bzip2 decompression failed: " + std::to_string(ret));
+                }
+                auto produced = capacity - stream_.avail_out;
+                if (produced > 0) return produced;
+            }
+        }
+
+    private:
+        const uint8_t *data_;
+        size_t size_;
+        size_t consumed_ = 0;
+        bz_stream stream_{};
+        bool active_ = false;
+    };
+
+    bool DecodeBzip2Streams(const uint8_t *data, size_t size, uint64_t limit, Block &output) {
+        Bzip2SegmentStream stream(data, size);
+        size_t used = 0;
+        while (true) {
+            output.resize(used + k_stream_chunk_size);
+            auto n = stream.Read(output.data() + used, k_stream_chunk_size);
+            used += n;
+            output.resize(used);
+            if (n == 0) return true;
+            if (used > limit) return false;
+        }
+    }
+
+    std::unique_ptr<SegmentStream> OpenBzip2Stream(const uint8_t *data, size_t size) {
+        return std::make_unique<Bzip2SegmentStream>(data, size);
+    }
+}
+
+std::unique_ptr<ParallelDecoder>
+ParallelDecoder::Open(const std::string &archive_path, int32_t threads) {
+    threads = ResolveThreadCount(threads);
+    if (threads <= 1) return nullptr;
+
+    MappedFile file;
+    if (!file.Open(archive_path) || file.size() < 6) return nullptr;
+    auto data = file.data();
+    if (memcmp(data, "\xFD" "7zXZ\0", 6) == 0) {
+        return std::make_unique<XzDecoder>(archive_path, threads);
+    }
+
+    std::vector<Segment> segments;
+    SegmentDecoder decoder = nullptr;
+    SegmentStreamFactory stream_factory = nullptr;
+    if (seekable::ReadLE32(data) == ZSTD_MAGICNUMBER) {
+        segments = ScanZstdFrames(data, file.size());
+        decoder = &DecodeZstdFrame;
+    } else if (data[0] == 0x1f && data[1] == 0x8b) {
+        segments = ScanGzipMembers(data, file.size());
+        decoder = &DecodeGzipMember;
+    } else if (memcmp(data, "BZh", 3) == 0) {
+        segments = ScanBzip2Streams(data, file.size());
+        decoder = &DecodeBzip2Streams;
+        stream_factory = &OpenBzip2Stream;
+    }
+    // 单段输入无法并行，交给 libarchive 的过滤器顺序解压
+    if (segments.size() < 2) return nullptr;
+    return std::make_unique<SegmentedDecoder>(
+            std::move(file), std::move(segments), decoder, stream_factory, threads);
+}
+
+std::unique_ptr<archive, ArchiveReadDeleter> ParallelDecoder::OpenArchive() {
+    auto reader = CreateArchiveReader();
+    if (archive_read_open(reader.get(), this, nullptr, &ParallelDecoder::OnRead, nullptr) !=
+        ARCHIVE_OK) {
+        auto err = archive_error_string(reader.get());
+        throw std::runtime_error(std::string("Failed to open archive: ") + (err ? err : "unknown"));
+    }
+    return reader;
+}
+
+la_ssize_t ParallelDecoder::OnRead(struct archive *a, void *client_data, const void **buffer) {
+    try {
+        return static_cast<la_ssize_t>(static_cast<ParallelDecoder *>(client_data)->Read(buffer));
+    } catch (const std::exception &exception) {
+        archive_set_error(a, EIO, "%s", exception.what());
+        return -1;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "archive_common.hpp"
+
+/**
+ * 多线程解压读取阶段，解压结果按顺序交给 libarchive 的格式解析器
+ * - xz: 使用 lzma_stream_decoder_mt，block 头中带有大小信息时自动并行
+ * - zstd: 多帧文件按帧并行解压（跳过 skippable frame）
+ * - gzip: 带有 member 长度 FEXTRA 的多 member 文件按 member 并行解压
+ * - bzip2: 多 stream 文件（pbzip2 等）按 stream 签名切分后并行解压
+ * 其余输入（单帧/单 member/单 stream）由 Open 返回nullptr，调用方回退到普通读取
+ */
+class ParallelDecoder {
+public:
+    /**
+     * @param threads 解压线程数，0 表示自动；解析后只有1个线程时返回nullptr
+     */
+    static std::unique_ptr<ParallelDecoder> Open(const std::string &archive_path, int32_t threads);
+
+    virtual ~ParallelDecoder() = default;
+
+    /**
+     * 打开以本解码器为数据源的 reader，解码器必须比返回的 reader 存活更久
+     * @throw std::runtime_error 打开失败
+     */
+    [[nodiscard]] std::unique_ptr<archive, ArchiveReadDeleter> OpenArchive();
+
+    /**
+     * 已交给 libarchive 的数据所对应的压缩字节数，用于进度估算
+     */
+    [[nodiscard]] virtual int64_t ConsumedBytes() const = 0;
+
+protected:
+    /**
+     * 返回下一段解压后的数据，结束时返回0
+     * @throw std::runtime_error 读取或解压失败
+     */
+    virtual size_t Read(const void **buffer) = 0;
+
+private:
+    static la_ssize_t OnRead(struct archive *a, void *client_data, const void **buffer);
+};
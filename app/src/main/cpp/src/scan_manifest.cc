@@ -0,0 +1,204 @@
+#include "scan_manifest.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace {
+    // getdents64 单次读取的缓冲区大小
+    constexpr size_t k_dirent_buffer_size = 64 * 1024;
+
+    /**
+     * 内核 getdents64 返回的目录项布局（libc 不一定声明该结构）
+     */
+    struct LinuxDirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    struct FdCloser {
+        void operator()(const int *fd) const { close(*fd); }
+    };
+
+    struct DirChild {
+        std::string name;
+        uint64_t ino;
+    };
+
+    /**
+     * 读取目录下的全部子项（不含 . 与 ..），顺序与 readdir 相同
+     * @throw std::runtime_error 读取失败
+     */
+    std::vector<DirChild> ReadDirectory(int dir_fd, const std::string &path) {
+        std::vector<DirChild> children;
+        std::vector<char> buffer(k_dirent_buffer_size);
+        while (true) {
+            auto n = syscall(SYS_getdents64, dir_fd, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                throw std::runtime_error(
+                        "Cannot read directory: " + path + ": " + strerror(errno));
+            }
+            if (n == 0) break;
+            for (long pos = 0; pos < n;) {
+                auto dirent = reinterpret_cast<const LinuxDirent64 *>(buffer.data() + pos);
+                pos += dirent->d_reclen;
+                const char *name = dirent->d_name;
+                if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+                children.push_back(DirChild{name, dirent->d_ino});
+            }
+        }
+        return children;
+    }
+
+    int OpenDirectoryAt(int dir_fd, const char *name) {
+        return openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+}
+
+ScanManifest ScanManifest::Build(
+        const std::string &base_dir,
+        const std::vector<std::string> &input_files,
+        bool sort_by_inode
+) {
+    ScanManifest manifest;
+    std::vector<std::pair<dev_t, uint64_t>> ancestors;
+    for (const auto &file: input_files) {
+        struct stat st{};
+        if (stat(file.c_str(), &st) != 0) {
+            throw std::runtime_error("Cannot stat file: " + file);
+        }
+
+        auto name = std::filesystem::relative(file, base_dir).u8string();
+        if (S_ISDIR(st.st_mode) && !name.empty() && name.back() != '/') name += '/';
+        // 输入路径等于 base_dir 时没有条目名称，整个输入被忽略
+        if (name.empty()) continue;
+        if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) continue;
+
+        auto root = static_cast<uint32_t>(manifest.roots_.size());
+        auto source = file;
+        while (source.size() > 1 && source.back() == '/') source.pop_back();
+        manifest.roots_.push_back(Root{std::move(source), name.size()});
+        manifest.Append(root, name, st);
+        if (!S_ISDIR(st.st_mode)) continue;
+
+        int fd = OpenDirectoryAt(AT_FDCWD, file.c_str());
+        if (fd < 0) throw std::runtime_error("Cannot open directory: " + file);
+        std::unique_ptr<int, FdCloser> guard(&fd);
+        ancestors.assign(1, {st.st_dev, static_cast<uint64_t>(st.st_ino)});
+        manifest.Walk(fd, root, name, ancestors, sort_by_inode);
+    }
+    return manifest;
+}
+
+void ScanManifest::Walk(
+        int dir_fd,
+        uint32_t root,
+        std::string &name,
+        std::vector<std::pair<dev_t, uint64_t>> &ancestors,
+        bool sort_by_inode
+) {
+    const auto &root_info = roots_[root];
+    auto source_of = [&](const std::string &entry_name) {
+        auto suffix = entry_name.substr(root_info.name_length);
+        if (!suffix.empty() && suffix.back() == '/') suffix.pop_back();
+        return root_info.source + "/" + suffix;
+    };
+
+    auto children = ReadDirectory(dir_fd, source_of(name));
+    if (sort_by_inode) {
+        std::stable_sort(children.begin(), children.end(), [](const auto &a, const auto &b) {
+            return a.ino < b.ino;
+        });
+    }
+
+    auto name_length = name.size();
+    for (const auto &child: children) {
+        name.resize(name_length);
+        name += child.name;
+
+        // 跟随符号链接，与 stat 的语义一致
+        struct stat st{};
+        if (fstatat(dir_fd, child.name.c_str(), &st, 0) != 0) {
+            throw std::runtime_error("Cannot stat file: " + source_of(name));
+        }
+        if (S_ISREG(st.st_mode)) {
+            Append(root, name, st);
+            continue;
+        }
+        if (!S_ISDIR(st.st_mode)) continue;
+
+        name += '/';
+        Append(root, name, st);
+        // 指向祖先目录的符号链接会形成环，只记录目录本身
+        std::pair<dev_t, uint64_t> key{st.st_dev, static_cast<uint64_t>(st.st_ino)};
+        if (std::find(ancestors.begin(), ancestors.end(), key) != ancestors.end()) continue;
+
+        int fd = OpenDirectoryAt(dir_fd, child.name.c_str());
+        if (fd < 0) throw std::runtime_error("Cannot open directory: " + source_of(name));
+        std::unique_ptr<int, FdCloser> guard(&fd);
+        ancestors.push_back(key);
+        Walk(fd, root, name, ancestors, sort_by_inode);
+        ancestors.pop_back();
+    }
+    name.resize(name_length);
+}
+
+void ScanManifest::Append(uint32_t root, std::string_view name, const struct stat &st) {
+    entries_.push_back(Entry{
+            .name_offset = names_.size(),
+            .name_length = static_cast<uint32_t>(name.size()),
+            .root = root,
+            .mode = st.st_mode,
+            .uid = st.st_uid,
+            .gid = st.st_gid,
+            .nlink = st.st_nlink,
+            .dev = st.st_dev,
+            .ino = static_cast<uint64_t>(st.st_ino),
+            .size = static_cast<int64_t>(st.st_size),
+            .atime = static_cast<int64_t>(st.st_atim.tv_sec),
+            .mtime = static_cast<int64_t>(st.st_mtim.tv_sec),
+            .ctime = static_cast<int64_t>(st.st_ctim.tv_sec),
+            .atime_nsec = static_cast<int32_t>(st.st_atim.tv_nsec),
+            .mtime_nsec = static_cast<int32_t>(st.st_mtim.tv_nsec),
+            .ctime_nsec = static_cast<int32_t>(st.st_ctim.tv_nsec)
+    });
+    names_.append(name);
+    if (!S_ISREG(st.st_mode)) return;
+    ++regular_files_;
+    total_bytes_ += static_cast<uint64_t>(std::max<off_t>(0, st.st_size));
+}
+
+std::string ScanManifest::SourcePath(const Entry &entry) const {
+    const auto &root = roots_[entry.root];
+    if (entry.name_length <= root.name_length) return root.source;
+    auto suffix = Name(entry).substr(root.name_length);
+    if (suffix.back() == '/') suffix.remove_suffix(1);
+    return root.source + "/" + std::string(suffix);
+}
+
+void ScanManifest::ToStat(const Entry &entry, struct stat *st) {
+    *st = {};
+    st->st_mode = entry.mode;
+    st->st_uid = entry.uid;
+    st->st_gid = entry.gid;
+    st->st_nlink = entry.nlink;
+    st->st_dev = entry.dev;
+    st->st_ino = entry.ino;
+    st->st_size = entry.size;
+    st->st_atim.tv_sec = entry.atime;
+    st->st_atim.tv_nsec = entry.atime_nsec;
+    st->st_mtim.tv_sec = entry.mtime;
+    st->st_mtim.tv_nsec = entry.mtime_nsec;
+    st->st_ctim.tv_sec = entry.ctime;
+    st->st_ctim.tv_nsec = entry.ctime_nsec;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+
+/**
+ * 打包输入的扫描清单
+ * 通过 openat/fstatat/getdents64 对输入目录树只遍历一次，按写入顺序记录每个目录与常规文件的
+ * stat 信息和条目名称；条目名称集中存放在字符串池中，同时用于统计进度总数与驱动写入
+ */
+class ScanManifest {
+public:
+    struct Entry {
+        // 条目名称在字符串池中的位置（目录以 '/' 结尾）
+        size_t name_offset;
+        uint32_t name_length;
+        // 所属的输入路径
+        uint32_t root;
+        mode_t mode;
+        uid_t uid;
+        gid_t gid;
+        nlink_t nlink;
+        dev_t dev;
+        uint64_t ino;
+        int64_t size;
+        int64_t atime;
+        int64_t mtime;
+        int64_t ctime;
+        int32_t atime_nsec;
+        int32_t mtime_nsec;
+        int32_t ctime_nsec;
+    };
+
+    /**
+     * 扫描输入路径，条目名称为相对 base_dir 的路径；跟随符号链接，只记录目录与常规文件
+     * @param sort_by_inode 同一目录下的子项按 inode 排序，使读取文件内容时的磁盘访问更连续
+     * @throw std::runtime_error 路径无法访问
+     */
+    static ScanManifest Build(
+            const std::string &base_dir,
+            const std::vector<std::string> &input_files,
+            bool sort_by_inode = false
+    );
+
+    [[nodiscard]] const std::vector<Entry> &entries() const { return entries_; }
+
+    [[nodiscard]] size_t RegularFileCount() const { return regular_files_; }
+
+    /**
+     * 常规文件的总字节数
+     */
+    [[nodiscard]] uint64_t TotalBytes() const { return total_bytes_; }
+
+    [[nodiscard]] std::string_view Name(const Entry &entry) const {
+        return {names_.data() + entry.name_offset, entry.name_length};
+    }
+
+    /**
+     * 条目对应的源文件路径
+     */
+    [[nodiscard]] std::string SourcePath(const Entry &entry) const;
+
+    /**
+     * 还原 archive_entry_copy_stat 所需的 stat 结构
+     */
+    static void ToStat(const Entry &entry, struct stat *st);
+
+private:
+    struct Root {
+        std::string source;
+        // 输入路径自身条目名称的长度（含目录结尾的 '/'）
+        size_t name_length;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<Root> roots_;
+    std::string names_;
+    size_t regular_files_ = 0;
+    uint64_t total_bytes_ = 0;
+
+    ScanManifest() = default;
+
+    void Append(uint32_t root, std::string_view name, const struct stat &st);
+
+    void Walk(int dir_fd, uint32_t root, std::string &name,
+              std::vector<std::pair<dev_t, uint64_t>> &ancestors, bool sort_by_inode);
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * seekable 压缩流的共享常量
+ * zstd 部分遵循 zstd 官方 contrib/seekable_format 规范：
+ * 独立帧 + 末尾 skippable frame 形式的 seek table
+ */
+namespace seekable {
+    // seek table 所在 skippable frame 的魔数
+    constexpr uint32_t k_zstd_skippable_magic = 0x184D2A5E;
+    // seek table footer 的魔数
+    constexpr uint32_t k_zstd_seekable_magic = 0x8F92EAB1;
+    // footer: Number_Of_Frames(4) + Seek_Table_Descriptor(1) + Seekable_Magic_Number(4)
+    constexpr size_t k_zstd_footer_size = 9;
+    // skippable frame header: magic(4) + frame size(4)
+    constexpr size_t k_zstd_skippable_header_size = 8;
+    // Seek_Table_Descriptor 中表示带校验和的位
+    constexpr uint8_t k_zstd_checksum_flag = 0x80;
+
+    // 达到该大小后才在条目边界结束帧，避免大量小文件各自成帧影响压缩率
+    constexpr size_t k_min_frame_size = 1 << 20;
+    // 单帧最大未压缩大小，超过后即使在条目中间也强制结束帧
+    constexpr size_t k_max_frame_size = 8 << 20;
+
+    // 分块 gzip member 的 FEXTRA 子字段标识与长度（member 总长度，LE32）
+    constexpr uint8_t k_gzip_member_si1 = 'A';
+    constexpr uint8_t k_gzip_member_si2 = 'H';
+    constexpr uint16_t k_gzip_member_field_size = 4;
+
+    inline void WriteLE32(uint8_t *dst, uint32_t value) {
+        dst[0] = static_cast<uint8_t>(value);
+        dst[1] = static_cast<uint8_t>(value >> 8);
+        dst[2] = static_cast<uint8_t>(value >> 16);
+        dst[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    inline uint32_t ReadLE32(const uint8_t *src) {
+        return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+               (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+    }
+}
@@ -0,0 +1,273 @@
+#include "seekable_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <lzma.h>
+#include <zstd.h>
+
+#include "seekable_format.hpp"
+
+namespace {
+    // 随机访问时单帧允许的最大未压缩大小，超过则视为不可随机访问
+    constexpr uint64_t k_max_random_access_frame = 64ULL << 20;
+
+    bool ReadFully(int fd, void *buffer, size_t length, uint64_t offset) {
+        auto ptr = static_cast<uint8_t *>(buffer);
+        while (length > 0) {
+            auto n = pread64(fd, ptr, length, static_cast<off64_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            ptr += n;
+            length -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    struct FdCloser {
+        int fd;
+
+        ~FdCloser() { if (fd >= 0) close(fd); }
+    };
+}
+
+std::unique_ptr<SeekableStream> SeekableStream::Open(const std::string &archive_path) {
+    int fd = open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    FdCloser closer{fd};
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < 32) return nullptr;
+    auto file_size = static_cast<uint64_t>(st.st_size);
+
+    uint8_t magic[6];
+    if (!ReadFully(fd, magic, sizeof(magic), 0)) return nullptr;
+
+    auto stream = std::unique_ptr<SeekableStream>(new SeekableStream());
+    stream->archive_path_ = archive_path;
+    bool loaded = false;
+    if (seekable::ReadLE32(magic) == ZSTD_MAGICNUMBER) {
+        stream->kind_ = Kind::Zstd;
+        loaded = stream->LoadZstdSeekTable(fd, file_size);
+    } else if (memcmp(magic, "\xFD" "7zXZ\0", 6) == 0) {
+        stream->kind_ = Kind::Xz;
+        loaded = stream->LoadXzIndex(fd, file_size);
+    }
+    if (!loaded || stream->frames_.empty()) return nullptr;
+    for (const auto &frame: stream->frames_) {
+        if (frame.uncompressed_size > k_max_random_access_frame) return nullptr;
+    }
+    return stream;
+}
+
+bool SeekableStream::LoadZstdSeekTable(int fd, uint64_t file_size) {
+    uint8_t footer[seekable::k_zstd_footer_size];
+    if (!ReadFully(fd, footer, sizeof(footer), file_size - sizeof(footer))) return false;
+    if (seekable::ReadLE32(footer + 5) != seekable::k_zstd_seekable_magic) return false;
+
+    uint64_t frame_count = seekable::ReadLE32(footer);
+    size_t entry_size = (footer[4] & seekable::k_zstd_checksum_flag) ? 12 : 8;
+    uint64_t table_size = frame_count * entry_size + seekable::k_zstd_footer_size;
+    if (table_size + seekable::k_zstd_skippable_header_size > file_size) return false;
+
+    std::vector<uint8_t> table(seekable::k_zstd_skippable_header_size + table_size);
+    auto table_offset = file_size - table.size();
+    if (!ReadFully(fd, table.data(), table.size(), table_offset)) return false;
+    if (seekable::ReadLE32(table.data()) != seekable::k_zstd_skippable_magic ||
+        seekable::ReadLE32(table.data() + 4) != table_size) {
+        return false;
+    }
+
+    uint64_t compressed_offset = 0;
+    uint64_t uncompressed_offset = 0;
+    auto ptr = table.data() + seekable::k_zstd_skippable_header_size;
+    for (uint64_t i = 0; i < frame_count; ++i, ptr += entry_size) {
+        Frame frame{
+                .compressed_offset = compressed_offset,
+                .compressed_size = seekable::ReadLE32(ptr),
+                .uncompressed_offset = uncompressed_offset,
+                .uncompressed_size = seekable::ReadLE32(ptr + 4)
+        };
+        compressed_offset += frame.compressed_size;
+        uncompressed_offset += frame.uncompressed_size;
+        frames_.push_back(frame);
+    }
+    // 所有帧必须恰好覆盖 seek table 之前的数据
+    return compressed_offset == table_offset;
+}
+
+bool SeekableStream::LoadXzIndex(int fd, uint64_t file_size) {
+    uint8_t header_buffer[LZMA_STREAM_HEADER_SIZE];
+    uint8_t footer_buffer[LZMA_STREAM_HEADER_SIZE];
+    if (!ReadFully(fd, header_buffer, sizeof(header_buffer), 0) ||
+        !ReadFully(fd, footer_buffer, sizeof(footer_buffer), file_size - sizeof(footer_buffer))) {
+        return false;
+    }
+    lzma_stream_flags header_flags, footer_flags;
+    if (lzma_stream_header_decode(&header_flags, header_buffer) != LZMA_OK ||
+        lzma_stream_footer_decode(&footer_flags, footer_buffer) != LZMA_OK ||
+        lzma_stream_flags_compare(&header_flags, &footer_flags) != LZMA_OK) {
+        // 存在 stream padding 或多个 stream 时退回普通读取
+        return false;
+    }
+    auto index_size = footer_flags.backward_size;
+    if (index_size + 2 * LZMA_STREAM_HEADER_SIZE > file_size) return false;
+
+    std::vector<uint8_t> index_buffer(index_size);
+    if (!ReadFully(fd, index_buffer.data(), index_buffer.size(),
+                   file_size - LZMA_STREAM_HEADER_SIZE - index_size)) {
+        return false;
+    }
+    lzma_index *index = nullptr;
+    uint64_t memlimit = UINT64_MAX;
+    size_t in_pos = 0;
+    if (lzma_index_buffer_decode(&index, &memlimit, nullptr, index_buffer.data(), &in_pos,
+                                 index_buffer.size()) != LZMA_OK) {
+        return false;
+    }
+    bool ok = lzma_index_stream_flags(index, &footer_flags) == LZMA_OK &&
+              lzma_index_file_size(index) == file_size;
+    if (ok) {
+        xz_check_ = static_cast<uint32_t>(footer_flags.check);
+        lzma_index_iter iter;
+        lzma_index_iter_init(&iter, index);
+        while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+            frames_.push_back(Frame{
+                    .compressed_offset = iter.block.compressed_file_offset,
+                    .compressed_size = iter.block.total_size,
+                    .uncompressed_offset = iter.block.uncompressed_file_offset,
+                    .uncompressed_size = iter.block.uncompressed_size
+            });
+        }
+    }
+    lzma_index_end(index, nullptr);
+    return ok;
+}
+
+size_t SeekableStream::FrameOf(uint64_t offset) const {
+    // 第一个 uncompressed_offset 大于 offset 的帧的前一个
+    auto it = std::upper_bound(
+            frames_.begin(), frames_.end(), offset,
+            [](uint64_t value, const Frame &frame) { return value < frame.uncompressed_offset; });
+    if (it == frames_.begin()) return frames_.size();
+    auto index = static_cast<size_t>(std::distance(frames_.begin(), it) - 1);
+    const auto &frame = frames_[index];
+    if (offset >= frame.uncompressed_offset + frame.uncompressed_size) return frames_.size();
+    return index;
+}
+
+/**
+ * 从指定帧开始逐帧解压，作为 libarchive 的 read callback 数据源
+ */
+class SeekableStream::FrameCursor {
+public:
+    FrameCursor(const SeekableStream &stream, size_t frame, uint64_t skip)
+            : stream_(stream), frame_(frame), skip_(skip) {
+        fd_ = open(stream.archive_path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error(
+                    "Failed to open archive: " + stream.archive_path_ + ": " + strerror(errno));
+        }
+    }
+
+    ~FrameCursor() {
+        if (fd_ >= 0) close(fd_);
+        if (dctx_) ZSTD_freeDCtx(dctx_);
+    }
+
+    static la_ssize_t Read(struct archive *a, void *client_data, const void **buffer) {
+        auto self = static_cast<FrameCursor *>(client_data);
+        try {
+            if (self->frame_ >= self->stream_.frames_.size()) return 0;
+            self->DecodeFrame(self->stream_.frames_[self->frame_++]);
+            auto skip = std::min<uint64_t>(self->skip_, self->output_.size());
+            self->skip_ = 0;
+            *buffer = self->output_.data() + skip;
+            return static_cast<la_ssize_t>(self->output_.size() - skip);
+        } catch (const std::exception &exception) {
+            archive_set_error(a, EIO, "%s", exception.what());
+            return -1;
+        }
+    }
+
+    static int Close(struct archive *, void *client_data) {
+        delete static_cast<FrameCursor *>(client_data);
+        return ARCHIVE_OK;
+    }
+
+private:
+    const SeekableStream &stream_;
+    size_t frame_;
+    uint64_t skip_;
+    int fd_ = -1;
+    ZSTD_DCtx *dctx_ = nullptr;
+    std::vector<uint8_t> input_;
+    std::vector<uint8_t> output_;
+
+    void DecodeFrame(const Frame &frame) {
+        input_.resize(frame.compressed_size);
+        output_.resize(frame.uncompressed_size);
+        if (!ReadFully(fd_, input_.data(), input_.size(), frame.compressed_offset)) {
+            throw std::runtime_error("Failed to read compressed frame");
+        }
+        if (stream_.kind_ == Kind::Zstd) {
+            if (!dctx_ && !(dctx_ = ZSTD_createDCtx())) {
+                throw std::runtime_error("Failed to create zstd context");
+            }
+            auto n = ZSTD_decompressDCtx(dctx_, output_.data(), output_.size(),
+                                         input_.data(), input_.size());
+            if (ZSTD_isError(n) || n != output_.size()) {
+                throw std::runtime_error("Corrupted zstd frame");
+            }
+        } else {
+            DecodeXzBlock(frame);
+        }
+    }
+
+    void DecodeXzBlock(const Frame &frame) {
+        lzma_filter filters[LZMA_FILTERS_MAX + 1];
+        lzma_block block{};
+        block.version = 0;
+        block.check = static_cast<lzma_check>(stream_.xz_check_);
+        block.filters = filters;
+        block.header_size = lzma_block_header_size_decode(input_[0]);
+        if (block.header_size > input_.size() ||
+            lzma_block_header_decode(&block, nullptr, input_.data()) != LZMA_OK) {
+            throw std::runtime_error("Corrupted xz block header");
+        }
+        size_t in_pos = block.header_size;
+        size_t out_pos = 0;
+        auto ret = lzma_block_buffer_decode(&block, nullptr, input_.data(), &in_pos, input_.size(),
+                                            output_.data(), &out_pos, output_.size());
+        for (size_t i = 0; filters[i].id != LZMA_VLI_UNKNOWN; ++i) free(filters[i].options);
+        if (ret != LZMA_OK || out_pos != frame.uncompressed_size) {
+            throw std::runtime_error("Corrupted xz block");
+        }
+    }
+};
+
+std::unique_ptr<archive, ArchiveReadDeleter> SeekableStream::OpenArchiveAt(uint64_t offset) const {
+    auto frame = FrameOf(offset);
+    if (frame >= frames_.size()) throw std::runtime_error("Offset out of seekable stream range");
+
+    auto reader = std::unique_ptr<archive, ArchiveReadDeleter>(archive_read_new());
+    if (!reader) throw std::runtime_error("Failed to create archive reader");
+    archive_read_support_format_tar(reader.get());
+    archive_read_support_format_cpio(reader.get());
+    archive_read_support_filter_none(reader.get());
+
+    auto cursor = new FrameCursor(*this, frame, offset - frames_[frame].uncompressed_offset);
+    // 无论打开成功与否，close 回调都会释放 cursor
+    if (archive_read_open(reader.get(), cursor, nullptr, &FrameCursor::Read,
+                          &FrameCursor::Close) != ARCHIVE_OK) {
+        auto err = archive_error_string(reader.get());
+        throw std::runtime_error(std::string("Failed to open archive: ") + (err ? err : "unknown"));
+    }
+    return reader;
+}
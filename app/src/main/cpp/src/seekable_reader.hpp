@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive_common.hpp"
+
+/**
+ * seekable 压缩流（zstd seekable format / 多 block xz）的随机访问读取器
+ * 通过 seek table 或 xz index 定位包含目标偏移的帧，只解压从该帧开始的数据
+ */
+class SeekableStream {
+public:
+    struct Frame {
+        uint64_t compressed_offset;
+        uint64_t compressed_size;
+        uint64_t uncompressed_offset;
+        uint64_t uncompressed_size;
+    };
+
+    /**
+     * 读取归档的帧表；不是 seekable 流或单帧过大时返回nullptr
+     */
+    static std::unique_ptr<SeekableStream> Open(const std::string &archive_path);
+
+    [[nodiscard]] const std::vector<Frame> &Frames() const { return frames_; }
+
+    /**
+     * 包含未压缩偏移 offset 的帧序号，越界时返回帧数量
+     */
+    [[nodiscard]] size_t FrameOf(uint64_t offset) const;
+
+    /**
+     * 打开一个从未压缩偏移 offset 开始读取的 tar/cpio reader
+     * offset 必须位于条目 header 的起始位置（archive_read_header_position）
+     * @throw std::runtime_error 打开失败
+     */
+    [[nodiscard]] std::unique_ptr<archive, ArchiveReadDeleter> OpenArchiveAt(uint64_t offset) const;
+
+private:
+    enum class Kind {
+        Zstd, Xz
+    };
+
+    class FrameCursor;
+
+    std::string archive_path_;
+    Kind kind_ = Kind::Zstd;
+    uint32_t xz_check_ = 0;
+    std::vector<Frame> frames_;
+
+    SeekableStream() = default;
+
+    bool LoadZstdSeekTable(int fd, uint64_t file_size);
+
+    bool LoadXzIndex(int fd, uint64_t file_size);
+};
@@ -0,0 +1,439 @@
+#include "stream_compressor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <bzlib.h>
+#include <lz4frame.h>
+#include <lzma.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include "seekable_format.hpp"
+#include "utils/thread_pool.hpp"
+
+StreamCompressor::StreamCompressor(std::string output_path) : output_path_(std::move(output_path)) {
+    fd_ = open(output_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error(
+                "Failed to open output archive: " + output_path_ + ": " + strerror(errno));
+    }
+}
+
+StreamCompressor::~StreamCompressor() {
+    if (fd_ >= 0) close(fd_);
+}
+
+void StreamCompressor::Finish() {
+    FinishStream();
+    int rc = close(fd_);
+    fd_ = -1;
+    if (rc != 0) {
+        throw std::runtime_error(
+                "Failed to close output archive: " + output_path_ + ": " + strerror(errno));
+    }
+}
+
+void StreamCompressor::WriteOutput(const void *data, size_t length) {
+    auto ptr = static_cast<const uint8_t *>(data);
+    while (length > 0) {
+        auto n = write(fd_, ptr, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(
+                    "Failed to write output archive: " + output_path_ + ": " + strerror(errno));
+        }
+        ptr += n;
+        length -= static_cast<size_t>(n);
+        bytes_written_ += static_cast<uint64_t>(n);
+    }
+}
+
+namespace {
+    /**
+     * zstd seekable format：每帧独立压缩，结束时追加 seek table
+     */
+    class SeekableZstdCompressor : public StreamCompressor {
+    public:
+        SeekableZstdCompressor(const std::string &output_path, int32_t level, int32_t threads)
+                : StreamCompressor(output_path),
+                  cctx_(ZSTD_createCCtx()),
+                  out_buffer_(ZSTD_CStreamOutSize()) {
+            if (!cctx_) throw std::runtime_error("Failed to create zstd context");
+            ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+            ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1);
+            if (threads > 1) {
+                // 未启用多线程支持的 libzstd 会拒绝该参数，此时保持单线程
+                ZSTD_CCtx_setParameter(cctx_, ZSTD_c_nbWorkers, threads);
+                // 帧最大只有 k_max_frame_size，缩小 job 使单帧内也能并行
+                ZSTD_CCtx_setParameter(cctx_, ZSTD_c_jobSize,
+                                       static_cast<int>(seekable::k_min_frame_size));
+            }
+        }
+
+        ~SeekableZstdCompressor() override {
+            ZSTD_freeCCtx(cctx_);
+        }
+
+        void Write(const void *data, size_t length) override {
+            auto ptr = static_cast<const uint8_t *>(data);
+            while (length > 0) {
+                auto chunk = std::min(length, seekable::k_max_frame_size - frame_in_);
+                Compress(ptr, chunk, ZSTD_e_continue);
+                frame_in_ += chunk;
+                ptr += chunk;
+                length -= chunk;
+                if (frame_in_ >= seekable::k_max_frame_size) EndFrame();
+            }
+        }
+
+        void EndEntry() override {
+            if (frame_in_ >= seekable::k_min_frame_size) EndFrame();
+        }
+
+    protected:
+        void FinishStream() override {
+            EndFrame();
+            WriteSeekTable();
+        }
+
+    private:
+        struct Frame {
+            uint32_t compressed_size;
+            uint32_t decompressed_size;
+        };
+
+        ZSTD_CCtx *cctx_;
+        std::vector<uint8_t> out_buffer_;
+        std::vector<Frame> frames_;
+        size_t frame_in_ = 0;
+        size_t frame_out_ = 0;
+
+        void Compress(const void *src, size_t length, ZSTD_EndDirective mode) {
+            ZSTD_inBuffer in{src, length, 0};
+            bool finished;
+            do {
+                ZSTD_outBuffer out{out_buffer_.data(), out_buffer_.size(), 0};
+                auto remaining = ZSTD_compressStream2(cctx_, &out, &in, mode);
+                if (ZSTD_isError(remaining)) {
+                    throw std::runtime_error(
+                            std::string("zstd compression failed: ") +
+                            ZSTD_getErrorName(remaining));
+                }
+                WriteOutput(out_buffer_.data(), out.pos);
+                frame_out_ += out.pos;
+                finished = mode == ZSTD_e_end ? remaining == 0 : in.pos == in.size;
+            } while (!finished);
+        }
+
+        void EndFrame() {
+            if (frame_in_ == 0) return;
+            Compress(nullptr, 0, ZSTD_e_end);
+            frames_.push_back(Frame{
+                    .compressed_size = static_cast<uint32_t>(frame_out_),
+                    .decompressed_size = static_cast<uint32_t>(frame_in_)
+            });
+            frame_in_ = 0;
+            frame_out_ = 0;
+        }
+
+        void WriteSeekTable() {
+            auto table_size = frames_.size() * 8 + seekable::k_zstd_footer_size;
+            std::vector<uint8_t> table(seekable::k_zstd_skippable_header_size + table_size);
+            auto ptr = table.data();
+            seekable::WriteLE32(ptr, seekable::k_zstd_skippable_magic);
+            seekable::WriteLE32(ptr + 4, static_cast<uint32_t>(table_size));
+            ptr += seekable::k_zstd_skippable_header_size;
+            for (const auto &frame: frames_) {
+                seekable::WriteLE32(ptr, frame.compressed_size);
+                seekable::WriteLE32(ptr + 4, frame.decompressed_size);
+                ptr += 8;
+            }
+            seekable::WriteLE32(ptr, static_cast<uint32_t>(frames_.size()));
+            ptr[4] = 0;
+            seekable::WriteLE32(ptr + 5, seekable::k_zstd_seekable_magic);
+            WriteOutput(table.data(), table.size());
+        }
+    };
+
+    /**
+     * 按条目边界切分 block 的 xz 流，block 位置由 xz 自身的 index 记录
+     */
+    class SeekableXzCompressor : public StreamCompressor {
+    public:
+        SeekableXzCompressor(const std::string &output_path, int32_t level, int32_t threads)
+                : StreamCompressor(output_path), out_buffer_(64 * 1024) {
+            lzma_ret ret;
+            if (threads > 1) {
+                lzma_mt mt{};
+                mt.threads = static_cast<uint32_t>(threads);
+                mt.preset = static_cast<uint32_t>(level);
+                mt.check = LZMA_CHECK_CRC64;
+                mt.block_size = seekable::k_max_frame_size;
+                ret = lzma_stream_encoder_mt(&stream_, &mt);
+            } else {
+                ret = lzma_easy_encoder(&stream_, static_cast<uint32_t>(level), LZMA_CHECK_CRC64);
+            }
+            if (ret != LZMA_OK) throw std::runtime_error("Failed to initialize xz encoder");
+        }
+
+        ~SeekableXzCompressor() override {
+            lzma_end(&stream_);
+        }
+
+        void Write(const void *data, size_t length) override {
+            auto ptr = static_cast<const uint8_t *>(data);
+            while (length > 0) {
+                auto chunk = std::min(length, seekable::k_max_frame_size - block_in_);
+                Code(ptr, chunk, LZMA_RUN);
+                block_in_ += chunk;
+                ptr += chunk;
+                length -= chunk;
+                if (block_in_ >= seekable::k_max_frame_size) EndBlock();
+            }
+        }
+
+        void EndEntry() override {
+            if (block_in_ >= seekable::k_min_frame_size) EndBlock();
+        }
+
+    protected:
+        void FinishStream() override {
+            Code(nullptr, 0, LZMA_FINISH);
+        }
+
+    private:
+        lzma_stream stream_ = LZMA_STREAM_INIT;
+        std::vector<uint8_t> out_buffer_;
+        size_t block_in_ = 0;
+
+        void EndBlock() {
+            if (block_in_ == 0) return;
+            // LZMA_FULL_BARRIER 结束当前 block，后续数据写入新的 block；
+            // 多线程编码时不必等待已提交的 block 输出，单线程时等同于 LZMA_FULL_FLUSH
+            Code(nullptr, 0, LZMA_FULL_BARRIER);
+            block_in_ = 0;
+        }
+
+        void Code(const void *src, size_t length, lzma_action action) {
+            stream_.next_in = static_cast<const uint8_t *>(src);
+            stream_.avail_in = length;
+            while (true) {
+                stream_.next_out = out_buffer_.data();
+                stream_.avail_out = out_buffer_.size();
+                auto ret = lzma_code(&stream_, action);
+                if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+                    throw std::runtime_error(
+                            "xz compression failed: " + std::to_string(static_cast<int>(ret)));
+                }
+                WriteOutput(out_buffer_.data(), out_buffer_.size() - stream_.avail_out);
+                if (action == LZMA_RUN) {
+                    if (stream_.avail_in == 0 && stream_.avail_out != 0) break;
+                } else if (ret == LZMA_STREAM_END) {
+                    break;
+                }
+            }
+        }
+    };
+}
+
+namespace {
+    using Block = std::vector<uint8_t>;
+    using BlockEncoder = std::function<Block(const Block &)>;
+
+    /**
+     * 按固定大小分块、在线程池中并行压缩并按顺序写出
+     * 编码函数只依赖按值捕获的参数，析构时仍在运行的任务不会访问已销毁的成员
+     */
+    class ParallelBlockCompressor : public StreamCompressor {
+    public:
+        ParallelBlockCompressor(
+                const std::string &output_path,
+                int32_t threads,
+                size_t block_size,
+                BlockEncoder encoder
+        ) : StreamCompressor(output_path),
+            block_size_(block_size),
+            max_in_flight_(static_cast<size_t>(threads) * 2),
+            encoder_(std::move(encoder)),
+            pool_(static_cast<size_t>(threads)) {
+            current_.reserve(block_size_);
+        }
+
+        ~ParallelBlockCompressor() override {
+            for (auto &pending: pending_) pending.wait();
+        }
+
+        void Write(const void *data, size_t length) override {
+            auto ptr = static_cast<const uint8_t *>(data);
+            while (length > 0) {
+                auto chunk = std::min(length, block_size_ - current_.size());
+                current_.insert(current_.end(), ptr, ptr + chunk);
+                ptr += chunk;
+                length -= chunk;
+                if (current_.size() == block_size_) SubmitBlock();
+            }
+        }
+
+    protected:
+        void FinishStream() override {
+            // 空输入也需要输出一个完整的块，保证结果是合法的压缩流
+            if (!current_.empty() || submitted_blocks_ == 0) SubmitBlock();
+            while (!pending_.empty()) WriteNextBlock();
+        }
+
+    private:
+        size_t block_size_;
+        size_t max_in_flight_;
+        BlockEncoder encoder_;
+        Block current_;
+        size_t submitted_blocks_ = 0;
+        std::deque<std::future<Block>> pending_;
+        ThreadPool pool_;
+
+        void SubmitBlock() {
+            pending_.push_back(pool_.Submit(
+                    [encoder = encoder_, block = std::move(current_)] { return encoder(block); }));
+            ++submitted_blocks_;
+            current_ = Block();
+            current_.reserve(block_size_);
+            // 限制在途块数量，避免压缩速度跟不上输入时内存无限增长
+            while (pending_.size() >= max_in_flight_) WriteNextBlock();
+        }
+
+        void WriteNextBlock() {
+            auto compressed = pending_.front().get();
+            pending_.pop_front();
+            WriteOutput(compressed.data(), compressed.size());
+        }
+    };
+
+    /**
+     * 压缩为独立的 gzip member：header(含 FEXTRA) + raw deflate + CRC32 + ISIZE
+     */
+    Block EncodeGzipMember(const Block &input, int32_t level) {
+        constexpr size_t header_size = 10 + 2 + 4 + seekable::k_gzip_member_field_size;
+        z_stream stream{};
+        if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Failed to initialize deflate");
+        }
+        Block output(header_size + deflateBound(&stream, input.size()) + 8);
+        stream.next_in = const_cast<Bytef *>(input.data());
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = output.data() + header_size;
+        stream.avail_out = static_cast<uInt>(output.size() - header_size - 8);
+        auto ret = deflate(&stream, Z_FINISH);
+        auto deflated = stream.total_out;
+        deflateEnd(&stream);
+        if (ret != Z_STREAM_END) throw std::runtime_error("gzip compression failed");
+
+        auto member_size = header_size + deflated + 8;
+        auto ptr = output.data();
+        const uint8_t header[] = {0x1f, 0x8b, Z_DEFLATED, 0x04 /* FEXTRA */, 0, 0, 0, 0, 0,
+                                  0x03 /* Unix */};
+        memcpy(ptr, header, sizeof(header));
+        ptr[10] = 4 + seekable::k_gzip_member_field_size;
+        ptr[11] = 0;
+        ptr[12] = seekable::k_gzip_member_si1;
+        ptr[13] = seekable::k_gzip_member_si2;
+        ptr[14] = seekable::k_gzip_member_field_size;
+        ptr[15] = 0;
+        seekable::WriteLE32(ptr + 16, static_cast<uint32_t>(member_size));
+        ptr += header_size + deflated;
+        seekable::WriteLE32(ptr, static_cast<uint32_t>(
+                crc32(crc32(0L, Z_NULL, 0), input.data(), static_cast<uInt>(input.size()))));
+        seekable::WriteLE32(ptr + 4, static_cast<uint32_t>(input.size()));
+        output.resize(member_size);
+        return output;
+    }
+
+    Block EncodeBzip2Stream(const Block &input, int32_t level) {
+        auto capacity = static_cast<unsigned int>(input.size() + input.size() / 100 + 600);
+        Block output(capacity);
+        auto ret = BZ2_bzBuffToBuffCompress(
+                reinterpret_cast<char *>(output.data()), &capacity,
+                const_cast<char *>(reinterpret_cast<const char *>(input.data())),
+                static_cast<unsigned int>(input.size()), level, 0, 0);
+        if (ret != BZ_OK) {
+            throw std::runtime_error("bzip2 compression failed: " + std::to_string(ret));
+        }
+        output.resize(capacity);
+        return output;
+    }
+
+    Block EncodeLz4Frame(const Block &input, int32_t level) {
+        LZ4F_preferences_t preferences{};
+        preferences.frameInfo.blockSizeID = LZ4F_max4MB;
+        preferences.frameInfo.blockMode = LZ4F_blockIndependent;
+        preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        preferences.frameInfo.contentSize = input.size();
+        preferences.compressionLevel = level;
+        Block output(LZ4F_compressFrameBound(input.size(), &preferences));
+        auto n = LZ4F_compressFrame(output.data(), output.size(), input.data(), input.size(),
+                                    &preferences);
+        if (LZ4F_isError(n)) {
+            throw std::runtime_error(
+                    std::string("lz4 compression failed: ") + LZ4F_getErrorName(n));
+        }
+        output.resize(n);
+        return output;
+    }
+}
+
+std::unique_ptr<StreamCompressor> CreateParallelCompressor(
+        CompressionType compression,
+        int32_t compression_level,
+        int32_t threads,
+        const std::string &output_path
+) {
+    switch (compression) {
+        case CompressionType::Gzip: {
+            // 独立 member 不共享字典，块较大时压缩率损失可以忽略
+            auto level = std::clamp(compression_level, 1, 9);
+            return std::make_unique<ParallelBlockCompressor>(
+                    output_path, threads, 1 << 20,
+                    [level](const Block &input) { return EncodeGzipMember(input, level); });
+        }
+        case CompressionType::Bzip2: {
+            // 与 bzip2 自身的块大小（level * 100k）一致
+            auto level = std::clamp(compression_level, 1, 9);
+            return std::make_unique<ParallelBlockCompressor>(
+                    output_path, threads, static_cast<size_t>(level) * 100000,
+                    [level](const Block &input) { return EncodeBzip2Stream(input, level); });
+        }
+        case CompressionType::Lz4: {
+            auto level = std::clamp(compression_level, 1, 9);
+            return std::make_unique<ParallelBlockCompressor>(
+                    output_path, threads, 4 << 20,
+                    [level](const Block &input) { return EncodeLz4Frame(input, level); });
+        }
+        default:
+            return nullptr;
+    }
+}
+
+std::unique_ptr<StreamCompressor> CreateSeekableCompressor(
+        CompressionType compression,
+        int32_t compression_level,
+        int32_t threads,
+        const std::string &output_path
+) {
+    switch (compression) {
+        case CompressionType::Zstd:
+            return std::make_unique<SeekableZstdCompressor>(
+                    output_path, std::clamp(compression_level, 1, 19), threads);
+        case CompressionType::Xz:
+            return std::make_unique<SeekableXzCompressor>(
+                    output_path, std::clamp(compression_level, 0, 9), threads);
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "archive_common.hpp"
+
+/**
+ * 自行实现的压缩输出流
+ * ArchiveBuilder 在需要控制压缩帧布局时（例如可随机访问的 seekable 格式）
+ * 以无压缩过滤器打开 archive，并将格式层输出的数据交给此类压缩后写入文件
+ */
+class StreamCompressor {
+public:
+    explicit StreamCompressor(std::string output_path);
+
+    virtual ~StreamCompressor();
+
+    StreamCompressor(const StreamCompressor &) = delete;
+
+    StreamCompressor &operator=(const StreamCompressor &) = delete;
+
+    /**
+     * 写入未压缩数据
+     * @throw std::runtime_error 压缩或写入失败
+     */
+    virtual void Write(const void *data, size_t length) = 0;
+
+    /**
+     * 条目边界提示，实现可以在此处结束当前帧以便按条目随机访问
+     */
+    virtual void EndEntry() {}
+
+    /**
+     * 刷新剩余数据并写入尾部结构，随后关闭输出文件
+     * @throw std::runtime_error 压缩或写入失败
+     */
+    void Finish();
+
+    /**
+     * 已写出的压缩字节数
+     */
+    [[nodiscard]] uint64_t BytesWritten() const { return bytes_written_; }
+
+protected:
+    virtual void FinishStream() = 0;
+
+    void WriteOutput(const void *data, size_t length);
+
+private:
+    int fd_ = -1;
+    std::string output_path_;
+    uint64_t bytes_written_ = 0;
+};
+
+/**
+ * 创建可随机访问的压缩输出流，仅支持 Zstd 与 Xz：
+ * - Zstd: 按条目边界切分独立帧，末尾写入 zstd seekable format 的 seek table
+ * - Xz: 按条目边界结束 block，由 xz index 记录每个 block 的位置
+ * @param threads 压缩线程数，大于1时 zstd 使用 worker 线程、xz 使用多线程 block 编码
+ * @return 压缩类型不支持 seekable 时返回nullptr
+ * @throw std::runtime_error 无法创建输出文件或初始化压缩器
+ */
+std::unique_ptr<StreamCompressor> CreateSeekableCompressor(
+        CompressionType compression,
+        int32_t compression_level,
+        int32_t threads,
+        const std::string &output_path
+);
+
+/**
+ * 创建多线程分块压缩输出流，支持 Gzip、Bzip2 与 Lz4，输出可被标准单线程解码器读取：
+ * - Gzip: 每块一个独立的 gzip member，FEXTRA 中记录 member 长度便于并行解压定位
+ * - Bzip2: 每块一个独立的 bzip2 stream，块大小为 level * 100k
+ * - Lz4: 每块一个独立的 lz4 frame
+ * @return 压缩类型不支持分块并行时返回nullptr
+ * @throw std::runtime_error 无法创建输出文件
+ */
+std::unique_ptr<StreamCompressor> CreateParallelCompressor(
+        CompressionType compression,
+        int32_t compression_level,
+        int32_t threads,
+        const std::string &output_path
+);
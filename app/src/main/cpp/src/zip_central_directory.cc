@@ -0,0 +1,336 @@
+#include "zip_central_directory.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <archive_entry.h>
+#include <zlib.h>
+
+namespace {
+    constexpr size_t k_eocd_size = 22;
+    constexpr size_t k_eocd64_size = 56;
+    constexpr size_t k_eocd64_locator_size = 20;
+    constexpr size_t k_central_header_size = 46;
+    // EOCD 之后最多跟随 65535 字节的注释
+    constexpr size_t k_max_eocd_search = k_eocd_size + 0xFFFF;
+
+    // 通用标志位：中央目录已加密
+    constexpr uint16_t k_flag_encrypted_directory = 1 << 13;
+
+    // 生成条目的主机系统
+    constexpr uint8_t k_system_msdos = 0;
+    constexpr uint8_t k_system_unix = 3;
+
+    bool ReadFully(int fd, void *buffer, size_t length, uint64_t offset) {
+        auto ptr = static_cast<uint8_t *>(buffer);
+        while (length > 0) {
+            auto n = pread64(fd, ptr, length, static_cast<off64_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            ptr += n;
+            length -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    struct FdCloser {
+        int fd;
+
+        ~FdCloser() { if (fd >= 0) close(fd); }
+    };
+
+    uint16_t ReadLE16(const uint8_t *src) {
+        return static_cast<uint16_t>(src[0] | (src[1] << 8));
+    }
+
+    uint32_t ReadLE32(const uint8_t *src) {
+        return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+               (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+    }
+
+    uint64_t ReadLE64(const uint8_t *src) {
+        return static_cast<uint64_t>(ReadLE32(src)) | (static_cast<uint64_t>(ReadLE32(src + 4)) << 32);
+    }
+
+    bool HasSignature(const uint8_t *p, char a, char b) {
+        return p[0] == 'P' && p[1] == 'K' && p[2] == a && p[3] == b;
+    }
+
+    /**
+     * MS-DOS 日期时间（本地时间）转换为 Unix 时间，与 libarchive 的 dos_to_unix 相同
+     */
+    int64_t DosToUnix(uint32_t dos_time) {
+        auto time = static_cast<uint16_t>(dos_time & 0xFFFF);
+        auto date = static_cast<uint16_t>(dos_time >> 16);
+        struct tm ts{};
+        ts.tm_year = ((date >> 9) & 0x7f) + 80;
+        ts.tm_mon = ((date >> 5) & 0x0f) - 1;
+        ts.tm_mday = date & 0x1f;
+        ts.tm_hour = (time >> 11) & 0x1f;
+        ts.tm_min = (time >> 5) & 0x3f;
+        ts.tm_sec = (time << 1) & 0x3e;
+        ts.tm_isdst = -1;
+        auto t = mktime(&ts);
+        return t == static_cast<time_t>(-1) ? INT32_MAX : static_cast<int64_t>(t);
+    }
+
+    /**
+     * mktime 需要查询时区规则，开销远大于解析条目本身；同一归档中的条目常常共享时间戳，缓存最近一次结果
+     */
+    class DosTimeConverter {
+    public:
+        int64_t operator()(uint32_t dos_time) {
+            if (!valid_ || dos_time != dos_time_) {
+                dos_time_ = dos_time;
+                unix_time_ = DosToUnix(dos_time);
+                valid_ = true;
+            }
+            return unix_time_;
+        }
+
+    private:
+        bool valid_ = false;
+        uint32_t dos_time_ = 0;
+        int64_t unix_time_ = 0;
+    };
+
+    struct CentralEntry {
+        std::string pathname;
+        uint32_t mode;
+        int64_t mtime;
+        // 扩展字段中带有 Unix 修改时间，无需再转换 MS-DOS 时间
+        bool has_unix_mtime;
+        uint64_t compressed_size;
+        uint64_t uncompressed_size;
+        uint64_t local_header_offset;
+    };
+
+    /**
+     * 解析中央目录条目的扩展字段：ZIP64 大小与偏移、扩展时间戳与 Unicode 路径
+     * @return 扩展字段越界时返回false
+     */
+    bool ProcessExtra(const uint8_t *p, size_t length, CentralEntry &entry) {
+        size_t offset = 0;
+        while (offset + 4 <= length) {
+            auto id = ReadLE16(p + offset);
+            size_t data_size = ReadLE16(p + offset + 2);
+            offset += 4;
+            if (offset + data_size > length) return false;
+            const uint8_t *data = p + offset;
+            switch (id) {
+                case 0x0001: {
+                    // ZIP64 扩展信息：只包含在主字段中被置为 0xFFFFFFFF 的值，顺序固定
+                    size_t pos = 0;
+                    for (auto *field: {&entry.uncompressed_size, &entry.compressed_size,
+                                       &entry.local_header_offset}) {
+                        if (*field != 0xFFFFFFFF) continue;
+                        if (pos + 8 > data_size) return false;
+                        *field = ReadLE64(data + pos);
+                        if (*field > static_cast<uint64_t>(INT64_MAX)) return false;
+                        pos += 8;
+                    }
+                    break;
+                }
+                case 0x5455:
+                    // 扩展时间戳 "UT"，中央目录中只携带修改时间
+                    if (data_size >= 5 && (data[0] & 0x01)) {
+                        entry.mtime = ReadLE32(data + 1);
+                        entry.has_unix_mtime = true;
+                    }
+                    break;
+                case 0x5855:
+                    // 旧版 Info-ZIP Unix 字段 "UX"：atime, mtime
+                    if (data_size >= 8) {
+                        entry.mtime = ReadLE32(data + 4);
+                        entry.has_unix_mtime = true;
+                    }
+                    break;
+                case 0x7075: {
+                    // Info-ZIP Unicode 路径，仅在与主字段路径的 CRC32 一致时采用
+                    if (data_size < 5) break;
+                    auto name_crc = crc32(0L, reinterpret_cast<const Bytef *>(entry.pathname.data()),
+                                          static_cast<uInt>(entry.pathname.size()));
+                    if (name_crc != ReadLE32(data + 1)) break;
+                    entry.pathname.assign(reinterpret_cast<const char *>(data + 5), data_size - 5);
+                    break;
+                }
+                default:
+                    break;
+            }
+            offset += data_size;
+        }
+        return true;
+    }
+
+    /**
+     * 按 libarchive 读取本地文件头后的规则确定条目类型并规范路径
+     */
+    ArchiveExtractor::ArchiveEntry ToArchiveEntry(CentralEntry &&central, uint8_t system) {
+        auto &path = central.pathname;
+        // Windows 压缩软件可能使用反斜杠作为分隔符
+        if (system == k_system_msdos && path.find('/') == std::string::npos) {
+            std::replace(path.begin(), path.end(), '\\', '/');
+        }
+
+        auto filetype = central.mode & AE_IFMT;
+        if (filetype == AE_IFIFO) filetype = AE_IFREG;
+        bool has_slash = !path.empty() && path.back() == '/';
+        if (filetype != AE_IFDIR) {
+            if (has_slash) {
+                filetype = AE_IFDIR;
+            } else if (filetype == 0) {
+                filetype = AE_IFREG;
+            }
+        }
+        if (filetype == AE_IFDIR && !path.empty() && !has_slash) path += '/';
+
+        // 符号链接的目标保存在数据中，libarchive 将其大小报告为0
+        auto size = filetype == AE_IFLNK ? 0 : static_cast<int64_t>(central.uncompressed_size);
+        auto offset = static_cast<int64_t>(central.local_header_offset);
+        return ArchiveExtractor::ArchiveEntry{
+                .pathname = std::move(path),
+                .mode = static_cast<mode_t>(filetype),
+                .modify_time_ms = central.mtime * 1000,
+                .entry_size = size,
+                .compressed_size = static_cast<int64_t>(central.compressed_size),
+                .compressed_offset = offset,
+                .uncompressed_offset = offset
+        };
+    }
+}
+
+std::unique_ptr<ZipCentralDirectory> ZipCentralDirectory::Open(const std::string &archive_path) {
+    int fd = open(archive_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    FdCloser closer{fd};
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(k_eocd_size)) return nullptr;
+    auto file_size = static_cast<uint64_t>(st.st_size);
+
+    // 只处理从文件开头就是 zip 的归档；自解压程序或嵌在其它格式中的 zip 交给 libarchive 判断
+    uint8_t magic[4];
+    if (!ReadFully(fd, magic, sizeof(magic), 0)) return nullptr;
+    if (!HasSignature(magic, 3, 4) && !HasSignature(magic, 5, 6)) return nullptr;
+
+    // 自尾部向前查找最后一个 EOCD
+    auto tail_size = static_cast<size_t>(std::min<uint64_t>(file_size, k_max_eocd_search));
+    auto tail_offset = file_size - tail_size;
+    std::vector<uint8_t> tail(tail_size);
+    if (!ReadFully(fd, tail.data(), tail.size(), tail_offset)) return nullptr;
+    auto eocd_pos = static_cast<ptrdiff_t>(tail_size - k_eocd_size);
+    while (eocd_pos >= 0 && !HasSignature(tail.data() + eocd_pos, 5, 6)) --eocd_pos;
+    if (eocd_pos < 0) return nullptr;
+    const uint8_t *eocd = tail.data() + eocd_pos;
+
+    // 分卷归档
+    if (ReadLE16(eocd + 4) != 0 || ReadLE16(eocd + 6) != 0 ||
+        ReadLE16(eocd + 8) != ReadLE16(eocd + 10)) {
+        return nullptr;
+    }
+    uint64_t cd_size = ReadLE32(eocd + 12);
+    uint64_t cd_offset = ReadLE32(eocd + 16);
+    uint64_t cd_end = tail_offset + static_cast<uint64_t>(eocd_pos);
+
+    // ZIP64：EOCD 之前紧跟 locator，指向 ZIP64 EOCD 记录
+    if (eocd_pos >= static_cast<ptrdiff_t>(k_eocd64_locator_size) &&
+        HasSignature(eocd - k_eocd64_locator_size, 6, 7)) {
+        const uint8_t *locator = eocd - k_eocd64_locator_size;
+        if (ReadLE32(locator + 4) != 0 || ReadLE32(locator + 16) != 1) return nullptr;
+        auto eocd64_offset = ReadLE64(locator + 8);
+        uint8_t eocd64[k_eocd64_size];
+        if (eocd64_offset + k_eocd64_size > cd_end ||
+            !ReadFully(fd, eocd64, sizeof(eocd64), eocd64_offset) ||
+            !HasSignature(eocd64, 6, 6)) {
+            return nullptr;
+        }
+        if (ReadLE32(eocd64 + 16) != 0 || ReadLE32(eocd64 + 20) != 0 ||
+            ReadLE64(eocd64 + 24) != ReadLE64(eocd64 + 32)) {
+            return nullptr;
+        }
+        cd_size = ReadLE64(eocd64 + 40);
+        cd_offset = ReadLE64(eocd64 + 48);
+        cd_end = eocd64_offset;
+    }
+    if (cd_size > cd_end || cd_offset > cd_end - cd_size) return nullptr;
+
+    // 归档前部被附加了数据时，记录的偏移整体偏小
+    auto cd_start = cd_end - cd_size;
+    auto correction = static_cast<int64_t>(cd_start - cd_offset);
+
+    std::vector<uint8_t> directory(static_cast<size_t>(cd_size));
+    if (!ReadFully(fd, directory.data(), directory.size(), cd_start)) return nullptr;
+    auto result = std::unique_ptr<ZipCentralDirectory>(new ZipCentralDirectory());
+    if (!result->Parse(directory.data(), directory.size(), correction)) return nullptr;
+    return result;
+}
+
+bool ZipCentralDirectory::Parse(const uint8_t *data, size_t size, int64_t correction) {
+    struct Parsed {
+        ArchiveExtractor::ArchiveEntry entry;
+        size_t order;
+    };
+    std::vector<Parsed> parsed;
+    DosTimeConverter to_unix_time;
+    size_t pos = 0;
+    while (pos + 4 <= size && !HasSignature(data + pos, 5, 6) && !HasSignature(data + pos, 6, 6)) {
+        if (!HasSignature(data + pos, 1, 2) || pos + k_central_header_size > size) return false;
+        const uint8_t *p = data + pos;
+        auto system = p[5];
+        auto flags = ReadLE16(p + 8);
+        // 中央目录被加密时其中的字段不可信
+        if (flags & k_flag_encrypted_directory) return false;
+        size_t name_length = ReadLE16(p + 28);
+        size_t extra_length = ReadLE16(p + 30);
+        size_t comment_length = ReadLE16(p + 32);
+        auto external_attributes = ReadLE32(p + 38);
+        size_t record_size = k_central_header_size + name_length + extra_length + comment_length;
+        if (pos + record_size > size) return false;
+
+        CentralEntry central{
+                .pathname = std::string(reinterpret_cast<const char *>(p + k_central_header_size),
+                                        name_length),
+                .mode = 0,
+                .mtime = 0,
+                .has_unix_mtime = false,
+                .compressed_size = ReadLE32(p + 20),
+                .uncompressed_size = ReadLE32(p + 24),
+                .local_header_offset = ReadLE32(p + 42)
+        };
+        // 未设置 UTF-8 标志的路径按原始字节保留，与 libarchive 在 UTF-8 locale 下的结果一致
+        if (system == k_system_unix) {
+            central.mode = external_attributes >> 16;
+        } else if (system == k_system_msdos) {
+            central.mode = (external_attributes & 0x10) ? AE_IFDIR : AE_IFREG;
+        }
+        if (!ProcessExtra(p + k_central_header_size + name_length, extra_length, central)) {
+            return false;
+        }
+        if (!central.has_unix_mtime) central.mtime = to_unix_time(ReadLE32(p + 12));
+        central.local_header_offset += correction;
+        parsed.push_back(Parsed{ToArchiveEntry(std::move(central), system), parsed.size()});
+        pos += record_size;
+    }
+    if (pos < size && pos + 4 > size) return false;
+
+    // libarchive 按本地文件头偏移遍历条目，偏移重复的条目只保留中央目录中的第一个
+    std::sort(parsed.begin(), parsed.end(), [](const Parsed &a, const Parsed &b) {
+        if (a.entry.compressed_offset != b.entry.compressed_offset) {
+            return a.entry.compressed_offset < b.entry.compressed_offset;
+        }
+        return a.order < b.order;
+    });
+    entries_.reserve(parsed.size());
+    for (auto &item: parsed) {
+        if (!entries_.empty() && entries_.back().compressed_offset == item.entry.compressed_offset) {
+            continue;
+        }
+        entries_.push_back(std::move(item.entry));
+    }
+    return true;
+}
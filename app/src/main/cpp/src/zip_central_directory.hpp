@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive_extractor.hpp"
+
+/**
+ * zip 中央目录读取器
+ * 只读取文件尾部的 EOCD 与中央目录即可得到全部条目，不访问任何本地文件头；
+ * libarchive 的 seekable zip 读取器虽然同样先读取中央目录，但每个条目仍会定位并解析本地文件头，
+ * 条目数量很多时列表耗时主要花在这些分散的读取上
+ * 路径、类型与修改时间的推导规则与 libarchive 保持一致
+ */
+class ZipCentralDirectory {
+public:
+    /**
+     * 读取归档的中央目录
+     * 不以 zip 本地文件头开头、分卷、中央目录被加密或结构损坏时返回nullptr，由调用方回退到 libarchive
+     */
+    static std::unique_ptr<ZipCentralDirectory> Open(const std::string &archive_path);
+
+    /**
+     * 按本地文件头偏移排序的条目（与 libarchive seekable 读取顺序相同）
+     * compressed_offset 与 uncompressed_offset 均为本地文件头的偏移
+     */
+    [[nodiscard]] std::vector<ArchiveExtractor::ArchiveEntry> &entries() { return entries_; }
+
+private:
+    std::vector<ArchiveExtractor::ArchiveEntry> entries_;
+
+    ZipCentralDirectory() = default;
+
+    bool Parse(const uint8_t *data, size_t size, int64_t correction);
+};
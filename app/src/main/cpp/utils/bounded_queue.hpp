@@ -0,0 +1,113 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * 有界阻塞队列（单生产者/单消费者场景）
+ * 记录生产者等待空位、消费者等待数据的累计时间，用于观察流水线两端的背压
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue &) = delete;
+
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /**
+     * 入队，队列已满时阻塞
+     * @return 队列已关闭时返回false，item 不会入队
+     */
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!closed_ && items_.size() >= capacity_) {
+            auto start = std::chrono::steady_clock::now();
+            not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+            push_wait_ns_ += ElapsedNanos(start);
+        }
+        if (closed_) return false;
+        items_.push_back(std::move(item));
+        if (items_.size() > peak_size_) peak_size_ = items_.size();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * 出队，队列为空时阻塞
+     * @return 队列已关闭且没有剩余元素时返回false
+     */
+    bool Pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!closed_ && items_.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+            pop_wait_ns_ += ElapsedNanos(start);
+        }
+        if (items_.empty()) return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * 关闭队列：唤醒所有等待方，之后的 Push 失败，Pop 取完剩余元素后失败
+     */
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    /**
+     * 丢弃所有未处理的元素并关闭队列
+     */
+    void Abort() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        items_.clear();
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    [[nodiscard]] size_t PeakSize() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return peak_size_;
+    }
+
+    [[nodiscard]] uint64_t PushWaitNanos() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return push_wait_ns_;
+    }
+
+    [[nodiscard]] uint64_t PopWaitNanos() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pop_wait_ns_;
+    }
+
+private:
+    size_t capacity_;
+    std::deque<T> items_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    bool closed_ = false;
+    size_t peak_size_ = 0;
+    uint64_t push_wait_ns_ = 0;
+    uint64_t pop_wait_ns_ = 0;
+
+    static uint64_t ElapsedNanos(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+    }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * 顺序读取整个文件并把数据块直接交给消费者，避免经过 ifstream 的额外拷贝
+ * 使用可复用的对齐缓冲区 pread；不使用 mmap，源文件在读取期间被截断时只会读到较短的数据，
+ * 而不会因访问映射页产生 SIGBUS
+ * 缓冲区在多次 ReadFile 之间复用，对象本身不是线程安全的
+ */
+class FileReader {
+public:
+    // pread 缓冲区大小与对齐
+    static constexpr size_t k_buffer_size = 1024 * 1024;
+    static constexpr size_t k_buffer_alignment = 4096;
+    // 不小于该大小的文件提示内核顺序预读
+    static constexpr uint64_t k_sequential_advice_threshold = 8 * 1024 * 1024;
+
+    FileReader() = default;
+
+    FileReader(const FileReader &) = delete;
+
+    FileReader &operator=(const FileReader &) = delete;
+
+    /**
+     * 读取打开时文件大小范围内的数据，之后文件增长的部分不会被读取
+     * @param consumer void(const void *data, size_t length)，数据仅在回调期间有效
+     * @throw std::runtime_error 打开或读取失败
+     */
+    template<typename Consumer>
+    void ReadFile(const std::string &path, Consumer &&consumer) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+        std::unique_ptr<int, FdCloser> guard(&fd);
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) throw std::runtime_error("Cannot stat file: " + path);
+        auto size = static_cast<uint64_t>(std::max<off_t>(0, st.st_size));
+        if (size >= k_sequential_advice_threshold) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ReadBuffered(fd, path, size, consumer);
+    }
+
+private:
+    struct FreeDeleter {
+        void operator()(void *p) const { free(p); }
+    };
+
+    struct FdCloser {
+        void operator()(const int *fd) const { close(*fd); }
+    };
+
+    std::unique_ptr<void, FreeDeleter> buffer_;
+
+    template<typename Consumer>
+    void ReadBuffered(int fd, const std::string &path, uint64_t size, Consumer &consumer) {
+        if (!buffer_) {
+            void *p = nullptr;
+            if (posix_memalign(&p, k_buffer_alignment, k_buffer_size) != 0) {
+                throw std::runtime_error("Failed to allocate read buffer");
+            }
+            buffer_.reset(p);
+        }
+        uint64_t offset = 0;
+        while (offset < size) {
+            auto length = static_cast<size_t>(std::min<uint64_t>(k_buffer_size, size - offset));
+            auto n = pread64(fd, buffer_.get(), length, static_cast<off64_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                throw std::runtime_error("Read error for " + path + ": " + strerror(errno));
+            }
+            // 文件在读取过程中被截断
+            if (n == 0) break;
+            consumer(static_cast<const void *>(buffer_.get()), static_cast<size_t>(n));
+            offset += static_cast<uint64_t>(n);
+        }
+    }
+};
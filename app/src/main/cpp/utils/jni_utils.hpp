@@ -253,6 +253,18 @@ static std::vector<std::string> JStringArrayToCVector(JNIEnv *env, jobjectArray
     return result;
 }
 
+/**
+ * @brief 基于 Java int[] 构建 std::vector<int32_t>
+ */
+inline std::vector<int32_t> JIntArrayToCVector(JNIEnv *env, jintArray int_array) {
+    std::vector<int32_t> result;
+    if (int_array == nullptr) return result;
+    auto length = env->GetArrayLength(int_array);
+    result.resize(static_cast<size_t>(length));
+    env->GetIntArrayRegion(int_array, 0, length, reinterpret_cast<jint *>(result.data()));
+    return result;
+}
+
 /**
  * @brief 将 Java List<String> 转换为 std::vector<std::string>
  */
@@ -336,84 +348,105 @@ inline auto CreateArchiveTestResult(
 }
 
 /**
- * @brief 创建 ArchiveEntry Kotlin 对象
+ * JNI_OnLoad 中缓存的类与方法 ID，类均为全局引用，在进程生命周期内有效
+ */
+struct JniCache {
+    jclass native_callback_class = nullptr;
+    jmethodID native_callback_on_progress = nullptr;
+    jclass native_listing_callback_class = nullptr;
+    jmethodID native_listing_callback_on_entries = nullptr;
+    jclass cancellation_exception_class = nullptr;
+};
+
+inline JniCache &GetJniCache() {
+    static JniCache cache;
+    return cache;
+}
+
+/**
+ * 在 JNI_OnLoad 中调用（此时 FindClass 使用应用的 ClassLoader）
+ * @return 回调接口的类或方法查找失败时返回false
  */
-inline auto CreateArchiveEntry(
+inline bool InitJniCache(JNIEnv *env) {
+    auto &cache = GetJniCache();
+    auto find_global_class = [env](const char *name) -> jclass {
+        auto local = FindClass(env, name);
+        if (!local) return nullptr;
+        return static_cast<jclass>(env->NewGlobalRef(local.get()));
+    };
+    cache.native_callback_class = find_global_class("cc/kafuu/archandler/libs/jni/NativeCallback");
+    cache.native_listing_callback_class = find_global_class(
+            "cc/kafuu/archandler/libs/jni/NativeListingCallback");
+    if (!cache.native_callback_class || !cache.native_listing_callback_class) return false;
+    // Kotlin 的 CancellationException 是该类的类型别名；找不到时不视为失败，回调异常只会被清除
+    cache.cancellation_exception_class = find_global_class("java/util/concurrent/CancellationException");
+    if (!cache.cancellation_exception_class) env->ExceptionClear();
+    cache.native_callback_on_progress = env->GetMethodID(
+            cache.native_callback_class, "onProgress", "(Ljava/lang/String;II)Z");
+    cache.native_listing_callback_on_entries = env->GetMethodID(
+            cache.native_listing_callback_class, "onEntries", "(Ljava/nio/ByteBuffer;)Z");
+    return cache.native_callback_on_progress != nullptr &&
+           cache.native_listing_callback_on_entries != nullptr;
+}
+
+/**
+ * 处理 Kotlin 回调的返回值与异常
+ * @throw OperationCancelledException 回调返回 false 或抛出 Kotlin 的 CancellationException
+ */
+inline void CheckCallbackResult(JNIEnv *env, jboolean proceed) {
+    if (env->ExceptionCheck()) {
+        // 检查是否是 CancellationException
+        auto exception = WrapLocalRef(env, env->ExceptionOccurred());
+        auto cancellation_exception_class = GetJniCache().cancellation_exception_class;
+        if (exception && cancellation_exception_class &&
+            env->IsInstanceOf(exception.get(), cancellation_exception_class)) {
+            env->ExceptionClear();
+            throw OperationCancelledException("Operation cancelled by user");
+        }
+        // 其他异常，清除并记录
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+        return;
+    }
+    if (proceed == JNI_FALSE) throw OperationCancelledException("Operation cancelled by user");
+}
+
+/**
+ * 调用 NativeCallback.onProgress
+ * @throw OperationCancelledException 回调返回 false 或抛出 Kotlin 的 CancellationException
+ */
+static void CallNativeCallback(
         JNIEnv *env,
+        jobject listener,
         const std::string &path,
-        const std::string &name,
-        bool is_directory,
-        int64_t size,
-        int64_t compressed_size,
-        int64_t last_modified
+        jint index,
+        jint total
 ) {
-    auto entry_class_ptr = FindClass(env, "cc/kafuu/archandler/libs/archive/model/ArchiveEntry");
-    if (!entry_class_ptr) return WrapLocalRef(env, static_cast<jobject>(nullptr));
-    jmethodID entry_ctor = env->GetMethodID(
-            entry_class_ptr.get(),
-            "<init>",
-            "(Ljava/lang/String;Ljava/lang/String;ZJJJ)V"
-    );
-    if (!entry_ctor) return WrapLocalRef(env, static_cast<jobject>(nullptr));
+    if (!listener) return;
+    const auto &cache = GetJniCache();
+    if (!cache.native_callback_on_progress) return;
+
     auto j_path = CreateJavaString(env, path);
-    auto j_name = CreateJavaString(env, name);
-    return WrapLocalRef(
-            env,
-            env->NewObject(
-                    entry_class_ptr.get(),
-                    entry_ctor,
-                    j_path.get(),
-                    j_name.get(),
-                    is_directory ? JNI_TRUE : JNI_FALSE,
-                    static_cast<jlong>(size),
-                    static_cast<jlong>(compressed_size),
-                    static_cast<jlong>(last_modified)
-            )
-    );
+    auto proceed = env->CallBooleanMethod(
+            listener, cache.native_callback_on_progress, j_path.get(), index, total);
+    CheckCallbackResult(env, proceed);
 }
 
 /**
- * 调用 NativeCallback
- * @throw OperationCancelledException 如果检测到 Kotlin 的 CancellationException
+ * 调用 NativeListingCallback.onEntries，buffer 只在回调期间有效
+ * @throw OperationCancelledException 回调返回 false 或抛出 Kotlin 的 CancellationException
  */
-static void CallNativeCallback(JNIEnv *env, jobject listener, const std::vector<jobject> &args) {
+inline void CallNativeListingCallback(JNIEnv *env, jobject listener, void *data, size_t size) {
     if (!listener) return;
+    const auto &cache = GetJniCache();
+    if (!cache.native_listing_callback_on_entries) return;
 
-    auto callback_class_ptr = WrapLocalRef(env, env->GetObjectClass(listener));
-    if (!callback_class_ptr) return;
-
-    auto invoke_method = env->GetMethodID(callback_class_ptr.get(), "invoke",
-                                          "([Ljava/lang/Object;)V");
-    if (!invoke_method) return;
-
-    auto object_class_ptr = FindClass(env, "java/lang/Object");
-    auto arg_array_ptr = WrapLocalRef(
-            env,
-            env->NewObjectArray(static_cast<jsize>(args.size()), object_class_ptr.get(), nullptr)
-    );
-
-    jsize i = 0;
-    for (auto obj: args) {
-        env->SetObjectArrayElement(arg_array_ptr.get(), i++, obj);
-    }
-
-    env->CallVoidMethod(listener, invoke_method, arg_array_ptr.get());
-
-    if (env->ExceptionCheck()) {
-        // 检查是否是 CancellationException
-        auto exception = env->ExceptionOccurred();
-        if (exception) {
-            auto cancellation_exception_class = FindClass(env, "kotlin/coroutines/cancellation/CancellationException");
-            if (cancellation_exception_class) {
-                auto is_instance = env->IsInstanceOf(exception, cancellation_exception_class.get());
-                if (is_instance == JNI_TRUE) {
-                    env->ExceptionClear();
-                    throw OperationCancelledException("Operation cancelled by user");
-                }
-            }
-            // 其他异常，清除并记录
-            env->ExceptionDescribe();
-            env->ExceptionClear();
-        }
+    auto j_buffer = WrapLocalRef(env, env->NewDirectByteBuffer(data, static_cast<jlong>(size)));
+    if (!j_buffer) {
+        env->ExceptionClear();
+        throw std::runtime_error("Failed to create entry listing buffer");
     }
+    auto proceed = env->CallBooleanMethod(
+            listener, cache.native_listing_callback_on_entries, j_buffer.get());
+    CheckCallbackResult(env, proceed);
 }
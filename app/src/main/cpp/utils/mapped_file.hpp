@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * 只读内存映射文件（RAII）
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this == &other) return *this;
+        Reset();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        return *this;
+    }
+
+    ~MappedFile() { Reset(); }
+
+    /**
+     * 映射整个文件，失败或文件为空时返回false
+     */
+    bool Open(const std::string &path) {
+        Reset();
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st{};
+        bool ok = fstat(fd, &st) == 0 && st.st_size > 0;
+        if (ok) {
+            void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE,
+                              fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const uint8_t *>(addr);
+                size_ = static_cast<size_t>(st.st_size);
+            } else {
+                ok = false;
+            }
+        }
+        close(fd);
+        return ok;
+    }
+
+    void Reset() {
+        if (data_) munmap(const_cast<uint8_t *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    [[nodiscard]] const uint8_t *data() const { return data_; }
+
+    [[nodiscard]] size_t size() const { return size_; }
+
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+private:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+};
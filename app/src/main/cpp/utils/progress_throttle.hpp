@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+/**
+ * 进度回调节流：相邻两次上报至少间隔 interval，期间的进度只保留最新一条
+ * 结束时通过 Flush 补发最后一条被合并的进度，保证调用方能看到最终状态
+ */
+class ProgressThrottle {
+public:
+    static constexpr std::chrono::milliseconds k_default_interval{16};
+
+    explicit ProgressThrottle(std::chrono::milliseconds interval = k_default_interval)
+            : interval_(interval) {}
+
+    /**
+     * @param emit void(const std::string &path, size_t index, size_t total)
+     */
+    template<typename Emit>
+    void Report(const std::string &path, size_t index, size_t total, Emit &&emit) {
+        auto now = std::chrono::steady_clock::now();
+        if (has_emitted_ && now - last_emit_ < interval_) {
+            pending_path_ = path;
+            pending_index_ = index;
+            pending_total_ = total;
+            has_pending_ = true;
+            return;
+        }
+        has_emitted_ = true;
+        has_pending_ = false;
+        last_emit_ = now;
+        emit(path, index, total);
+    }
+
+    template<typename Emit>
+    void Flush(Emit &&emit) {
+        if (!has_pending_) return;
+        has_pending_ = false;
+        last_emit_ = std::chrono::steady_clock::now();
+        emit(pending_path_, pending_index_, pending_total_);
+    }
+
+private:
+    std::chrono::milliseconds interval_;
+    std::chrono::steady_clock::time_point last_emit_{};
+    bool has_emitted_ = false;
+    bool has_pending_ = false;
+    std::string pending_path_;
+    size_t pending_index_ = 0;
+    size_t pending_total_ = 0;
+};
@@ -16,7 +16,6 @@ import cc.kafuu.archandler.libs.archive.ArchiveManager
 import cc.kafuu.archandler.libs.archive.IArchive
 import cc.kafuu.archandler.libs.archive.IPasswordProvider
 import cc.kafuu.archandler.libs.archive.model.ArchivePasswordException
-import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
 import cc.kafuu.archandler.libs.core.AppViewEvent
 import cc.kafuu.archandler.libs.core.CoreViewModelWithEvent
 import cc.kafuu.archandler.libs.core.UiIntentObserver
@@ -31,6 +30,7 @@ import cc.kafuu.archandler.libs.utils.DeferredResult
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.currentCoroutineContext
 import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.isActive
 import kotlinx.coroutines.withContext
 import org.koin.core.component.KoinComponent
 import org.koin.core.component.get
@@ -56,9 +56,6 @@ class ArchiveViewViewModel : CoreViewModelWithEvent<ArchiveViewUiIntent, Archive
     // 当前打开的压缩包实例
     private var mArchive: IArchive? = null
 
-    // 缓存的压缩包完整文件列表
-    private var mCachedAllEntries: List<ArchiveEntry>? = null
-
     // 目录路径栈，用于返回导航
     private val mPathStack = Stack<String>()
 
@@ -143,65 +140,33 @@ class ArchiveViewViewModel : CoreViewModelWithEvent<ArchiveViewUiIntent, Archive
             dialogState = ArchiveViewDialogState.None
         )?.setup()
 
-        // 缓存完整的文件列表
-        mCachedAllEntries = runCatching {
-            archive.list("")
-        }.getOrNull() ?: emptyList()
-
         loadEntries("")
     }
 
     /**
      * 加载条目列表
+     * 首次加载时归档会构建目录树，期间先显示已读到的条目；之后只获取当前目录的可见分页
      */
-    private fun loadEntries(currentPath: String) {
-        val allEntries = mCachedAllEntries ?: return
-
-        // 过滤出当前路径下的直接子项
-        val normalizedPath = if (currentPath.isEmpty()) {
-            ""
-        } else {
-            currentPath.trimEnd('/') + "/"
-        }
-
-        val currentEntries = if (currentPath.isEmpty()) {
-            // 根目录：显示所有顶级项
-            allEntries.filter { entry ->
-                val pathParts = entry.path.split('/').filter { it.isNotEmpty() }
-                pathParts.size == 1
-            }
-        } else {
-            // 子目录：显示指定路径下的直接子项
-            val pathPrefix = normalizedPath
-            val seenPaths = mutableSetOf<String>()
-
-            allEntries.filter { entry ->
-                val entryPath = entry.path.trimEnd('/') + "/"
-                entryPath.startsWith(pathPrefix) && entry.path != currentPath.trimEnd('/')
-            }.mapNotNull { entry ->
-                val relativePath = entry.path.removePrefix(pathPrefix)
-                val pathParts = relativePath.split('/').filter { it.isNotEmpty() }
-                if (pathParts.isEmpty()) return@mapNotNull null
-
-                val firstPart = pathParts[0]
-                val childPath = if (currentPath.isEmpty()) firstPart else "$currentPath/$firstPart"
-
-                // 避免重复
-                if (seenPaths.contains(childPath)) return@mapNotNull null
-                seenPaths.add(childPath)
-
-                // 创建一个新的条目，代表直接子项
-                entry.copy(
-                    path = childPath,
-                    name = firstPart
-                )
+    private suspend fun loadEntries(currentPath: String) {
+        val archive = mArchive ?: return
+        val currentEntries = runCatching {
+            withContext(Dispatchers.IO) {
+                val ctx = currentCoroutineContext()
+                archive.list(currentPath) { partial ->
+                    getOrNull<ArchiveViewUiState.Normal>()?.copy(
+                        currentPath = currentPath,
+                        entries = partial,
+                        loadState = ArchiveViewLoadState.ScanningEntries
+                    )?.setup()
+                    ctx.isActive
+                }
             }
-        }
+        }.getOrNull() ?: emptyList()
         val state = getOrNull<ArchiveViewUiState.Normal>()
             ?: ArchiveViewUiState.Normal(archiveFile = File(""))
         state.copy(
             currentPath = currentPath,
-            entries = currentEntries.sortedWith(compareBy<ArchiveEntry> { !it.isDirectory }.thenBy { it.name }),
+            entries = currentEntries,
             loadState = ArchiveViewLoadState.None
         ).setup()
     }
@@ -210,7 +175,7 @@ class ArchiveViewViewModel : CoreViewModelWithEvent<ArchiveViewUiIntent, Archive
      * 返回操作
      */
     @UiIntentObserver(ArchiveViewUiIntent.Back::class)
-    private fun onBack() {
+    private suspend fun onBack() {
         val uiState = getOrNull<ArchiveViewUiState.Normal>() ?: run {
             ArchiveViewUiState.Finished.setup()
             return
@@ -243,7 +208,7 @@ class ArchiveViewViewModel : CoreViewModelWithEvent<ArchiveViewUiIntent, Archive
      * 条目选择
      */
     @UiIntentObserver(ArchiveViewUiIntent.EntrySelected::class)
-    private fun onEntrySelected(intent: ArchiveViewUiIntent.EntrySelected) {
+    private suspend fun onEntrySelected(intent: ArchiveViewUiIntent.EntrySelected) {
         val entry = intent.entry
         if (!entry.isDirectory) return
         val newPath = if (getOrNull<ArchiveViewUiState.Normal>()?.currentPath?.isEmpty() == true) {
@@ -259,7 +224,7 @@ class ArchiveViewViewModel : CoreViewModelWithEvent<ArchiveViewUiIntent, Archive
      * 路径导航
      */
     @UiIntentObserver(ArchiveViewUiIntent.PathSelected::class)
-    private fun onPathSelected(intent: ArchiveViewUiIntent.PathSelected) {
+    private suspend fun onPathSelected(intent: ArchiveViewUiIntent.PathSelected) {
         val targetPath = intent.path
         val currentPath = getOrNull<ArchiveViewUiState.Normal>()?.currentPath ?: ""
         if (targetPath == currentPath) return
@@ -38,6 +38,11 @@ sealed class ArchiveViewLoadState {
 
     data object LoadingEntries : ArchiveViewLoadState()
 
+    /**
+     * 正在读取条目列表，已读到的条目已经显示
+     */
+    data object ScanningEntries : ArchiveViewLoadState()
+
     data class Extracting(
         val index: Int,
         val path: String,
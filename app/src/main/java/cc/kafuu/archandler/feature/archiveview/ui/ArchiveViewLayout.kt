@@ -16,6 +16,7 @@ import androidx.compose.foundation.layout.statusBarsPadding
 import androidx.compose.foundation.rememberScrollState
 import androidx.compose.material3.Button
 import androidx.compose.material3.HorizontalDivider
+import androidx.compose.material3.LinearProgressIndicator
 import androidx.compose.material3.MaterialTheme
 import androidx.compose.material3.Scaffold
 import androidx.compose.material3.Text
@@ -80,6 +81,9 @@ private fun LoadDialogSwitch(
             AppLoadDialog(message = stringResource(R.string.loading_entries_message))
         }
 
+        // 已读到的条目直接显示，进度条在列表上方
+        ArchiveViewLoadState.ScanningEntries -> Unit
+
         is ArchiveViewLoadState.Extracting -> {
             val message = stringResource(R.string.unpacking_file_message)
             val progress = if (loadState.total > 0) {
@@ -151,6 +155,10 @@ private fun NormalView(
                 emitIntent = emitIntent
             )
 
+            if (uiState.loadState is ArchiveViewLoadState.ScanningEntries) {
+                LinearProgressIndicator(modifier = Modifier.fillMaxWidth())
+            }
+
             if (isGridLayout) {
                 // 网格布局
                 AppLazyGridView(
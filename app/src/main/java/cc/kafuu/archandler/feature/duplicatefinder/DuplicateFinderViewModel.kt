@@ -8,16 +8,17 @@ import cc.kafuu.archandler.feature.duplicatefinder.presentation.DuplicateFinderS
 import cc.kafuu.archandler.feature.duplicatefinder.presentation.DuplicateFinderUiIntent
 import cc.kafuu.archandler.feature.duplicatefinder.presentation.DuplicateFinderUiState
 import cc.kafuu.archandler.feature.duplicatefinder.presentation.DuplicateFinderViewEvent
-import cc.kafuu.archandler.feature.duplicatefinder.presentation.DuplicateFileGroup
 import cc.kafuu.archandler.libs.core.AppViewEvent
 import cc.kafuu.archandler.libs.core.CoreViewModelWithEvent
 import cc.kafuu.archandler.libs.core.UiIntentObserver
 import cc.kafuu.archandler.libs.extensions.deletes
 import cc.kafuu.archandler.libs.extensions.listFilteredFiles
-import cc.kafuu.archandler.libs.extensions.sha256Of
+import cc.kafuu.archandler.libs.jni.NativeCallback
+import cc.kafuu.archandler.libs.jni.NativeLib
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.currentCoroutineContext
 import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.isActive
 import kotlinx.coroutines.withContext
 import org.koin.core.component.KoinComponent
 import org.koin.core.component.get
@@ -110,62 +111,34 @@ class DuplicateFinderViewModel(
             currentCoroutineContext().ensureActive()
 
             // 按文件大小分组
-            val sizeGroups = mAllFiles.groupBy { it.length() }.filterValues { it.size > 1 }
-
-            val totalFilesToHash = sizeGroups.values.sumOf { it.size }
-            var processedFiles = 0
-            val hashGroups = HashMap<String, MutableList<File>>()
-            var wastedSpace = 0L
-
-            // 对相同大小的文件计算哈希
-            for ((size, files) in sizeGroups) {
-                state.copy(
-                    loadState = DuplicateFinderLoadState.Hashing(
-                        currentFile = files.first(),
-                        processedCount = processedFiles,
-                        totalCount = totalFilesToHash
-                    )
-                ).setup()
-
-                val fileHashMap = HashMap<String, File>()
-                for (file in files) {
-                    currentCoroutineContext().ensureActive()
-
+            val candidates = collectDuplicateCandidates(mAllFiles)
+
+            // 在 native 层并行计算相同大小文件的哈希
+            val ctx = currentCoroutineContext()
+            val nativeListener = object : NativeCallback {
+                override fun onProgress(path: String, index: Int, total: Int): Boolean {
+                    // 协程已取消时返回 false 以中止计算
+                    if (!ctx.isActive) return false
                     state.copy(
                         loadState = DuplicateFinderLoadState.Hashing(
-                            currentFile = file,
-                            processedCount = processedFiles,
-                            totalCount = totalFilesToHash
+                            currentFile = File(path),
+                            processedCount = index,
+                            totalCount = total
                         )
                     ).setup()
-
-                    try {
-                        val hash = file.sha256Of()
-                        if (fileHashMap.containsKey(hash)) {
-                            // 找到重复文件
-                            hashGroups.getOrPut(hash) { mutableListOf(fileHashMap[hash]!!) }.add(file)
-                            wastedSpace += size
-                        } else {
-                            fileHashMap[hash] = file
-                        }
-                    } catch (e: Exception) {
-                        // 跳过无法读取的文件
-                        e.printStackTrace()
-                    }
-                    processedFiles++
+                    return true
                 }
             }
-
+            val hashes = NativeLib.hashDuplicateCandidates(
+                candidates.files.map { it.path }.toTypedArray(),
+                candidates.groupIds,
+                nativeListener
+            )
             currentCoroutineContext().ensureActive()
+            if (hashes == null) throw IllegalStateException(NativeLib.getLatestErrorMessage())
 
             // 构建结果
-            val duplicateGroups = hashGroups.map { (hash, files) ->
-                DuplicateFileGroup(
-                    hash = hash,
-                    fileSize = files.first().length(),
-                    files = files.sortedBy { it.absolutePath }
-                )
-            }.sortedByDescending { it.fileSize * it.files.size }
+            val (duplicateGroups, wastedSpace) = groupDuplicates(candidates.files, hashes)
 
             val duplicateFileCount = duplicateGroups.sumOf { it.files.size }
 
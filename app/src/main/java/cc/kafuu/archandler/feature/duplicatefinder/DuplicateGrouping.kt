@@ -0,0 +1,62 @@
+package cc.kafuu.archandler.feature.duplicatefinder
+
+import cc.kafuu.archandler.feature.duplicatefinder.presentation.DuplicateFileGroup
+import java.io.File
+
+/**
+ * 需要计算哈希的候选文件，大小相同的文件连续排列
+ * @param groupIds 与 [files] 一一对应的分组编号，同组文件大小相同
+ */
+internal class DuplicateCandidates(
+    val files: List<File>,
+    val groupIds: IntArray
+)
+
+/**
+ * 重复文件分组结果
+ * @param wastedSpace 每组除保留一份外其余文件占用的字节数之和
+ */
+internal data class DuplicateGroups(
+    val groups: List<DuplicateFileGroup>,
+    val wastedSpace: Long
+)
+
+/**
+ * 按文件大小分组，只保留存在相同大小文件的组
+ */
+internal fun collectDuplicateCandidates(files: List<File>): DuplicateCandidates {
+    val sizeGroups = files.groupBy { it.length() }.filterValues { it.size > 1 }
+    val candidates = sizeGroups.values.flatten()
+    val groupIds = IntArray(candidates.size)
+    var offset = 0
+    sizeGroups.values.forEachIndexed { groupId, group ->
+        groupIds.fill(groupId, offset, offset + group.size)
+        offset += group.size
+    }
+    return DuplicateCandidates(candidates, groupIds)
+}
+
+/**
+ * 按哈希将候选文件分为重复组，组按占用空间降序，组内按路径排序
+ * @param hashes 与 [candidates] 一一对应，空字符串表示被预哈希排除或无法读取的文件
+ */
+internal fun groupDuplicates(candidates: List<File>, hashes: Array<String>): DuplicateGroups {
+    val hashGroups = HashMap<String, MutableList<File>>()
+    var wastedSpace = 0L
+    for ((index, file) in candidates.withIndex()) {
+        val hash = hashes[index].takeIf { it.isNotEmpty() } ?: continue
+        val files = hashGroups.getOrPut(hash) { mutableListOf() }
+        if (files.isNotEmpty()) wastedSpace += file.length()
+        files.add(file)
+    }
+    hashGroups.values.removeAll { it.size < 2 }
+
+    val groups = hashGroups.map { (hash, files) ->
+        DuplicateFileGroup(
+            hash = hash,
+            fileSize = files.first().length(),
+            files = files.sortedBy { it.absolutePath }
+        )
+    }.sortedByDescending { it.fileSize * it.files.size }
+    return DuplicateGroups(groups, wastedSpace)
+}
@@ -13,10 +13,18 @@ interface IArchive : Closeable {
 
     /**
      * 读取压缩包内容（不递归读取）
-     * @param dir 当前压缩包相对路径[dir]下的所有文件或目录
+     * @param dir 当前压缩包相对路径[dir]下的所有文件或目录，空字符串表示根目录
+     * @return 直接子项，目录在前并按名称排序；列表可能按需加载，在 [close] 后失效
      */
     fun list(dir: String = ""): List<ArchiveEntry>
 
+    /**
+     * 与 [list] 相同，但在完整列表就绪前可能多次通过 [onPartial] 提供当前已读到的直接子项，
+     * 便于界面在读取大型压缩包时尽早显示内容
+     * @param onPartial 返回 false 表示取消读取
+     */
+    fun list(dir: String, onPartial: (List<ArchiveEntry>) -> Boolean): List<ArchiveEntry> = list(dir)
+
     /**
      * 提取压缩包某个条目
      */
@@ -5,27 +5,71 @@ import cc.kafuu.archandler.libs.archive.IArchive
 import cc.kafuu.archandler.libs.archive.IPasswordProvider
 import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
 import cc.kafuu.archandler.libs.archive.model.ArchiveTestResult
+import cc.kafuu.archandler.libs.jni.ArchiveTree
 import cc.kafuu.archandler.libs.jni.NativeCallback
 import cc.kafuu.archandler.libs.jni.NativeLib
+import cc.kafuu.archandler.libs.manager.CacheManager
+import cc.kafuu.archandler.libs.model.AppCacheType
 import kotlinx.coroutines.currentCoroutineContext
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.runBlocking
+import org.koin.core.component.KoinComponent
+import org.koin.core.component.inject
 import java.io.File
-import kotlin.coroutines.cancellation.CancellationException
 
 
-class LibArchive(private val archiveFile: File) : IArchive {
+class LibArchive(private val archiveFile: File) : IArchive, KoinComponent {
+    private val mCacheManager by inject<CacheManager>()
+
+    // 条目索引缓存目录，归档未修改时可跳过完整解压直接列出条目
+    private val mIndexDir: String
+        get() = mCacheManager.getCacheDir(AppCacheType.ARCHIVE_INDEX).path
+
+    // 目录树在首次列出时构建，之后的目录切换只获取可见的分页
+    private var mTree: ArchiveTree? = null
+
     override suspend fun open(provider: IPasswordProvider?): Boolean = true
 
-    override fun list(dir: String): List<ArchiveEntry> {
-        val files = NativeLib.fetchArchiveFiles(archiveFile.path)?.toList() ?: emptyList()
-        return files.sortedBy { it.path }
+    override fun list(dir: String): List<ArchiveEntry> = obtainTree(null).children(dir)
+
+    override fun list(
+        dir: String,
+        onPartial: (List<ArchiveEntry>) -> Boolean
+    ): List<ArchiveEntry> {
+        val collector = PartialChildrenCollector(dir)
+        return obtainTree { entries ->
+            collector.add(entries)?.let(onPartial) ?: true
+        }.children(dir)
     }
 
+    /**
+     * 获取目录树，首次调用时读取整个压缩包构建
+     * @param onEntries 构建过程中分块接收已读到的条目，返回 false 取消构建
+     */
+    @Synchronized
+    private fun obtainTree(onEntries: ((List<ArchiveEntry>) -> Boolean)?): ArchiveTree = mTree ?: run {
+        ArchiveTree.open(archiveFile.path, mIndexDir, onEntries)
+            ?: throw IllegalStateException(NativeLib.getLatestErrorMessage())
+    }.also { mTree = it }
+
     override fun extract(
         entry: ArchiveEntry,
         dest: File
-    ) = Unit
+    ) {
+        val nativeListener = object : NativeCallback {
+            override fun onProgress(path: String, index: Int, total: Int) = true
+        }
+        val success = NativeLib.extractArchiveEntries(
+            archivePath = archiveFile.path,
+            outputDir = dest.path,
+            entryPaths = arrayOf(entry.path),
+            includePatterns = null,
+            excludePatterns = null,
+            listener = nativeListener,
+            indexDir = mIndexDir
+        )
+        if (!success) throw IllegalStateException(NativeLib.getLatestErrorMessage())
+    }
 
     override suspend fun extractAll(
         destDir: File,
@@ -33,36 +77,33 @@ class LibArchive(private val archiveFile: File) : IArchive {
     ) {
         val ctx = currentCoroutineContext()
         val nativeListener = object : NativeCallback {
-            override fun invoke(vararg args: Any?) {
-                // 检查协程是否仍然活跃，如果已取消则抛出异常
-                if (!ctx.isActive) {
-                    throw CancellationException("Archive extraction cancelled")
-                }
-                val path = (args[0] as? String) ?: ""
-                val index = (args[1] as? Int) ?: 0
-                val total = (args[2] as? Int) ?: 0
+            override fun onProgress(path: String, index: Int, total: Int): Boolean {
+                // 协程已取消时返回 false 以中止解压
+                if (!ctx.isActive) return false
                 runBlocking { onProgress(index, path, total) }
+                return true
             }
         }
         NativeLib.extractArchive(
             archiveFile.path,
             destDir.path,
-            nativeListener
+            nativeListener,
+            indexDir = mIndexDir
         )
     }
 
     override suspend fun test(): ArchiveTestResult {
         val ctx = currentCoroutineContext()
         val nativeListener = object : NativeCallback {
-            override fun invoke(vararg args: Any?) {
-                // 检查协程是否仍然活跃，如果已取消则抛出异常
-                if (!ctx.isActive) {
-                    throw CancellationException("Archive testing cancelled")
-                }
-            }
+            // 协程已取消时返回 false 以中止测试
+            override fun onProgress(path: String, index: Int, total: Int) = ctx.isActive
         }
-        return NativeLib.testArchive(archiveFile.path, nativeListener)
+        return NativeLib.testArchive(archiveFile.path, nativeListener, mIndexDir)
     }
 
-    override fun close() = Unit
+    @Synchronized
+    override fun close() {
+        mTree?.close()
+        mTree = null
+    }
 }
\ No newline at end of file
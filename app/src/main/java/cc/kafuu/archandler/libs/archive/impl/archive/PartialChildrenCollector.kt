@@ -0,0 +1,49 @@
+package cc.kafuu.archandler.libs.archive.impl.archive
+
+import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
+
+/**
+ * 从流式读取到的条目中收集某个目录的直接子项，未读到的中间目录由其子项推导
+ * 子项过多时不再提供部分结果，避免每次都对大量条目排序
+ */
+internal class PartialChildrenCollector(dir: String) {
+    private val mPrefix = dir.trimEnd('/').let { if (it.isEmpty()) "" else "$it/" }
+    private val mChildren = HashMap<String, ArchiveEntry>()
+
+    /**
+     * @return 子项有变化时返回排序后的当前子项，否则返回 null
+     */
+    fun add(entries: List<ArchiveEntry>): List<ArchiveEntry>? {
+        if (mChildren.size > MAX_PARTIAL_CHILDREN) return null
+        var changed = false
+        for (entry in entries) {
+            if (!entry.path.startsWith(mPrefix)) continue
+            val relative = entry.path.substring(mPrefix.length)
+            if (relative.isEmpty()) continue
+            // 绝对路径的顶层分量包含开头的 '/'，与 native 目录树一致
+            val end = relative.indexOf('/', if (mPrefix.isEmpty() && relative.startsWith('/')) 1 else 0)
+            val childPath = mPrefix + if (end < 0) relative else relative.substring(0, end)
+            val existing = mChildren[childPath]
+            if (end < 0) {
+                mChildren[childPath] = entry
+            } else if (existing == null) {
+                mChildren[childPath] = entry.copy(
+                    path = childPath,
+                    name = childPath.trimStart('/').substringAfterLast('/'),
+                    isDirectory = true,
+                    size = 0,
+                    compressedSize = 0
+                )
+            } else {
+                continue
+            }
+            changed = true
+        }
+        if (!changed) return null
+        return mChildren.values.sortedWith(compareBy<ArchiveEntry> { !it.isDirectory }.thenBy { it.name })
+    }
+
+    companion object {
+        internal const val MAX_PARTIAL_CHILDREN = 2048
+    }
+}
@@ -162,10 +162,10 @@ class SevenZipArchive(
     }
 
     /**
-     * 列出压缩包内所有内容
+     * 列出压缩包内[dir]下的直接子项，目录在前并按名称排序
      */
-    override fun list(dir: String): List<ArchiveEntry> =
-        mSimpleArchive?.archiveItems?.map {
+    override fun list(dir: String): List<ArchiveEntry> {
+        val allEntries = mSimpleArchive?.archiveItems?.map {
             ArchiveEntry(
                 path = it.path ?: "",
                 name = File(it.path ?: "").name,
@@ -174,7 +174,48 @@ class SevenZipArchive(
                 compressedSize = it.packedSize,
                 lastModified = runCatching { it.lastWriteTime.time }.getOrNull() ?: 0L
             )
-        } ?: emptyList()
+        } ?: return emptyList()
+        return childrenOf(allEntries, dir)
+            .sortedWith(compareBy<ArchiveEntry> { !it.isDirectory }.thenBy { it.name })
+    }
+
+    /**
+     * 从完整条目列表中筛选出[currentPath]下的直接子项，未单独记录的中间目录由其子项推导
+     */
+    private fun childrenOf(allEntries: List<ArchiveEntry>, currentPath: String): List<ArchiveEntry> {
+        if (currentPath.isEmpty()) {
+            // 根目录：显示所有顶级项
+            return allEntries.filter { entry ->
+                val pathParts = entry.path.split('/').filter { it.isNotEmpty() }
+                pathParts.size == 1
+            }
+        }
+        // 子目录：显示指定路径下的直接子项
+        val pathPrefix = currentPath.trimEnd('/') + "/"
+        val seenPaths = mutableSetOf<String>()
+        return allEntries.filter { entry ->
+            val entryPath = entry.path.trimEnd('/') + "/"
+            entryPath.startsWith(pathPrefix) && entry.path != currentPath.trimEnd('/')
+        }.mapNotNull { entry ->
+            val relativePath = entry.path.removePrefix(pathPrefix)
+            val pathParts = relativePath.split('/').filter { it.isNotEmpty() }
+            if (pathParts.isEmpty()) return@mapNotNull null
+
+            val firstPart = pathParts[0]
+            val childPath = "$currentPath/$firstPart"
+
+            // 避免重复
+            if (seenPaths.contains(childPath)) return@mapNotNull null
+            seenPaths.add(childPath)
+
+            // 创建一个新的条目，代表直接子项
+            entry.copy(
+                path = childPath,
+                name = firstPart,
+                isDirectory = entry.isDirectory || pathParts.size > 1
+            )
+        }
+    }
 
     /**
      * 提取压缩包指定内容
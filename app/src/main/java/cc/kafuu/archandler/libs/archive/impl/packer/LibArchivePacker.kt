@@ -10,7 +10,6 @@ import cc.kafuu.archandler.libs.jni.model.LibArchiveFormat
 import cc.kafuu.archandler.libs.jni.model.LibCompressionType
 import kotlinx.coroutines.currentCoroutineContext
 import kotlinx.coroutines.isActive
-import kotlin.coroutines.cancellation.CancellationException
 import java.io.File
 
 class LibArchivePacker(
@@ -56,15 +55,11 @@ class LibArchivePacker(
     ): Boolean {
         val ctx = currentCoroutineContext()
         val nativeListener = object : NativeCallback {
-            override fun invoke(vararg args: Any?) {
-                // 检查协程是否仍然活跃，如果已取消则抛出异常
-                if (!ctx.isActive) {
-                    throw CancellationException("Archive packing cancelled")
-                }
-                val path = (args[0] as? String) ?: ""
-                val index = (args[1] as? Int) ?: 0
-                val total = (args[2] as? Int) ?: 0
+            override fun onProgress(path: String, index: Int, total: Int): Boolean {
+                // 协程已取消时返回 false 以中止打包
+                if (!ctx.isActive) return false
                 listener(index, total, path)
+                return true
             }
         }
         var baseDir = files.commonBaseDir()?.path ?: return false
@@ -77,7 +72,8 @@ class LibArchivePacker(
             format = getFormat().id,
             compression = (algorithm?.getCompressionType() ?: LibCompressionType.None).id,
             compressionLevel = algorithm?.compressionLevel ?: 0,
-            listener = nativeListener
+            listener = nativeListener,
+            seekable = (option as? CompressionOption.Tar)?.seekable ?: false
         )
     }
 }
\ No newline at end of file
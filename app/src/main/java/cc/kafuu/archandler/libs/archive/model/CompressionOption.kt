@@ -31,9 +31,14 @@ sealed class CompressionOption {
             get() = algorithm.getNameExtension()
     }
 
+    /**
+     * @param seekable 按条目切分独立压缩帧并写入帧索引，仅对 Zstd/Xz 生效，
+     * 可在不解压前序条目的情况下直接读取单个条目
+     */
     data class Tar(
         val algorithm: CompressionAlgorithm? = null,
-        val tarType: Type
+        val tarType: Type,
+        val seekable: Boolean = false
     ) : CompressionOption() {
         enum class Type { Ustar, Pax, Gnu, V7 }
 
@@ -0,0 +1,104 @@
+package cc.kafuu.archandler.libs.jni
+
+import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
+import java.io.Closeable
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * native 批量返回的条目列表，按需从直接缓冲区解码 [ArchiveEntry]，不为未访问的条目创建对象
+ * 缓冲区布局见 native 端 EntryListing；关闭后不可再访问
+ */
+class ArchiveListing private constructor(buffer: ByteBuffer) : AbstractList<ArchiveEntry>(),
+    Closeable {
+    private var mBuffer: ByteBuffer? = buffer.order(ByteOrder.nativeOrder())
+
+    override val size: Int
+
+    private val mSizeOffset: Int
+    private val mCompressedOffset: Int
+    private val mModifiedOffset: Int
+    private val mPathOffsetOffset: Int
+    private val mPathLengthOffset: Int
+    private val mNameStartOffset: Int
+    private val mFlagsOffset: Int
+    private val mPoolOffset: Int
+
+    init {
+        val magic = ByteArray(MAGIC.size).also { buffer.get(it) }
+        require(magic.contentEquals(MAGIC) && buffer.getInt(4) == VERSION) {
+            "Unsupported archive listing format"
+        }
+        size = buffer.getInt(8)
+        mSizeOffset = HEADER_SIZE
+        mCompressedOffset = mSizeOffset + size * Long.SIZE_BYTES
+        mModifiedOffset = mCompressedOffset + size * Long.SIZE_BYTES
+        mPathOffsetOffset = mModifiedOffset + size * Long.SIZE_BYTES
+        mPathLengthOffset = mPathOffsetOffset + size * Int.SIZE_BYTES
+        mNameStartOffset = mPathLengthOffset + size * Int.SIZE_BYTES
+        mFlagsOffset = mNameStartOffset + size * Int.SIZE_BYTES
+        mPoolOffset = mFlagsOffset + size * Int.SIZE_BYTES
+    }
+
+    @Synchronized
+    override fun get(index: Int): ArchiveEntry {
+        val buffer = checkNotNull(mBuffer) { "Archive listing is closed" }
+        if (index !in 0 until size) throw IndexOutOfBoundsException("Index: $index, Size: $size")
+        val pathOffset = buffer.getInt(mPathOffsetOffset + index * Int.SIZE_BYTES)
+        val pathLength = buffer.getInt(mPathLengthOffset + index * Int.SIZE_BYTES)
+        val nameStart = buffer.getInt(mNameStartOffset + index * Int.SIZE_BYTES)
+        val flags = buffer.getInt(mFlagsOffset + index * Int.SIZE_BYTES)
+        return ArchiveEntry(
+            path = buffer.decodeString(mPoolOffset + pathOffset, pathLength),
+            name = buffer.decodeString(mPoolOffset + pathOffset + nameStart, pathLength - nameStart),
+            isDirectory = flags and FLAG_DIRECTORY != 0,
+            size = buffer.getLong(mSizeOffset + index * Long.SIZE_BYTES),
+            compressedSize = buffer.getLong(mCompressedOffset + index * Long.SIZE_BYTES),
+            lastModified = buffer.getLong(mModifiedOffset + index * Long.SIZE_BYTES)
+        )
+    }
+
+    @Synchronized
+    override fun close() {
+        val buffer = mBuffer ?: return
+        mBuffer = null
+        NativeLib.releaseArchiveListing(buffer)
+    }
+
+    private fun ByteBuffer.decodeString(offset: Int, length: Int): String {
+        val bytes = ByteArray(length)
+        position(offset)
+        get(bytes)
+        return String(bytes, Charsets.UTF_8)
+    }
+
+    companion object {
+        private val MAGIC = "ARCL".toByteArray(Charsets.US_ASCII)
+        private const val VERSION = 1
+        private const val HEADER_SIZE = 16
+        private const val FLAG_DIRECTORY = 1
+
+        /**
+         * 解码并释放缓冲区，适用于只包含少量条目的分页结果
+         */
+        fun decodeAndRelease(buffer: ByteBuffer): List<ArchiveEntry> =
+            ArchiveListing(buffer).use { it.toList() }
+
+        /**
+         * 解码不由 Kotlin 端持有的缓冲区（如 [NativeListingCallback] 中的分块）
+         */
+        fun decode(buffer: ByteBuffer): List<ArchiveEntry> =
+            ArchiveListing(buffer).run { toList().also { mBuffer = null } }
+
+        /**
+         * 列出归档全部条目，失败时返回 null（错误信息见 [NativeLib.getLatestErrorMessage]）
+         */
+        fun fetch(archivePath: String, indexDir: String? = null): ArchiveListing? {
+            val buffer = NativeLib.fetchArchiveListing(archivePath, indexDir) ?: return null
+            return runCatching { ArchiveListing(buffer) }.getOrElse {
+                NativeLib.releaseArchiveListing(buffer)
+                throw it
+            }
+        }
+    }
+}
@@ -0,0 +1,118 @@
+package cc.kafuu.archandler.libs.jni
+
+import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
+import java.io.Closeable
+import java.nio.ByteBuffer
+
+/**
+ * native 端的归档目录树，每个打开的归档构建一次，按目录分页获取排好序的直接子项
+ * 关闭后不可再访问，通过 [children] 得到的列表也随之失效
+ */
+class ArchiveTree private constructor(private val mHandle: Long) : Closeable {
+    enum class SortKey(val value: Int) {
+        NAME(0), SIZE(1), MODIFIED(2)
+    }
+
+    data class SortOrder(
+        val key: SortKey = SortKey.NAME,
+        val descending: Boolean = false,
+        val directoriesFirst: Boolean = true
+    )
+
+    private var mClosed = false
+
+    /**
+     * @return 目录的直接子项数量，目录不存在时返回 -1
+     */
+    @Synchronized
+    fun childCount(dir: String): Int {
+        check(!mClosed) { "Archive tree is closed" }
+        return NativeLib.archiveTreeChildCount(mHandle, dir)
+    }
+
+    /**
+     * 获取目录下排序后的 [offset, offset + limit) 子项
+     */
+    @Synchronized
+    fun listPage(dir: String, order: SortOrder, offset: Int, limit: Int): List<ArchiveEntry> {
+        check(!mClosed) { "Archive tree is closed" }
+        val buffer = NativeLib.listArchiveTree(
+            mHandle, dir, order.key.value, order.descending, order.directoriesFirst, offset, limit
+        ) ?: throw IllegalStateException(NativeLib.getLatestErrorMessage())
+        return ArchiveListing.decodeAndRelease(buffer)
+    }
+
+    /**
+     * 目录的直接子项列表，按页从 native 获取，只有被访问到的页才会解码
+     */
+    fun children(dir: String, order: SortOrder = SortOrder()): List<ArchiveEntry> {
+        val count = childCount(dir)
+        if (count <= 0) return emptyList()
+        return PagedChildren(dir, order, count)
+    }
+
+    @Synchronized
+    override fun close() {
+        if (mClosed) return
+        mClosed = true
+        NativeLib.releaseArchiveTree(mHandle)
+    }
+
+    private inner class PagedChildren(
+        private val mDir: String,
+        private val mOrder: SortOrder,
+        override val size: Int
+    ) : AbstractList<ArchiveEntry>() {
+        // 最近访问的页，按访问顺序淘汰
+        private val mPages = object : LinkedHashMap<Int, List<ArchiveEntry>>(16, 0.75f, true) {
+            override fun removeEldestEntry(eldest: MutableMap.MutableEntry<Int, List<ArchiveEntry>>?) =
+                size > MAX_CACHED_PAGES
+        }
+
+        init {
+            // 首页通常立即显示，在创建列表的线程上预先获取
+            page(0)
+        }
+
+        override fun get(index: Int): ArchiveEntry {
+            if (index !in 0 until size) throw IndexOutOfBoundsException("Index: $index, Size: $size")
+            return page(index / PAGE_SIZE)[index % PAGE_SIZE]
+        }
+
+        @Synchronized
+        private fun page(number: Int) = mPages.getOrPut(number) {
+            listPage(mDir, mOrder, number * PAGE_SIZE, PAGE_SIZE)
+        }
+
+        // 同一目录与顺序的列表内容相同，避免状态比较时逐个解码条目
+        override fun equals(other: Any?) = other is PagedChildren && other.owner === this@ArchiveTree &&
+                other.mDir == mDir && other.mOrder == mOrder && other.size == size
+
+        override fun hashCode() = (mDir.hashCode() * 31 + mOrder.hashCode()) * 31 + size
+
+        private val owner get() = this@ArchiveTree
+    }
+
+    companion object {
+        private const val PAGE_SIZE = 256
+        private const val MAX_CACHED_PAGES = 8
+
+        /**
+         * 列出归档全部条目并构建目录树，失败或被取消时返回 null（错误信息见 [NativeLib.getLatestErrorMessage]）
+         * @param onEntries 不为空时在读取过程中分块接收已读到的条目，返回 false 取消构建
+         */
+        fun open(
+            archivePath: String,
+            indexDir: String? = null,
+            onEntries: ((List<ArchiveEntry>) -> Boolean)? = null
+        ): ArchiveTree? {
+            val listener = onEntries?.let {
+                object : NativeListingCallback {
+                    override fun onEntries(buffer: ByteBuffer) = it(ArchiveListing.decode(buffer))
+                }
+            }
+            val handle = NativeLib.openArchiveTree(archivePath, indexDir, listener)
+            return if (handle == 0L) null else ArchiveTree(handle)
+        }
+    }
+}
@@ -1,5 +1,11 @@
 package cc.kafuu.archandler.libs.jni
 
+/**
+ * Native 层的进度回调，调用频率已在 native 层节流（约每 16ms 至多一次）
+ */
 interface NativeCallback {
-    fun invoke(vararg args: Any?)
+    /**
+     * @return 返回 false 表示取消当前操作
+     */
+    fun onProgress(path: String, index: Int, total: Int): Boolean
 }
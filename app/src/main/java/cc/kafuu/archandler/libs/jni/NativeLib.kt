@@ -1,7 +1,8 @@
 package cc.kafuu.archandler.libs.jni
 
-import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
 import cc.kafuu.archandler.libs.archive.model.ArchiveTestResult
+import cc.kafuu.archandler.libs.jni.model.LibChecksumAlgorithm
+import java.nio.ByteBuffer
 
 object NativeLib {
     init {
@@ -10,6 +11,16 @@ object NativeLib {
 
     external fun getLatestErrorMessage(): String
 
+    /**
+     * @param seekable 按条目切分压缩帧以支持随机访问（仅 tar/cpio + Zstd/Xz）
+     * @param threads 压缩线程数，0 表示按 CPU 核心数自动选择
+     * @param statsHandle [NativeStats.handle]，0 表示不统计
+     * @param checksumAlgorithm [LibChecksumAlgorithm.id]，打包时同步计算每个文件的校验和清单
+     * @param checksumPath 清单写入的文件，为空时清单作为最后一个条目写入压缩包
+     * @param snapshotPath 增量打包的快照文件：只写出与上次快照相比新增或变化的文件，删除的文件记为墓碑；
+     * 未压缩的 tar 已存在时原地追加，其它格式需为每次增量指定新的 [outputPath]，通过 [extractArchiveChain] 恢复
+     * @param deduplicate 内容相同的文件只写出一份，其余写为硬链接（仅 tar/cpio），节省的字节数见 [NativeStats.Snapshot.deduplicatedBytes]
+     */
     external fun createArchive(
         outputPath: String,
         baseDir: String,
@@ -17,22 +28,153 @@ object NativeLib {
         format: Int,
         compression: Int,
         compressionLevel: Int,
-        listener: NativeCallback
+        listener: NativeCallback,
+        seekable: Boolean = false,
+        threads: Int = 0,
+        statsHandle: Long = 0L,
+        checksumAlgorithm: Int = LibChecksumAlgorithm.None.id,
+        checksumPath: String? = null,
+        snapshotPath: String? = null,
+        deduplicate: Boolean = false
     ): Boolean
 
+    /**
+     * @param threads 解压线程数，0 表示按 CPU 核心数自动选择；仅多 block/帧/member 的压缩流可以并行解压
+     * @param pipelined 解压与写盘分别在两个线程上进行，适合写盘较慢、压缩比较高的归档
+     * @param smallFileWriters 并行写出小文件的线程数，0 表示自动，1 表示关闭；适合包含大量小文件的归档
+     * @param checksumAlgorithm [LibChecksumAlgorithm.id]，解压时同步计算每个文件的校验和清单
+     * @param checksumPath 清单写入的文件，为空时不计算
+     */
     external fun extractArchive(
         archivePath: String,
         outputDir: String,
         listener: NativeCallback,
-        overwrite: Boolean = true
+        overwrite: Boolean = true,
+        indexDir: String? = null,
+        threads: Int = 0,
+        pipelined: Boolean = false,
+        smallFileWriters: Int = 1,
+        statsHandle: Long = 0L,
+        checksumAlgorithm: Int = LibChecksumAlgorithm.None.id,
+        checksumPath: String? = null
+    ): Boolean
+
+    /**
+     * 恢复增量打包的归档链：依次解压 [basePath] 与 [deltaPaths]，后者覆盖前者并按墓碑删除文件
+     * 原地追加的 tar 只需传入空的 [deltaPaths]
+     * @param threads 解压线程数，0 表示按 CPU 核心数自动选择
+     * @param checksumPath 不为空时在整条链恢复完成后写出一份对应最终文件的校验和清单
+     */
+    external fun extractArchiveChain(
+        basePath: String,
+        deltaPaths: Array<String>,
+        outputDir: String,
+        listener: NativeCallback,
+        threads: Int = 0,
+        checksumAlgorithm: Int = LibChecksumAlgorithm.None.id,
+        checksumPath: String? = null
+    ): Boolean
+
+    /**
+     * 选择性解压：只解压 [entryPaths] 中的条目（目录包含其子条目）以及匹配 [includePatterns] 的条目，
+     * 并排除匹配 [excludePatterns] 的条目；[indexDir] 中有有效索引时，所有选中条目写出后立即停止读取，
+     * 否则读到结尾，使追加写入的 tar 中同名条目的最后一个版本生效
+     * @param threads 解压线程数，0 表示按 CPU 核心数自动选择
+     * @param pipelined 解压与写盘分别在两个线程上进行
+     * @param smallFileWriters 并行写出小文件的线程数，0 表示自动，1 表示关闭
+     */
+    external fun extractArchiveEntries(
+        archivePath: String,
+        outputDir: String,
+        entryPaths: Array<String>,
+        includePatterns: Array<String>?,
+        excludePatterns: Array<String>?,
+        listener: NativeCallback,
+        overwrite: Boolean = true,
+        indexDir: String? = null,
+        threads: Int = 0,
+        pipelined: Boolean = false,
+        smallFileWriters: Int = 1,
+        statsHandle: Long = 0L
     ): Boolean
 
-    external fun fetchArchiveFiles(
-        archivePath: String
-    ): Array<ArchiveEntry>?
+    /**
+     * 列出全部条目（含补全的父目录，按目录树深度优先、同级按名称排序），结果为 [ArchiveListing] 格式的直接缓冲区
+     * 缓冲区内存由 native 分配，必须通过 [releaseArchiveListing] 释放，通常直接使用 [ArchiveListing]
+     */
+    external fun fetchArchiveListing(
+        archivePath: String,
+        indexDir: String? = null
+    ): ByteBuffer?
+
+    external fun releaseArchiveListing(buffer: ByteBuffer)
 
+    /**
+     * 列出全部条目并构建目录树，失败或被取消时返回0；使用完毕后必须调用 [releaseArchiveTree]
+     * @param listener 不为空时在读取过程中分块推送已读到的条目（未补全父目录），返回 false 可取消
+     */
+    external fun openArchiveTree(
+        archivePath: String,
+        indexDir: String? = null,
+        listener: NativeListingCallback? = null
+    ): Long
+
+    /**
+     * @return 目录的直接子项数量，目录不存在时返回 -1
+     */
+    external fun archiveTreeChildCount(handle: Long, dir: String): Int
+
+    /**
+     * 返回目录下排序后的一页直接子项，格式与 [fetchArchiveListing] 相同
+     * @param sortKey [ArchiveTree.SortKey.value]
+     */
+    external fun listArchiveTree(
+        handle: Long,
+        dir: String,
+        sortKey: Int,
+        descending: Boolean,
+        directoriesFirst: Boolean,
+        offset: Int,
+        limit: Int
+    ): ByteBuffer?
+
+    external fun releaseArchiveTree(handle: Long)
+
+    /**
+     * @param threads 解压线程数，0 表示按 CPU 核心数自动选择
+     */
     external fun testArchive(
         archivePath: String,
-        listener: NativeCallback
+        listener: NativeCallback,
+        indexDir: String? = null,
+        threads: Int = 0,
+        statsHandle: Long = 0L
     ): ArchiveTestResult
+
+    /**
+     * 多线程计算查找重复文件的候选文件的 SHA-256，同组内首尾预哈希唯一的文件会被直接排除
+     * @param groups 与 [paths] 一一对应的分组编号，同组文件大小相同
+     * @param listener index 为已确定结果的文件数，返回 false 可取消
+     * @param threads 哈希线程数，0 表示按 CPU 核心数自动选择
+     * @return 与 [paths] 一一对应的小写十六进制哈希，被排除或读取失败的文件为空字符串；失败或被取消时返回 null
+     */
+    external fun hashDuplicateCandidates(
+        paths: Array<String>,
+        groups: IntArray,
+        listener: NativeCallback,
+        threads: Int = 0
+    ): Array<String>?
+
+    /**
+     * 创建字节级统计对象，使用完毕后必须调用 [releaseStats]
+     */
+    external fun createStats(): Long
+
+    /**
+     * 将统计快照写入 [out]（字段顺序见 [NativeStats.Snapshot]）
+     * @return 句柄无效或数组长度不足时返回 false
+     */
+    external fun pollStats(handle: Long, out: LongArray): Boolean
+
+    external fun releaseStats(handle: Long)
 }
\ No newline at end of file
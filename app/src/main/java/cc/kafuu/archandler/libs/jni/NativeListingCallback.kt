@@ -0,0 +1,14 @@
+package cc.kafuu.archandler.libs.jni
+
+import java.nio.ByteBuffer
+
+/**
+ * Native 层流式列表的分块回调，第一个条目读到后立即回调，之后约每 50ms 或每 4096 个条目回调一次
+ */
+interface NativeListingCallback {
+    /**
+     * @param buffer [ArchiveListing] 格式的新条目，只在回调期间有效，需在返回前完成解码
+     * @return 返回 false 表示取消列表
+     */
+    fun onEntries(buffer: ByteBuffer): Boolean
+}
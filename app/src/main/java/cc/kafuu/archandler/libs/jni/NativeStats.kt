@@ -0,0 +1,75 @@
+package cc.kafuu.archandler.libs.jni
+
+import java.io.Closeable
+
+/**
+ * Native 引擎的字节级统计，由 native 热循环更新，Kotlin 端按需轮询，无需逐块回调
+ * 在打包/解压期间不得关闭
+ */
+class NativeStats : Closeable {
+    val handle: Long = NativeLib.createStats()
+
+    private val mBuffer = LongArray(SNAPSHOT_FIELD_COUNT)
+
+    /**
+     * @param progressBytes 进度依据的已处理字节数：打包为已读取的源文件字节，解压为已消耗的压缩字节
+     * @param bytesPerSecond 最近一个轮询窗口内的处理速度（按进度依据计算）
+     * @param etaMs 剩余时间，无法估算时为 -1
+     * @param codecMs 压缩/解压耗时，以下三项在多线程时为各线程耗时之和
+     * @param ioMs 读取源文件或写出文件数据的耗时
+     * @param metadataMs 目录遍历、header、创建文件与设置属性的耗时
+     * @param deduplicatedBytes 打包去重时写为硬链接、未写出数据的字节数
+     * @param dedupMs 打包去重时查找重复文件的耗时
+     */
+    data class Snapshot(
+        val totalBytes: Long,
+        val progressBytes: Long,
+        val bytesRead: Long,
+        val bytesWritten: Long,
+        val compressedBytes: Long,
+        val files: Long,
+        val elapsedMs: Long,
+        val bytesPerSecond: Long,
+        val etaMs: Long,
+        val codecMs: Long,
+        val ioMs: Long,
+        val metadataMs: Long,
+        val deduplicatedBytes: Long,
+        val dedupMs: Long
+    ) {
+        /**
+         * 0~1 的进度，总量未知时为 null
+         */
+        val fraction: Float?
+            get() = if (totalBytes > 0) (progressBytes.toFloat() / totalBytes).coerceIn(0f, 1f) else null
+    }
+
+    @Synchronized
+    fun poll(): Snapshot? {
+        if (!NativeLib.pollStats(handle, mBuffer)) return null
+        return with(mBuffer) {
+            Snapshot(
+                totalBytes = get(0),
+                progressBytes = get(1),
+                bytesRead = get(2),
+                bytesWritten = get(3),
+                compressedBytes = get(4),
+                files = get(5),
+                elapsedMs = get(6),
+                bytesPerSecond = get(7),
+                etaMs = get(8),
+                codecMs = get(9),
+                ioMs = get(10),
+                metadataMs = get(11),
+                deduplicatedBytes = get(12),
+                dedupMs = get(13)
+            )
+        }
+    }
+
+    override fun close() = NativeLib.releaseStats(handle)
+
+    companion object {
+        private const val SNAPSHOT_FIELD_COUNT = 14
+    }
+}
@@ -0,0 +1,8 @@
+package cc.kafuu.archandler.libs.jni.model
+
+enum class LibChecksumAlgorithm(val id: Int) {
+    None(0),
+    Crc32(1),
+    XxHash64(2),
+    Sha256(3)
+}
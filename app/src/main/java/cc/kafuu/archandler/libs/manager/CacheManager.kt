@@ -11,7 +11,7 @@ class CacheManager(context: Context) {
     /**
      * 获取指定类型的缓存子目录，不存在则创建
      */
-    private fun getCacheDir(type: AppCacheType): File {
+    fun getCacheDir(type: AppCacheType): File {
         val subDir = File(mCacheRoot, type.subDirName)
         if (!subDir.exists()) subDir.mkdirs()
         return subDir
@@ -1,5 +1,6 @@
 package cc.kafuu.archandler.libs.model
 
 enum class AppCacheType(val subDirName: String) {
-    MERGE_SPLIT_ARCHIVE("merge_split")
+    MERGE_SPLIT_ARCHIVE("merge_split"),
+    ARCHIVE_INDEX("archive_index")
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+package cc.kafuu.archandler
+
+import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
+import cc.kafuu.archandler.libs.jni.ArchiveListing
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import kotlin.system.measureTimeMillis
+
+class ArchiveListingTest {
+
+    companion object {
+        private const val HEADER_SIZE = 16
+        private const val FLAG_DIRECTORY = 1
+        private const val LARGE_LISTING_SIZE = 200_000
+    }
+
+    @Test
+    fun testDecodeEntries() {
+        val entries = listOf(
+            ArchiveEntry("docs", "docs", true, 0, 0, 1_700_000_000_000),
+            ArchiveEntry("docs/readme.txt", "readme.txt", false, 1234, 567, 1_700_000_001_000),
+            ArchiveEntry("图片/照片.jpg", "照片.jpg", false, 5_000_000_000, 4_000_000_000, 0),
+            ArchiveEntry("top", "top", false, 1, 1, -1)
+        )
+        assertEquals(entries, ArchiveListing.decode(encode(entries)))
+    }
+
+    @Test
+    fun testDecodeEmptyListing() {
+        assertTrue(ArchiveListing.decode(encode(emptyList())).isEmpty())
+    }
+
+    @Test(expected = IllegalArgumentException::class)
+    fun testRejectUnknownMagic() {
+        val buffer = encode(emptyList())
+        buffer.put(0, 'X'.code.toByte())
+        ArchiveListing.decode(buffer)
+    }
+
+    @Test(expected = IllegalArgumentException::class)
+    fun testRejectUnknownVersion() {
+        val buffer = encode(emptyList())
+        buffer.putInt(4, 2)
+        ArchiveListing.decode(buffer)
+    }
+
+    @Test
+    fun testDecodeLargeListing() {
+        println("\n========== ArchiveListing Decode Test ==========\n")
+
+        val entries = List(LARGE_LISTING_SIZE) { index ->
+            val name = "file_$index.bin"
+            ArchiveEntry("dir_${index % 100}/$name", name, false, index.toLong(), index / 2L, 0)
+        }
+        val buffer = encode(entries)
+        lateinit var decoded: List<ArchiveEntry>
+        val time = measureTimeMillis {
+            decoded = ArchiveListing.decode(buffer)
+        }
+        assertEquals(entries, decoded)
+
+        println("  Entries: $LARGE_LISTING_SIZE")
+        println("  Buffer size: ${buffer.capacity() / 1024} KiB")
+        println("  Decode time: $time ms")
+    }
+
+    /**
+     * 按 native 端 EntryListing 的布局编码条目
+     */
+    private fun encode(entries: List<ArchiveEntry>): ByteBuffer {
+        val paths = entries.map { it.path.toByteArray(Charsets.UTF_8) }
+        val poolSize = paths.sumOf { it.size }
+        val count = entries.size
+        val buffer = ByteBuffer.allocate(HEADER_SIZE + count * (3 * Long.SIZE_BYTES + 4 * Int.SIZE_BYTES) + poolSize)
+            .order(ByteOrder.nativeOrder())
+        buffer.put("ARCL".toByteArray(Charsets.US_ASCII))
+        buffer.putInt(1)
+        buffer.putInt(count)
+        buffer.putInt(poolSize)
+        entries.forEach { buffer.putLong(it.size) }
+        entries.forEach { buffer.putLong(it.compressedSize) }
+        entries.forEach { buffer.putLong(it.lastModified) }
+        var poolOffset = 0
+        paths.forEach {
+            buffer.putInt(poolOffset)
+            poolOffset += it.size
+        }
+        paths.forEach { buffer.putInt(it.size) }
+        entries.forEachIndexed { index, entry ->
+            buffer.putInt(paths[index].size - entry.name.toByteArray(Charsets.UTF_8).size)
+        }
+        entries.forEach { buffer.putInt(if (it.isDirectory) FLAG_DIRECTORY else 0) }
+        paths.forEach { buffer.put(it) }
+        buffer.flip()
+        return buffer
+    }
+}
@@ -0,0 +1,71 @@
+package cc.kafuu.archandler
+
+import cc.kafuu.archandler.feature.duplicatefinder.collectDuplicateCandidates
+import cc.kafuu.archandler.feature.duplicatefinder.groupDuplicates
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+
+class DuplicateGroupingTest {
+
+    @get:Rule
+    val temporaryFolder = TemporaryFolder()
+
+    @Test
+    fun testCandidatesGroupedBySize() {
+        val a1 = file("a1", 10)
+        val unique = file("unique", 20)
+        val b1 = file("b1", 30)
+        val a2 = file("a2", 10)
+        val b2 = file("b2", 30)
+        val a3 = file("a3", 10)
+
+        val candidates = collectDuplicateCandidates(listOf(a1, unique, b1, a2, b2, a3))
+        // 大小唯一的文件被排除，同组文件连续排列且分组编号相同
+        assertEquals(listOf(a1, a2, a3, b1, b2), candidates.files)
+        assertEquals(listOf(0, 0, 0, 1, 1), candidates.groupIds.toList())
+    }
+
+    @Test
+    fun testNoCandidates() {
+        val candidates = collectDuplicateCandidates(listOf(file("a", 1), file("b", 2)))
+        assertTrue(candidates.files.isEmpty())
+        assertTrue(candidates.groupIds.isEmpty())
+    }
+
+    @Test
+    fun testGroupByHash() {
+        val small1 = file("small1", 100)
+        val small2 = file("small2", 100)
+        val small3 = file("small3", 100)
+        val large1 = file("large1", 1000)
+        val large2 = file("large2", 1000)
+        val excluded = file("excluded", 1000)
+        val lonely = file("lonely", 100)
+
+        val result = groupDuplicates(
+            listOf(small3, large2, small1, excluded, lonely, large1, small2),
+            arrayOf("s", "l", "s", "", "x", "l", "s")
+        )
+        // 占用空间大的组在前，组内按路径排序；被排除与没有重复的文件不出现在结果中
+        assertEquals(listOf("l", "s"), result.groups.map { it.hash })
+        assertEquals(listOf(large1, large2), result.groups[0].files)
+        assertEquals(1000L, result.groups[0].fileSize)
+        assertEquals(listOf(small1, small2, small3), result.groups[1].files)
+        assertEquals(100L, result.groups[1].fileSize)
+        assertEquals(1000L + 2 * 100L, result.wastedSpace)
+    }
+
+    @Test
+    fun testNoDuplicates() {
+        val result = groupDuplicates(listOf(file("a", 5), file("b", 5)), arrayOf("x", "y"))
+        assertTrue(result.groups.isEmpty())
+        assertEquals(0L, result.wastedSpace)
+    }
+
+    private fun file(name: String, size: Int): File =
+        temporaryFolder.newFile(name).apply { writeBytes(ByteArray(size)) }
+}
@@ -0,0 +1,77 @@
+package cc.kafuu.archandler
+
+import cc.kafuu.archandler.libs.archive.impl.archive.PartialChildrenCollector
+import cc.kafuu.archandler.libs.archive.model.ArchiveEntry
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNotNull
+import org.junit.Assert.assertNull
+import org.junit.Test
+
+class PartialChildrenCollectorTest {
+
+    @Test
+    fun testCollectRootChildren() {
+        val collector = PartialChildrenCollector("")
+        val children = collector.add(
+            listOf(file("a/b/c.txt"), file("top.txt"), file("a/x.txt"), file("b.txt"))
+        )
+        // 中间目录由子项推导，目录排在文件之前，同类按名称排序
+        assertEquals(
+            listOf(
+                ArchiveEntry("a", "a", true, 0, 0, 0),
+                file("b.txt"),
+                file("top.txt")
+            ),
+            children
+        )
+    }
+
+    @Test
+    fun testCollectSubdirectoryChildren() {
+        for (dir in listOf("a", "a/")) {
+            val children = PartialChildrenCollector(dir).add(
+                listOf(file("a/b/c.txt"), file("a/x.txt"), file("ab/y.txt"), file("top.txt"), directory("a"))
+            )
+            assertEquals(listOf("a/b", "a/x.txt"), children?.map { it.path })
+            assertEquals(listOf("b", "x.txt"), children?.map { it.name })
+        }
+    }
+
+    @Test
+    fun testAbsolutePathsKeepLeadingSlash() {
+        val children = PartialChildrenCollector("").add(listOf(file("/etc/passwd"), file("/top")))
+        assertEquals(listOf("/etc", "/top"), children?.map { it.path })
+        assertEquals(listOf("etc", "top"), children?.map { it.name })
+    }
+
+    @Test
+    fun testReturnsNullWhenUnchanged() {
+        val collector = PartialChildrenCollector("a")
+        assertNotNull(collector.add(listOf(file("a/b/c.txt"))))
+        // 推导目录的其它子项与其它目录的条目不改变当前子项
+        assertNull(collector.add(listOf(file("a/b/d.txt"), file("other/e.txt"))))
+        assertNull(collector.add(emptyList()))
+    }
+
+    @Test
+    fun testExplicitEntryReplacesDerivedDirectory() {
+        val collector = PartialChildrenCollector("")
+        collector.add(listOf(file("a/b.txt")))
+        val children = collector.add(listOf(ArchiveEntry("a", "a", true, 0, 0, 1234)))
+        assertEquals(listOf(ArchiveEntry("a", "a", true, 0, 0, 1234)), children)
+    }
+
+    @Test
+    fun testStopsAfterTooManyChildren() {
+        val collector = PartialChildrenCollector("")
+        val entries = List(PartialChildrenCollector.MAX_PARTIAL_CHILDREN + 1) { file("file_$it") }
+        assertEquals(entries.size, collector.add(entries)?.size)
+        assertNull(collector.add(listOf(file("more"))))
+    }
+
+    private fun file(path: String) =
+        ArchiveEntry(path, path.substringAfterLast('/'), false, 1, 1, 0)
+
+    private fun directory(path: String) =
+        ArchiveEntry(path, path.substringAfterLast('/'), true, 0, 0, 0)
+}